@@ -0,0 +1,167 @@
+// 解复用 IO 基准：对比 libavformat 默认 file 协议、MmapIO（mmap + madvise）
+// 与 ReadAheadIO（后台预读）在顺序读取整个文件与随机 seek 拖动（scrub）
+// 两种场景下的耗时。
+// 用法：demux_io_bench <媒体文件> [seek 次数]
+// 注意：第一轮会把文件读入页缓存，各方式交替各跑两轮，冷缓存数据需先
+// 手动清空页缓存（echo 3 > /proc/sys/vm/drop_caches）后只看第一轮。
+extern "C" {
+#include <libavformat/avformat.h>
+}
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+
+#include "latency_histogram.hpp"
+#include "mmap_io.hpp"
+#include "read_ahead_io.hpp"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+enum class IO { File, Mmap, ReadAhead };
+
+const char* ioName(IO io) {
+  switch (io) {
+    case IO::Mmap:
+      return "mmap";
+    case IO::ReadAhead:
+      return "readahead";
+    default:
+      return "file";
+  }
+}
+
+constexpr int PACKETS_PER_SEEK = 30;  // 每次 seek 后读取的包数（约等于找到目标帧）
+
+int64_t elapsedUs(Clock::time_point since) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() -
+                                                               since)
+      .count();
+}
+
+struct Input {
+  AVFormatContext* ctx = nullptr;
+  MmapIO mmap_io;
+  ReadAheadIO read_ahead_io;
+
+  bool open(const std::string& filename, IO io) {
+    AVIOContext* pb = nullptr;
+    if (io == IO::Mmap) {
+      if (!mmap_io.open(filename)) return false;
+      pb = mmap_io.context();
+    } else if (io == IO::ReadAhead) {
+      if (!read_ahead_io.open(filename)) return false;
+      pb = read_ahead_io.context();
+    }
+    if (pb) {
+      ctx = avformat_alloc_context();
+      ctx->pb = pb;
+      ctx->flags |= AVFMT_FLAG_CUSTOM_IO;
+    }
+    if (avformat_open_input(&ctx, filename.c_str(), nullptr, nullptr) < 0 ||
+        avformat_find_stream_info(ctx, nullptr) < 0) {
+      close();
+      return false;
+    }
+    return true;
+  }
+
+  void close() {
+    if (ctx) avformat_close_input(&ctx);
+    mmap_io.close();
+    read_ahead_io.close();
+  }
+};
+
+struct Result {
+  int64_t sequential_us = 0;
+  uint64_t packets = 0;
+  uint64_t bytes = 0;
+  utils::LatencyHistogram::Snapshot seek;
+  ReadAheadIO::Stats read_ahead;  // 仅 readahead 方式有效
+};
+
+bool run(const std::string& filename, IO io, int seeks, Result* r) {
+  Input in;
+  if (!in.open(filename, io)) {
+    std::fprintf(stderr, "could not open %s\n", filename.c_str());
+    return false;
+  }
+  AVPacket* packet = av_packet_alloc();
+
+  // 1. 顺序读取全部数据包（正常播放）
+  auto start = Clock::now();
+  while (av_read_frame(in.ctx, packet) >= 0) {
+    r->packets++;
+    r->bytes += packet->size;
+    av_packet_unref(packet);
+  }
+  r->sequential_us = elapsedUs(start);
+
+  // 2. 随机 seek + 读取若干包（拖动进度条）
+  utils::LatencyHistogram hist;
+  const int64_t duration = in.ctx->duration > 0 ? in.ctx->duration : 0;
+  std::mt19937_64 rng(42);  // 两种方式使用相同的 seek 序列
+  for (int i = 0; i < seeks && duration > 0; ++i) {
+    const int64_t target = static_cast<int64_t>(rng() % duration);
+    start = Clock::now();
+    if (av_seek_frame(in.ctx, -1, target, AVSEEK_FLAG_BACKWARD) < 0) continue;
+    for (int n = 0; n < PACKETS_PER_SEEK; ++n) {
+      if (av_read_frame(in.ctx, packet) < 0) break;
+      av_packet_unref(packet);
+    }
+    hist.record(elapsedUs(start));
+  }
+  r->seek = hist.snapshot();
+  if (io == IO::ReadAhead) r->read_ahead = in.read_ahead_io.getStats();
+
+  av_packet_free(&packet);
+  in.close();
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  if (argc < 2) {
+    std::fprintf(stderr, "usage: %s <media file> [seeks]\n", argv[0]);
+    return 1;
+  }
+  const std::string filename = argv[1];
+  const int seeks = argc > 2 ? std::max(1, std::atoi(argv[2])) : 200;
+  av_log_set_level(AV_LOG_ERROR);
+
+  std::printf("demux IO benchmark: %s, %d seeks\n", filename.c_str(), seeks);
+  std::printf("%-10s %5s %12s %10s %10s %10s %10s %10s\n", "io", "round",
+              "seq ms", "MB/s", "seek avg", "seek p50", "seek p95",
+              "seek p99");
+  for (int round = 1; round <= 2; ++round) {
+    for (IO io : {IO::File, IO::Mmap, IO::ReadAhead}) {
+      Result r;
+      if (!run(filename, io, seeks, &r)) return 1;
+      const double mb_per_s =
+          r.sequential_us > 0 ? r.bytes / static_cast<double>(r.sequential_us)
+                              : 0.0;
+      std::printf("%-10s %5d %12.1f %10.1f %8.0fus %8lldus %8lldus %8lldus\n",
+                  ioName(io), round, r.sequential_us / 1000.0,
+                  mb_per_s, r.seek.mean, static_cast<long long>(r.seek.p50),
+                  static_cast<long long>(r.seek.p95),
+                  static_cast<long long>(r.seek.p99));
+      if (io == IO::ReadAhead) {
+        std::printf("%-10s %5s stalls %llu (%.1f ms), seeks %llu in window / "
+                    "%llu refill\n",
+                    "", "", static_cast<unsigned long long>(r.read_ahead.stalls),
+                    r.read_ahead.stall_us / 1000.0,
+                    static_cast<unsigned long long>(r.read_ahead.seeks_in_window),
+                    static_cast<unsigned long long>(r.read_ahead.seeks_refill));
+      }
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,200 @@
+// 帧队列微基准：对比 StreamSource 旧的 mutex + condition_variable 队列
+// 与 utils::SpscQueue 在单线程、生产者/消费者以及带时间戳读取线程时的开销。
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include "spsc_queue.hpp"
+
+namespace {
+
+struct FakeFrame {
+  int64_t pts;
+};
+using FramePtr = std::shared_ptr<FakeFrame>;
+
+constexpr size_t QUEUE_SIZE = 30;  // 与视频 StreamSource 的 MAX_QUEUE_SIZE 一致
+
+// 旧实现：std::queue + mutex + condition_variable（与原 StreamSource 逻辑相同）
+class MutexFrameQueue {
+ public:
+  bool tryPush(FramePtr&& frame) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (queue_.size() >= QUEUE_SIZE) return false;
+    queue_.push(std::move(frame));
+    cond_.notify_one();
+    return true;
+  }
+  bool tryPop(FramePtr& out) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (queue_.empty()) return false;
+    out = std::move(queue_.front());
+    queue_.pop();
+    cond_.notify_all();
+    return true;
+  }
+  void waitForSpace() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cond_.wait(lock, [this]() { return queue_.size() < QUEUE_SIZE; });
+  }
+  void waitForData() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cond_.wait(lock, [this]() { return !queue_.empty(); });
+  }
+  int64_t frontPts() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return queue_.empty() ? 0 : queue_.front()->pts;
+  }
+
+ private:
+  mutable std::mutex mutex_;
+  std::condition_variable cond_;
+  std::queue<FramePtr> queue_;
+};
+
+// 统一两种队列的接口
+struct MutexAdapter {
+  MutexFrameQueue q;
+  bool push(FramePtr&& f) { return q.tryPush(std::move(f)); }
+  bool pop(FramePtr& f) { return q.tryPop(f); }
+  void waitForSpace() { q.waitForSpace(); }
+  void waitForData() { q.waitForData(); }
+  int64_t frontPts() const { return q.frontPts(); }
+};
+
+struct SpscAdapter {
+  utils::SpscQueue<FramePtr> q{QUEUE_SIZE};
+  bool push(FramePtr&& f) {
+    int64_t pts = f->pts;
+    return q.tryPush(std::move(f), pts);
+  }
+  bool pop(FramePtr& f) { return q.tryPop(f); }
+  void waitForSpace() {
+    q.waitUntilSizeBelow(QUEUE_SIZE, []() { return false; });
+  }
+  void waitForData() {
+    q.waitForData([]() { return false; });
+  }
+  int64_t frontPts() const { return q.frontStamp(0); }
+};
+
+using Clock = std::chrono::steady_clock;
+
+double nsPerOp(Clock::duration d, uint64_t ops) {
+  return std::chrono::duration<double, std::nano>(d).count() /
+         static_cast<double>(ops);
+}
+
+std::vector<FramePtr> makeFrames(size_t n) {
+  std::vector<FramePtr> frames;
+  frames.reserve(n);
+  for (size_t i = 0; i < n; ++i) {
+    frames.push_back(std::make_shared<FakeFrame>(FakeFrame{int64_t(i)}));
+  }
+  return frames;
+}
+
+// 单线程 push + pop：衡量无竞争时的固定开销
+template <typename Queue>
+double benchSingleThread(uint64_t iterations) {
+  Queue queue;
+  auto frames = makeFrames(QUEUE_SIZE);
+  FramePtr out;
+  auto start = Clock::now();
+  for (uint64_t i = 0; i < iterations; ++i) {
+    FramePtr f = frames[i % QUEUE_SIZE];
+    queue.push(std::move(f));
+    queue.pop(out);
+  }
+  return nsPerOp(Clock::now() - start, iterations);
+}
+
+// 生产者 / 消费者各一个线程，可选一个持续读取队首 PTS 的观察线程。
+// polling_consumer 模拟渲染线程：取不到帧时不阻塞，让出 CPU 后再次轮询。
+template <typename Queue>
+double benchTransfer(uint64_t items, bool with_observer,
+                     bool polling_consumer = false) {
+  Queue queue;
+  auto frames = makeFrames(QUEUE_SIZE * 2);
+  std::atomic<bool> done{false};
+  std::atomic<int64_t> observed{0};
+
+  std::thread observer;
+  if (with_observer) {
+    observer = std::thread([&]() {
+      int64_t sum = 0;
+      for (uint64_t n = 1; !done.load(std::memory_order_relaxed); ++n) {
+        sum += queue.frontPts();
+        if (n % 64 == 0) std::this_thread::yield();
+      }
+      observed.store(sum);
+    });
+  }
+
+  auto start = Clock::now();
+  std::thread consumer([&]() {
+    FramePtr out;
+    for (uint64_t received = 0; received < items;) {
+      if (queue.pop(out)) {
+        ++received;
+      } else if (polling_consumer) {
+        std::this_thread::yield();
+      } else {
+        queue.waitForData();
+      }
+    }
+  });
+  for (uint64_t i = 0; i < items; ++i) {
+    FramePtr f = frames[i % frames.size()];
+    while (!queue.push(std::move(f))) {
+      queue.waitForSpace();
+    }
+  }
+  consumer.join();
+  auto elapsed = Clock::now() - start;
+
+  done.store(true);
+  if (observer.joinable()) observer.join();
+  return nsPerOp(elapsed, items);
+}
+
+void report(const char* name, double mutex_ns, double spsc_ns) {
+  std::printf("%-36s %12.1f %12.1f %9.2fx\n", name, mutex_ns, spsc_ns,
+              spsc_ns > 0 ? mutex_ns / spsc_ns : 0.0);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  uint64_t iterations = 2000000;
+  if (argc > 1) {
+    iterations = std::strtoull(argv[1], nullptr, 10);
+  }
+
+  std::printf("frame queue microbenchmark, %llu items, capacity %zu\n",
+              static_cast<unsigned long long>(iterations), QUEUE_SIZE);
+  std::printf("%-36s %12s %12s %10s\n", "case (ns/item)", "mutex+cv", "spsc",
+              "speedup");
+
+  report("single thread push+pop",
+         benchSingleThread<MutexAdapter>(iterations),
+         benchSingleThread<SpscAdapter>(iterations));
+  report("producer -> consumer",
+         benchTransfer<MutexAdapter>(iterations, false),
+         benchTransfer<SpscAdapter>(iterations, false));
+  report("producer -> polling consumer",
+         benchTransfer<MutexAdapter>(iterations, false, true),
+         benchTransfer<SpscAdapter>(iterations, false, true));
+  report("producer -> consumer + pts reader",
+         benchTransfer<MutexAdapter>(iterations, true),
+         benchTransfer<SpscAdapter>(iterations, true));
+  return 0;
+}
@@ -0,0 +1,375 @@
+// 播放管线热点原语的微基准，输入全部在进程内合成（不需要媒体文件）：
+//   pcm_ring_*     PCM 环形缓冲区写入 / 读取（单线程与生产者-消费者）
+//   frame_queue_*  StreamSource 帧队列（SpscQueue<FramePtr>）入队 / 出队
+//   resample_*     平面浮点 → 交错 float 转换与 5.1 下混（与 AudioPlayer 相同的
+//                  SwrContext，见 createAudioResampler）
+//   volume_*       音量缩放（SDL_MixAudioFormat，与音频回调相同）
+//   *_alloc_*      数据包 / 帧分配：直接 av_*_alloc 与 PacketPool / FramePool
+//   yuv_copy_*     YUV420P 平面去填充拷贝（PBO 上传前的准备，同 GLRenderer）
+// 用法：micro_bench [--json <输出文件>] [--filter <名称子串>]
+// 结果打印为表格；指定 --json 时同时写入 JSON，便于不同机器 / 版本对比。
+extern "C" {
+#include <libavutil/channel_layout.h>
+#include <libavutil/frame.h>
+#include <libavutil/samplefmt.h>
+#include <libswresample/swresample.h>
+}
+
+#include <SDL2/SDL.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "audio_resampler.hpp"
+#include "frame_pool.hpp"
+#include "packet_pool.hpp"
+#include "spsc_byte_ring.hpp"
+#include "spsc_queue.hpp"
+#include "yuv_copy.hpp"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr double MIN_SECONDS = 0.3;  // 每项至少运行的时间
+
+struct Result {
+  std::string name;
+  uint64_t iterations = 0;
+  double ns_per_op = 0.0;
+  double bytes_per_op = 0.0;  // 为 0 时不输出吞吐
+
+  double mbPerSec() const {
+    return ns_per_op > 0 ? bytes_per_op / ns_per_op * 1e3 : 0.0;
+  }
+};
+
+std::vector<Result> results;
+std::string filter;
+
+// 运行 op(n)（执行 n 次操作），批量翻倍直到总时间超过 MIN_SECONDS
+void measure(const std::string& name, double bytes_per_op,
+             const std::function<void(uint64_t)>& op) {
+  if (!filter.empty() && name.find(filter) == std::string::npos) return;
+  op(16);  // 预热：填充缓存、池与内部状态
+  uint64_t batch = 16;
+  uint64_t total_iters = 0;
+  double total_ns = 0.0;
+  while (total_ns < MIN_SECONDS * 1e9) {
+    const auto start = Clock::now();
+    op(batch);
+    total_ns += std::chrono::duration<double, std::nano>(Clock::now() - start)
+                    .count();
+    total_iters += batch;
+    if (batch < (uint64_t{1} << 24)) batch *= 2;
+  }
+  Result r;
+  r.name = name;
+  r.iterations = total_iters;
+  r.ns_per_op = total_ns / total_iters;
+  r.bytes_per_op = bytes_per_op;
+  std::printf("%-32s %12llu %12.1f", name.c_str(),
+              static_cast<unsigned long long>(r.iterations), r.ns_per_op);
+  if (bytes_per_op > 0) std::printf(" %12.1f", r.mbPerSec());
+  std::printf("\n");
+  results.push_back(r);
+}
+
+// 编译器屏障：防止基准中的结果被优化掉
+template <typename T>
+void doNotOptimize(const T& value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// ---- 合成输入 ----
+
+// 平面浮点正弦波（AAC / Opus 解码器的典型输出格式）
+AVFrame* makeAudioFrame(int nb_samples, int sample_rate, int channels) {
+  AVFrame* frame = av_frame_alloc();
+  frame->format = AV_SAMPLE_FMT_FLTP;
+  frame->sample_rate = sample_rate;
+  frame->nb_samples = nb_samples;
+  av_channel_layout_default(&frame->ch_layout, channels);
+  av_frame_get_buffer(frame, 0);
+  for (int ch = 0; ch < channels; ++ch) {
+    auto* data = reinterpret_cast<float*>(frame->data[ch]);
+    for (int i = 0; i < nb_samples; ++i) {
+      data[i] = 0.5f * std::sin(2.0 * M_PI * 440.0 * (i + ch) / sample_rate);
+    }
+  }
+  return frame;
+}
+
+// YUV420P 测试图案；align 与解码器缓冲池一致（64），
+// 宽度不是 64 的倍数时带行填充
+AVFrame* makeVideoFrame(int width, int height) {
+  AVFrame* frame = av_frame_alloc();
+  frame->format = AV_PIX_FMT_YUV420P;
+  frame->width = width;
+  frame->height = height;
+  av_frame_get_buffer(frame, 64);
+  for (int p = 0; p < 3; ++p) {
+    const int h = p == 0 ? height : (height + 1) / 2;
+    for (int y = 0; y < h; ++y) {
+      uint8_t* row =
+          frame->data[p] + static_cast<ptrdiff_t>(y) * frame->linesize[p];
+      std::memset(row, (y * 7 + p * 64) & 0xff, frame->linesize[p]);
+    }
+  }
+  return frame;
+}
+
+// ---- PCM 环形缓冲区 ----
+
+void benchPcmRing() {
+  constexpr size_t CHUNK = 4096;  // 512 个 float 立体声采样帧，与回调大小相当
+  utils::SpscByteRing ring;
+  ring.allocate(48000 * 4 * 2);  // 1 秒 48k 立体声 float
+  std::vector<uint8_t> in(CHUNK, 0x5a), out(CHUNK);
+
+  measure("pcm_ring_write_read_4k", CHUNK, [&](uint64_t n) {
+    for (uint64_t i = 0; i < n; ++i) {
+      ring.write(in.data(), CHUNK);
+      doNotOptimize(ring.read(out.data(), CHUNK));
+    }
+  });
+
+  // 生产者与消费者分别在两个线程，测持续吞吐
+  measure("pcm_ring_spsc_4k", CHUNK, [&](uint64_t n) {
+    std::thread producer([&]() {
+      for (uint64_t i = 0; i < n;) {
+        if (ring.write(in.data(), CHUNK) == CHUNK) {
+          ++i;
+        } else {
+          std::this_thread::yield();
+        }
+      }
+    });
+    uint64_t remaining = n * CHUNK;
+    while (remaining > 0) {
+      const size_t got =
+          ring.read(out.data(), std::min<uint64_t>(CHUNK, remaining));
+      if (got == 0) std::this_thread::yield();
+      remaining -= got;
+    }
+    producer.join();
+  });
+}
+
+// ---- 帧队列 ----
+
+void benchFrameQueue() {
+  FramePool pool;
+  utils::SpscQueue<FramePtr> queue(30);  // 与视频 StreamSource 队列长度一致
+
+  measure("frame_queue_push_pop", 0, [&](uint64_t n) {
+    FramePtr frame = pool.acquire();
+    for (uint64_t i = 0; i < n; ++i) {
+      queue.tryPush(std::move(frame), static_cast<int64_t>(i));
+      queue.tryPop(frame);
+    }
+  });
+
+  measure("frame_queue_spsc", 0, [&](uint64_t n) {
+    std::thread producer([&]() {
+      for (uint64_t i = 0; i < n;) {
+        FramePtr frame = pool.acquire();
+        while (!queue.tryPush(std::move(frame), static_cast<int64_t>(i))) {
+          std::this_thread::yield();
+        }
+        ++i;
+      }
+    });
+    FramePtr frame;
+    for (uint64_t i = 0; i < n;) {
+      if (queue.tryPop(frame)) {
+        frame.reset();
+        ++i;
+      } else {
+        std::this_thread::yield();
+      }
+    }
+    producer.join();
+  });
+}
+
+// ---- 重采样与音量 ----
+
+// 与 AudioPlayer 相同的 SwrContext（createAudioResampler）：平面 float 输入，
+// 转换为 48k 立体声交错 float 设备格式；in_channels 为 6 时包含 5.1 下混
+void benchResampleCase(const char* name, int in_channels) {
+  constexpr int SAMPLES = 1024;
+  constexpr int RATE = 48000;
+  AVFrame* frame = makeAudioFrame(SAMPLES, RATE, in_channels);
+
+  AudioResampleSpec spec;
+  spec.in_layout = frame->ch_layout.u.mask;
+  spec.in_channels = in_channels;
+  spec.in_rate = RATE;
+  spec.in_fmt = AV_SAMPLE_FMT_FLTP;
+  spec.out_channels = 2;
+  spec.out_rate = RATE;
+  spec.out_fmt = AV_SAMPLE_FMT_FLT;
+  SwrContext* swr = createAudioResampler(spec);
+  if (!swr) {
+    std::fprintf(stderr, "resampler init failed, skipping %s\n", name);
+  } else {
+    const size_t out_bytes = SAMPLES * 2 * sizeof(float);
+    std::vector<uint8_t> out(out_bytes);
+    measure(name, out_bytes, [&](uint64_t n) {
+      uint8_t* dst[1] = {out.data()};
+      for (uint64_t i = 0; i < n; ++i) {
+        doNotOptimize(swr_convert(swr, dst, SAMPLES,
+                                  (const uint8_t**)frame->data, SAMPLES));
+      }
+    });
+  }
+  swr_free(&swr);
+  av_frame_free(&frame);
+}
+
+void benchResample() {
+  benchResampleCase("resample_fltp_to_flt_1024", 2);
+  benchResampleCase("resample_5p1_downmix_flt_1024", 6);
+
+  // 音量缩放：音频回调在非最大音量时逐块混音到静音缓冲（设备格式 float）
+  constexpr size_t SAMPLES = 1024;
+  constexpr size_t BYTES = SAMPLES * sizeof(float);
+  std::vector<float> src(SAMPLES);
+  std::vector<uint8_t> dst(BYTES);
+  for (size_t i = 0; i < SAMPLES; ++i) {
+    src[i] = 0.5f * std::sin(2.0 * M_PI * 440.0 * i / 48000);
+  }
+  measure("volume_mix_f32_4k", BYTES, [&](uint64_t n) {
+    for (uint64_t i = 0; i < n; ++i) {
+      std::memset(dst.data(), 0, BYTES);
+      SDL_MixAudioFormat(dst.data(),
+                         reinterpret_cast<const uint8_t*>(src.data()),
+                         AUDIO_F32SYS, BYTES, SDL_MIX_MAXVOLUME / 2);
+      doNotOptimize(dst[0]);
+    }
+  });
+}
+
+// ---- 数据包 / 帧分配 ----
+
+void benchAllocation() {
+  measure("packet_alloc_av", 0, [](uint64_t n) {
+    for (uint64_t i = 0; i < n; ++i) {
+      AVPacket* packet = av_packet_alloc();
+      doNotOptimize(packet);
+      av_packet_free(&packet);
+    }
+  });
+  PacketPool packet_pool;
+  measure("packet_alloc_pool", 0, [&](uint64_t n) {
+    for (uint64_t i = 0; i < n; ++i) {
+      PacketPtr packet = packet_pool.acquire();
+      doNotOptimize(packet.get());
+    }
+  });
+
+  measure("frame_alloc_av", 0, [](uint64_t n) {
+    for (uint64_t i = 0; i < n; ++i) {
+      AVFrame* frame = av_frame_alloc();
+      doNotOptimize(frame);
+      av_frame_free(&frame);
+    }
+  });
+  FramePool frame_pool;
+  measure("frame_alloc_pool", 0, [&](uint64_t n) {
+    for (uint64_t i = 0; i < n; ++i) {
+      FramePtr frame = frame_pool.acquire();
+      doNotOptimize(frame.get());
+    }
+  });
+}
+
+// ---- YUV 上传准备 ----
+
+void benchYuvCopy(const char* name, int width, int height) {
+  AVFrame* frame = makeVideoFrame(width, height);
+  const int half_w = (width + 1) / 2;
+  const int half_h = (height + 1) / 2;
+  const size_t y_size = static_cast<size_t>(width) * height;
+  const size_t c_size = static_cast<size_t>(half_w) * half_h;
+  std::vector<uint8_t> staging(y_size + 2 * c_size);
+  measure(name, static_cast<double>(staging.size()), [&](uint64_t n) {
+    for (uint64_t i = 0; i < n; ++i) {
+      packYuv420p(staging.data(), frame);  // 与 GLRenderer 的 PBO 路径相同
+      doNotOptimize(staging[i % staging.size()]);
+    }
+  });
+  av_frame_free(&frame);
+}
+
+// ---- JSON 输出 ----
+
+bool writeJson(const std::string& path) {
+  FILE* fp = std::fopen(path.c_str(), "w");
+  if (!fp) return false;
+  std::fprintf(fp, "{\n  \"benchmark\": \"micro_bench\",\n");
+  std::fprintf(fp, "  \"hardware_concurrency\": %u,\n",
+               std::thread::hardware_concurrency());
+  std::fprintf(fp, "  \"results\": [\n");
+  for (size_t i = 0; i < results.size(); ++i) {
+    const Result& r = results[i];
+    std::fprintf(fp,
+                 "    {\"name\": \"%s\", \"iterations\": %llu, "
+                 "\"ns_per_op\": %.3f",
+                 r.name.c_str(), static_cast<unsigned long long>(r.iterations),
+                 r.ns_per_op);
+    if (r.bytes_per_op > 0) {
+      std::fprintf(fp, ", \"bytes_per_op\": %.0f, \"mb_per_s\": %.3f",
+                   r.bytes_per_op, r.mbPerSec());
+    }
+    std::fprintf(fp, "}%s\n", i + 1 < results.size() ? "," : "");
+  }
+  std::fprintf(fp, "  ]\n}\n");
+  return std::fclose(fp) == 0;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  std::string json_path;
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+      json_path = argv[++i];
+    } else if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+      filter = argv[++i];
+    } else {
+      std::fprintf(stderr, "usage: %s [--json <file>] [--filter <substring>]\n",
+                   argv[0]);
+      return 1;
+    }
+  }
+
+  std::printf("%-32s %12s %12s %12s\n", "benchmark", "iterations", "ns/op",
+              "MB/s");
+  benchPcmRing();
+  benchFrameQueue();
+  benchResample();
+  benchAllocation();
+  benchYuvCopy("yuv_copy_1920x1080", 1920, 1080);
+  benchYuvCopy("yuv_copy_1918x1080_padded", 1918, 1080);
+  benchYuvCopy("yuv_copy_3840x2160", 3840, 2160);
+
+  if (!json_path.empty()) {
+    if (!writeJson(json_path)) {
+      std::fprintf(stderr, "could not write %s\n", json_path.c_str());
+      return 1;
+    }
+    std::printf("\nresults written to %s\n", json_path.c_str());
+  }
+  return 0;
+}
@@ -0,0 +1,162 @@
+// PCM 环形缓冲区压力测试：生产者（解码线程）与消费者（SDL 音频回调）以不同
+// 速率运行，校验 utils::SpscByteRing 传输的数据逐字节正确，并统计欠载次数。
+// 用法：pcm_ring_bench [秒数]
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "spsc_byte_ring.hpp"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t BYTES_PER_FRAME = 4;  // S16 双声道
+
+// 第 i 个字节的期望值：与位置相关，能发现丢失、重复和错位
+inline uint8_t patternByte(uint64_t i) {
+  return static_cast<uint8_t>((i * 2654435761u) >> 13);
+}
+
+struct Scenario {
+  const char* name;
+  size_t ring_bytes;                   // 环形缓冲区容量
+  size_t callback_bytes;               // 每次回调取走的字节数
+  std::chrono::microseconds period;    // 回调周期
+  double producer_speed;               // 生产者平均速率 / 消费速率
+  std::chrono::microseconds stall;     // 生产者周期性卡顿时长（模拟解码抖动）
+  bool expect_no_underrun;
+};
+
+struct Result {
+  uint64_t bytes = 0;
+  uint64_t callbacks = 0;
+  uint64_t underruns = 0;
+  uint64_t corrupt = 0;
+  uint64_t misaligned = 0;
+};
+
+Result run(const Scenario& sc, std::chrono::milliseconds duration) {
+  utils::SpscByteRing ring;
+  ring.allocate(sc.ring_bytes);
+
+  const double consume_rate =  // 字节 / 微秒
+      static_cast<double>(sc.callback_bytes) / sc.period.count();
+  const uint64_t total_bytes =
+      static_cast<uint64_t>(consume_rate * duration.count() * 1000.0);
+
+  std::atomic<bool> producer_done{false};
+  std::thread producer([&]() {
+    std::mt19937 rng(12345);
+    // 解码出的一帧 PCM 大小不固定（这里 256~2048 个采样帧）
+    std::uniform_int_distribution<size_t> chunk_frames(256, 2048);
+    std::vector<uint8_t> chunk;
+    uint64_t produced = 0;
+    auto start = Clock::now();
+    auto next_stall = start + std::chrono::milliseconds(50);
+
+    while (produced < total_bytes) {
+      size_t n = std::min<uint64_t>(chunk_frames(rng) * BYTES_PER_FRAME,
+                                    total_bytes - produced);
+      chunk.resize(n);
+      for (size_t i = 0; i < n; ++i) chunk[i] = patternByte(produced + i);
+
+      // 按平均速率节流：超前时睡眠，环满时让出 CPU
+      auto due = start + std::chrono::microseconds(static_cast<int64_t>(
+                             produced / (consume_rate * sc.producer_speed)));
+      std::this_thread::sleep_until(due);
+      if (sc.stall.count() > 0 && Clock::now() >= next_stall) {
+        std::this_thread::sleep_for(sc.stall);
+        next_stall = Clock::now() + std::chrono::milliseconds(50);
+      }
+
+      const uint8_t* p = chunk.data();
+      while (n > 0) {
+        size_t written = ring.write(p, n);
+        if (written == 0) {
+          std::this_thread::sleep_for(std::chrono::microseconds(200));
+          continue;
+        }
+        p += written;
+        n -= written;
+        produced += written;
+      }
+    }
+    producer_done.store(true, std::memory_order_release);
+  });
+
+  // 消费者：与 AudioPlayer::fillAudioData 相同，只取整数个采样帧
+  Result r;
+  std::vector<uint8_t> stream(sc.callback_bytes);
+  while (ring.available() < sc.ring_bytes / 2 &&
+         !producer_done.load(std::memory_order_acquire)) {
+    std::this_thread::sleep_for(std::chrono::microseconds(200));  // 预缓冲
+  }
+  auto next = Clock::now();
+  uint64_t consumed = 0;
+  while (consumed < total_bytes) {
+    next += sc.period;
+    std::this_thread::sleep_until(next);
+
+    const bool done = producer_done.load(std::memory_order_acquire);
+    size_t want = std::min(sc.callback_bytes, ring.available());
+    want -= want % BYTES_PER_FRAME;
+    size_t got = ring.read(stream.data(), want);
+    for (size_t i = 0; i < got; ++i) {
+      if (stream[i] != patternByte(consumed + i)) ++r.corrupt;
+    }
+    consumed += got;
+    if (consumed % BYTES_PER_FRAME != 0) ++r.misaligned;
+    if (got < sc.callback_bytes && !(done && ring.empty())) ++r.underruns;
+    ++r.callbacks;
+  }
+  producer.join();
+  r.bytes = consumed;
+  return r;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  int seconds = 3;
+  if (argc > 1) {
+    seconds = std::max(1, std::atoi(argv[1]));
+  }
+  const auto duration = std::chrono::milliseconds(seconds * 1000);
+  using std::chrono::microseconds;
+
+  // 回调周期按实时音频缩短，以便在几秒内跑过大量回绕
+  const Scenario scenarios[] = {
+      {"producer 1.5x, steady", 64 * 1024, 4096, microseconds(2000), 1.5,
+       microseconds(0), true},
+      {"producer 4x, bursty stalls", 64 * 1024, 4096, microseconds(2000), 4.0,
+       microseconds(8000), true},
+      {"producer 1.2x, small ring", 24 * 1024, 1024, microseconds(500), 1.2,
+       microseconds(0), true},
+      {"producer 0.7x (starved)", 64 * 1024, 4096, microseconds(2000), 0.7,
+       microseconds(0), false},
+  };
+
+  std::printf("pcm ring stress test, %d s per scenario\n", seconds);
+  std::printf("%-30s %12s %10s %10s %10s\n", "scenario", "bytes", "callbacks",
+              "underruns", "corrupt");
+  bool ok = true;
+  for (const auto& sc : scenarios) {
+    Result r = run(sc, duration);
+    std::printf("%-30s %12llu %10llu %10llu %10llu\n", sc.name,
+                static_cast<unsigned long long>(r.bytes),
+                static_cast<unsigned long long>(r.callbacks),
+                static_cast<unsigned long long>(r.underruns),
+                static_cast<unsigned long long>(r.corrupt + r.misaligned));
+    if (r.corrupt > 0 || r.misaligned > 0) ok = false;
+    if (sc.expect_no_underrun && r.underruns > 0) ok = false;
+  }
+  std::printf("%s\n", ok ? "PASS" : "FAIL");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,218 @@
+// 无窗口的播放管线基准：Demuxer → Decoder → StreamSource → 音频重采样，
+// 视频 / 音频输出为空实现（取到帧即丢弃），不按时间戳节奏播放，尽快解码到文件尾。
+// 输出整体吞吐（帧/s、MB/s）以及各阶段耗时分布：
+//   demux      每次 av_read_frame
+//   decode     解码线程处理一个数据包（send_packet + receive_frame）
+//   resample   音频帧转换为立体声交错 float（与 AudioPlayer 相同的 SwrContext）
+//   pkt wait   解码线程等待数据包
+//   frame wait 输出端等待解码帧
+// 用于在没有 GPU / 声卡的机器上评估硬件与发现性能回退。
+// 用法：pipeline_bench <媒体文件>
+// 环境变量与播放器相同（RTAV_DECODE_THREAD_MODE、RTAV_IO_MODE 等）。
+extern "C" {
+#include <libavutil/mathematics.h>
+#include <libavutil/samplefmt.h>
+#include <libswresample/swresample.h>
+}
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "audio_resampler.hpp"
+#include "demuxer.hpp"
+#include "latency_histogram.hpp"
+#include "packet_pool.hpp"
+#include "stream_source.hpp"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using utils::LatencyHistogram;
+
+int64_t elapsedUs(Clock::time_point since) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() -
+                                                               since)
+      .count();
+}
+
+struct SinkResult {
+  uint64_t frames = 0;
+  uint64_t samples = 0;      // 仅音频
+  uint64_t pcm_bytes = 0;    // 仅音频：重采样输出字节数
+  LatencyHistogram frame_wait;
+  LatencyHistogram resample;  // 仅音频
+};
+
+// 空的视频输出：取帧后立即归还帧池
+void runVideoSink(StreamSource* source, SinkResult* r) {
+  for (;;) {
+    const auto wait_start = Clock::now();
+    if (!source->waitForFrame([]() { return false; })) break;  // EOF
+    r->frame_wait.record(elapsedUs(wait_start));
+    if (FramePtr frame = source->getNextFrame()) {
+      r->frames++;
+    }
+  }
+}
+
+// 空的音频输出：按常见的立体声 float 设备（采样率与流相同）经
+// createAudioResampler 转换，多声道流在这里下混，丢弃结果
+void runAudioSink(StreamSource* source, SinkResult* r) {
+  const int sample_rate = source->getSampleRate();
+  AudioResampleSpec spec;
+  spec.in_layout = source->getChannelLayout();
+  spec.in_channels = source->getChannels();
+  spec.in_rate = sample_rate;
+  spec.in_fmt = source->getSampleFormat();
+  spec.out_channels = 2;
+  spec.out_rate = sample_rate;
+  spec.out_fmt = AV_SAMPLE_FMT_FLT;
+  SwrContext* swr = createAudioResampler(spec);
+  if (!swr) {
+    std::fprintf(stderr, "could not initialize resampler\n");
+  }
+
+  const int bytes_per_frame =
+      av_get_bytes_per_sample(spec.out_fmt) * spec.out_channels;
+  std::vector<uint8_t> pcm;
+  for (;;) {
+    const auto wait_start = Clock::now();
+    if (!source->waitForFrame([]() { return false; })) break;  // EOF
+    r->frame_wait.record(elapsedUs(wait_start));
+    FramePtr frame = source->getNextFrame();
+    if (!frame) continue;
+    r->frames++;
+    r->samples += frame->frame->nb_samples;
+    if (!swr || frame->frame->nb_samples <= 0) continue;
+
+    const auto resample_start = Clock::now();
+    const int max_out = static_cast<int>(av_rescale_rnd(
+        swr_get_delay(swr, frame->frame->sample_rate) +
+            frame->frame->nb_samples,
+        sample_rate, frame->frame->sample_rate, AV_ROUND_UP));
+    pcm.resize(static_cast<size_t>(max_out) * bytes_per_frame);
+    uint8_t* out[1] = {pcm.data()};
+    const int converted =
+        swr_convert(swr, out, max_out, (const uint8_t**)frame->frame->data,
+                    frame->frame->nb_samples);
+    r->resample.record(elapsedUs(resample_start));
+    if (converted > 0) {
+      r->pcm_bytes += static_cast<uint64_t>(converted) * bytes_per_frame;
+    }
+  }
+  swr_free(&swr);
+}
+
+void printRow(const char* stage, const LatencyHistogram::Snapshot& s) {
+  if (s.count == 0) return;
+  std::printf("%-18s %10llu %10.1f %10lld %10lld %10lld\n", stage,
+              static_cast<unsigned long long>(s.count), s.mean,
+              static_cast<long long>(s.p50), static_cast<long long>(s.p99),
+              static_cast<long long>(s.max));
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  if (argc < 2) {
+    std::fprintf(stderr, "usage: %s <media file>\n", argv[0]);
+    return 1;
+  }
+  const std::string filename = argv[1];
+  av_log_set_level(AV_LOG_ERROR);
+
+  auto demuxer = std::make_shared<Demuxer>();
+  if (!demuxer->open(filename)) {
+    std::fprintf(stderr, "could not open %s\n", filename.c_str());
+    return 1;
+  }
+  StreamSource video(Type::Video);
+  StreamSource audio(Type::Audio);
+  const bool has_video =
+      demuxer->getAVStream(Type::Video) && video.open(demuxer);
+  const bool has_audio =
+      demuxer->getAVStream(Type::Audio) && audio.open(demuxer);
+  if (!has_video && !has_audio) {
+    std::fprintf(stderr, "no decodable stream in %s\n", filename.c_str());
+    return 1;
+  }
+
+  SinkResult video_result;
+  SinkResult audio_result;
+  const auto start = Clock::now();
+  demuxer->start();
+  std::thread video_sink;
+  std::thread audio_sink;
+  if (has_video) {
+    video.startDecoding();
+    video_sink = std::thread(runVideoSink, &video, &video_result);
+  }
+  if (has_audio) {
+    audio.startDecoding();
+    audio_sink = std::thread(runAudioSink, &audio, &audio_result);
+  }
+  if (video_sink.joinable()) video_sink.join();
+  if (audio_sink.joinable()) audio_sink.join();
+  const int64_t wall_us = elapsedUs(start);
+
+  const double wall_s = wall_us / 1e6;
+  const uint64_t bytes_read = demuxer->getBytesRead();
+  std::printf("pipeline benchmark: %s\n", filename.c_str());
+  std::printf("wall %.2f s, input %.1f MB (%.1f MB/s)\n", wall_s,
+              bytes_read / 1e6, wall_s > 0 ? bytes_read / 1e6 / wall_s : 0.0);
+  if (has_video) {
+    std::printf("video: %llu frames, %.1f frames/s (%dx%d)\n",
+                static_cast<unsigned long long>(video_result.frames),
+                wall_s > 0 ? video_result.frames / wall_s : 0.0,
+                video.getWidth(), video.getHeight());
+  }
+  if (has_audio) {
+    std::printf("audio: %llu frames, %.1f frames/s, %.1fx realtime, "
+                "%.1f MB PCM\n",
+                static_cast<unsigned long long>(audio_result.frames),
+                wall_s > 0 ? audio_result.frames / wall_s : 0.0,
+                wall_s > 0 && audio.getSampleRate() > 0
+                    ? audio_result.samples /
+                          static_cast<double>(audio.getSampleRate()) / wall_s
+                    : 0.0,
+                audio_result.pcm_bytes / 1e6);
+  }
+
+  std::printf("\n%-18s %10s %10s %10s %10s %10s\n", "stage (us)", "count",
+              "mean", "p50", "p99", "max");
+  printRow("demux", demuxer->getReadLatency());
+  if (has_video) {
+    const StreamSource::StageLatency v = video.getStageLatency();
+    printRow("video decode", v.decode);
+    printRow("video pkt wait", v.packet_wait);
+    printRow("video frame wait", video_result.frame_wait.snapshot());
+  }
+  if (has_audio) {
+    const StreamSource::StageLatency a = audio.getStageLatency();
+    printRow("audio decode", a.decode);
+    printRow("audio resample", audio_result.resample.snapshot());
+    printRow("audio pkt wait", a.packet_wait);
+    printRow("audio frame wait", audio_result.frame_wait.snapshot());
+  }
+
+  video.stopDecoding();
+  audio.stopDecoding();
+  video.close();
+  audio.close();
+  demuxer->close();
+  demuxer.reset();
+
+  // 所有 StreamSource / Demuxer 关闭后不应再有在外的数据包
+  const uint64_t live = PacketPool::livePackets();
+  if (live != 0) {
+    std::printf("\nWARNING: %llu packets still alive after shutdown\n",
+                static_cast<unsigned long long>(live));
+    return 2;
+  }
+  return 0;
+}
@@ -15,6 +15,7 @@ extern "C" {
 }
 
 #include "utils/logger.hpp"
+#include "utils/trace.hpp"
 
 #ifdef __linux__
 #include <X11/Xlib.h>
@@ -42,6 +43,8 @@ void cleanup() {
 static void signal_handler(int signum) {
   if (signum == SIGINT) {
     quit.store(true);
+  } else if (signum == SIGUSR1) {
+    Tracer::instance().requestDump();  // 由主循环写文件
   }
 }
 
@@ -59,27 +62,20 @@ void handleKeyPress(Player& player, int key) {
   switch (key) {
     case GLFW_KEY_SPACE:
     case GLFW_KEY_P:
-      if (currentState == Player::State::Playing) {
-        player.pause();
-      } else if (currentState == Player::State::Paused) {
-        player.resume();
-      }
+      player.togglePause();  // seek 进行中时切换 seek 完成后的状态
       break;
     case GLFW_KEY_Q:
     case GLFW_KEY_ESCAPE:
       quit.store(true);
       break;
     case GLFW_KEY_R:
-      player.seek(0.0);  // 跳转到开头
-      player.play();
+      player.seekAsync(0.0);  // 跳转到开头，完成后播放
       break;
     case GLFW_KEY_LEFT:
-      player.seek(player.getCurrentTimestamp() - 5.0);  // 后退5秒
-      player.play();
+      player.seekAsync(player.getCurrentTimestamp() - 5.0);  // 后退5秒
       break;
     case GLFW_KEY_RIGHT:
-      player.seek(player.getCurrentTimestamp() + 5.0);  // 前进5秒
-      player.play();
+      player.seekAsync(player.getCurrentTimestamp() + 5.0);  // 前进5秒
       break;
     case GLFW_KEY_UP:
       player.setVolume(std::min(player.getVolume() + 0.0625, 1.0));
@@ -89,7 +85,8 @@ void handleKeyPress(Player& player, int key) {
       break;
     case GLFW_KEY_S:  // 步进 step play
       if (currentState == Player::State::Paused) {
-        player.seek(player.getCurrentTimestamp() + 0.04);  // 默认步进40ms
+        // 默认步进40ms，保持暂停
+        player.seekAsync(player.getCurrentTimestamp() + 0.04, false);
       }
       break;
     case GLFW_KEY_M:  // 静音切换
@@ -154,8 +151,11 @@ int main(int argc, char* argv[]) {
   }
 #endif
 
-  // 注册信号处理函数
+  // 注册信号处理函数；RTAV_TRACE 启用时可用 SIGUSR1 导出当前时间线
   signal(SIGINT, signal_handler);
+  if (Tracer::instance().initFromEnv()) {
+    signal(SIGUSR1, signal_handler);
+  }
 
   // 1. 在主线程中初始化 GLFW
   if (!glfwInit()) {
@@ -198,10 +198,14 @@ int main(int argc, char* argv[]) {
       break;
     }
 
+    Tracer::instance().dumpIfRequested();
     std::this_thread::sleep_for(std::chrono::milliseconds(100));
   }
 
   LOG_INFO << "Exiting program";
   cleanup();
+  if (Tracer::enabled()) {
+    Tracer::instance().dump();
+  }
   return 0;
 }
\ No newline at end of file
@@ -1,8 +1,14 @@
 #include "decoder.hpp"
 
+#include <algorithm>
+#include <thread>
+
 #include "logger.hpp"
+#include "trace.hpp"
 
 extern "C" {
+#include <libavutil/buffer.h>
+#include <libavutil/imgutils.h>
 #include <libavutil/pixdesc.h>
 #include <libavutil/pixfmt.h>
 }
@@ -19,6 +25,41 @@ Decoder::~Decoder() {
   close();
 }
 
+namespace {
+
+const char* threadModeName(int active_thread_type) {
+  if (active_thread_type & FF_THREAD_FRAME) return "frame";
+  if (active_thread_type & FF_THREAD_SLICE) return "slice";
+  return "off";
+}
+
+// 自动线程数：分辨率越高，可用的并行度越大；预留核心给解复用、音频与渲染线程
+int autoThreadCount(Type type, int width, int height) {
+  if (type == Type::Audio) {
+    return 1;  // 音频解码开销很小，多线程只会增加调度开销
+  }
+  const int cores =
+      std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+  const int64_t pixels = static_cast<int64_t>(width) * height;
+  int wanted;
+  if (pixels <= 1280 * 720) {
+    wanted = 4;
+  } else if (pixels <= 1920 * 1080) {
+    wanted = 8;
+  } else {
+    wanted = 16;  // 4K 及以上；更多线程时 H.264/HEVC 的收益已不明显
+  }
+  const int usable = cores > 4 ? cores - 2 : cores;
+  return std::max(1, std::min(wanted, usable));
+}
+
+}  // namespace
+
+void Decoder::setThreading(ThreadMode mode, int thread_count) {
+  requested_thread_mode_ = mode;
+  requested_thread_count_ = std::max(0, thread_count);
+}
+
 // 打开并初始化解码器，及配置解码器参数
 bool Decoder::open(AVStream* stream) {
   if (!stream) {
@@ -59,37 +100,103 @@ bool Decoder::initializeCodec(AVStream* stream) {
     return false;
   }
 
-  // 4. 打开解码器
+  // 4. 线程策略（必须在 avcodec_open2 之前设置）
+  applyThreading(codec);
+
+  // 5. 视频帧缓冲改由本对象的缓冲池提供（解码器需支持 DR1）
+  if (type_ == Type::Video && (codec->capabilities & AV_CODEC_CAP_DR1)) {
+    codec_ctx_->opaque = this;
+    codec_ctx_->get_buffer2 = &Decoder::getVideoBuffer;
+  }
+
+  // 6. 打开解码器
   if (avcodec_open2(codec_ctx_.get(), codec, nullptr) < 0) {
     LOG_ERROR << "Codec opening failed";
     releaseCodec();
     return false;
   }
 
-  // 5. 配置解码器参数
+  // 7. 配置解码器参数
   if (!configureCodec(stream)) {
     LOG_ERROR << "Configure codec failed";
     releaseCodec();
     return false;
   }
 
+  // 记录实际生效的线程参数（解码器可能不支持请求的模式）
+  const int active = codec_ctx_->active_thread_type;
+  config_.thread_mode = (active & FF_THREAD_FRAME)   ? ThreadMode::Frame
+                        : (active & FF_THREAD_SLICE) ? ThreadMode::Slice
+                                                     : ThreadMode::Off;
+  config_.thread_count = active ? codec_ctx_->thread_count : 1;
+
   if (type_ == Type::Video) {
     const AVPixFmtDescriptor* desc = av_pix_fmt_desc_get(
         static_cast<AVPixelFormat>(stream->codecpar->format));
     LOG_INFO << "Video codec opened: " << codec->name
              << ", resolution: " << codec_ctx_->width << "x"
              << codec_ctx_->height
-             << ", pixel format: " << (desc ? desc->name : "unknown");
+             << ", pixel format: " << (desc ? desc->name : "unknown")
+             << ", threads: " << config_.thread_count << " ("
+             << threadModeName(active) << ")";
   } else {
     LOG_INFO << "Audio codec opened: " << codec->name
              << ", sample rate: " << codec_ctx_->sample_rate
              << ", channels: " << codec_ctx_->ch_layout.nb_channels
              << ", sample format: "
-             << av_get_sample_fmt_name(codec_ctx_->sample_fmt);
+             << av_get_sample_fmt_name(codec_ctx_->sample_fmt)
+             << ", threads: " << config_.thread_count << " ("
+             << threadModeName(active) << ")";
   }
   return true;
 }
 
+void Decoder::applyThreading(const AVCodec* codec) {
+  const bool can_frame = codec->capabilities & AV_CODEC_CAP_FRAME_THREADS;
+  const bool can_slice = codec->capabilities & AV_CODEC_CAP_SLICE_THREADS;
+
+  int count = requested_thread_count_;
+  if (count == 0) {
+    count = autoThreadCount(type_, codec_ctx_->width, codec_ctx_->height);
+  }
+
+  int thread_type = 0;
+  switch (requested_thread_mode_) {
+    case ThreadMode::Off:
+      count = 1;
+      break;
+    case ThreadMode::Frame:
+      if (can_frame) {
+        thread_type = FF_THREAD_FRAME;
+      } else if (can_slice) {
+        LOG_WARN << codec->name
+                 << " does not support frame threading, using slice threads";
+        thread_type = FF_THREAD_SLICE;
+      }
+      break;
+    case ThreadMode::Slice:
+      if (can_slice) {
+        thread_type = FF_THREAD_SLICE;
+      } else if (can_frame) {
+        LOG_WARN << codec->name
+                 << " does not support slice threading, using frame threads";
+        thread_type = FF_THREAD_FRAME;
+      }
+      break;
+    case ThreadMode::Auto:
+      thread_type = can_frame   ? FF_THREAD_FRAME
+                    : can_slice ? FF_THREAD_SLICE
+                                : 0;
+      break;
+  }
+  if (thread_type == 0) {
+    count = 1;  // 解码器不支持多线程
+  }
+
+  codec_ctx_->thread_count = count;
+  codec_ctx_->thread_type = count > 1 ? thread_type : 0;
+}
+
 bool Decoder::configureCodec(AVStream* stream) {
   config_.type = type_;
   if (type_ == Type::Audio) {
@@ -120,10 +227,105 @@ void Decoder::close() {
   releaseCodec();
 }
 
-void Decoder::releaseCodec() { codec_ctx_.reset(); }
+void Decoder::releaseCodec() {
+  codec_ctx_.reset();
+  releaseBufferPools();  // 已借出的缓冲在帧释放后才真正回收
+}
+
+int Decoder::getVideoBuffer(AVCodecContext* ctx, AVFrame* frame, int flags) {
+  auto* self = static_cast<Decoder*>(ctx->opaque);
+  const AVPixFmtDescriptor* desc =
+      av_pix_fmt_desc_get(static_cast<AVPixelFormat>(frame->format));
+  // 硬件帧、调色板格式等交给默认实现
+  if (!self || !desc ||
+      (desc->flags & (AV_PIX_FMT_FLAG_HWACCEL | AV_PIX_FMT_FLAG_PAL))) {
+    return avcodec_default_get_buffer2(ctx, frame, flags);
+  }
+  int ret = self->allocPooledFrame(ctx, frame);
+  if (ret < 0) {
+    return avcodec_default_get_buffer2(ctx, frame, flags);
+  }
+  return 0;
+}
+
+AVBufferRef* Decoder::allocPoolBuffer(void* opaque, size_t size) {
+  auto* self = static_cast<Decoder*>(opaque);
+  self->buffer_allocs_.fetch_add(1, std::memory_order_relaxed);
+  return av_buffer_alloc(size);
+}
+
+int Decoder::allocPooledFrame(AVCodecContext* ctx, AVFrame* frame) {
+  const auto pix_fmt = static_cast<AVPixelFormat>(frame->format);
+
+  // 解码器要求的对齐尺寸（宏块边界等），行宽再按 BUFFER_ALIGN 对齐
+  int width = frame->width;
+  int height = frame->height;
+  int stride_align[AV_NUM_DATA_POINTERS];
+  avcodec_align_dimensions2(ctx, &width, &height, stride_align);
+
+  int linesizes[4] = {0, 0, 0, 0};
+  int ret = av_image_fill_linesizes(linesizes, pix_fmt, width);
+  if (ret < 0) return ret;
+  ptrdiff_t aligned_linesizes[4];
+  for (int i = 0; i < 4; ++i) {
+    linesizes[i] = FFALIGN(linesizes[i], BUFFER_ALIGN);
+    aligned_linesizes[i] = linesizes[i];
+  }
+  size_t plane_sizes[4] = {0, 0, 0, 0};
+  ret = av_image_fill_plane_sizes(plane_sizes, pix_fmt, height,
+                                  aligned_linesizes);
+  if (ret < 0) return ret;
+
+  // 失败时只释放本函数取得的缓冲并清空对应平面，保留解码器设置的帧属性，
+  // 调用方随后可以回退到 avcodec_default_get_buffer2
+  auto release_planes = [frame](int count) {
+    for (int j = 0; j < count; ++j) {
+      av_buffer_unref(&frame->buf[j]);
+      frame->data[j] = nullptr;
+      frame->linesize[j] = 0;
+    }
+  };
+
+  std::lock_guard<std::mutex> lock(pool_mutex_);
+  for (int i = 0; i < 4 && plane_sizes[i] > 0; ++i) {
+    // 额外空间：起始地址对齐 + 解码器可能的越界读取
+    const size_t pool_size =
+        plane_sizes[i] + BUFFER_ALIGN + AV_INPUT_BUFFER_PADDING_SIZE;
+    if (!pools_[i] || pool_sizes_[i] != pool_size) {
+      av_buffer_pool_uninit(&pools_[i]);  // 尺寸变化：旧池在缓冲归还后释放
+      pools_[i] = av_buffer_pool_init2(pool_size, this, &Decoder::allocPoolBuffer,
+                                       nullptr);
+      pool_sizes_[i] = pools_[i] ? pool_size : 0;
+      if (!pools_[i]) {
+        release_planes(i);
+        return AVERROR(ENOMEM);
+      }
+    }
+    frame->buf[i] = av_buffer_pool_get(pools_[i]);
+    if (!frame->buf[i]) {
+      release_planes(i);
+      return AVERROR(ENOMEM);
+    }
+    auto addr = reinterpret_cast<uintptr_t>(frame->buf[i]->data);
+    frame->data[i] = reinterpret_cast<uint8_t*>(
+        (addr + BUFFER_ALIGN - 1) & ~static_cast<uintptr_t>(BUFFER_ALIGN - 1));
+    frame->linesize[i] = linesizes[i];
+  }
+  frame->extended_data = frame->data;
+  return 0;
+}
+
+void Decoder::releaseBufferPools() {
+  std::lock_guard<std::mutex> lock(pool_mutex_);
+  for (int i = 0; i < 4; ++i) {
+    av_buffer_pool_uninit(&pools_[i]);
+    pool_sizes_[i] = 0;
+  }
+}
 
 // 发送压缩数据包到解码器的输入缓冲区（packet 可能为 nullptr，表示刷新解码器）
 int Decoder::decodePacket(AVPacket* packet) {
+  TRACE_SCOPE("decodePacket");
   std::lock_guard<std::mutex> lock(mutex_);  // 锁保护，避免竞态
   if (!codec_ctx_) {
     LOG_ERROR << "Codec context is not initialized";
@@ -160,41 +362,55 @@ int Decoder::decodePacket(AVPacket* packet) {
   return 0;
 }
 
-// 接收解码后的帧，存到 frame 指向的 AVFrame 结构体中
-std::unique_ptr<AVFrame> Decoder::receiveFrame() {
+// 接收解码后的帧，存到调用方提供的 AVFrame 中（不分配新帧）
+bool Decoder::receiveFrame(AVFrame* frame) {
+  TRACE_SCOPE("receiveFrame");
   std::lock_guard<std::mutex> lock(mutex_);  // 锁保护，避免竞态
-  if (!codec_ctx_) {
+  if (!codec_ctx_ || !frame) {
     LOG_ERROR << "Codec context is not initialized";
-    return nullptr;
-  }
-
-  AVFrame* frame = av_frame_alloc();
-  if (!frame) {
-    LOG_ERROR << "Failed to allocate frame";
-    return nullptr;
+    return false;
   }
 
   int ret = avcodec_receive_frame(codec_ctx_.get(), frame);
   if (ret == AVERROR(EAGAIN)) {
     // 需要更多数据包才能解码出帧
-    av_frame_free(&frame);
-    LOG_DEBUG << "Decoder needs more packets to produce a frame";
-    return nullptr;
+    return false;
   } else if (ret == AVERROR_EOF) {
     // 解码器已经完全刷新，无法再输出帧
-    av_frame_free(&frame);
     LOG_DEBUG << "Decoder has been fully flushed, no more frames";
-    return nullptr;
+    return false;
   } else if (ret < 0) {
-    av_frame_free(&frame);
     char errbuf[AV_ERROR_MAX_STRING_SIZE];
     av_strerror(ret, errbuf, AV_ERROR_MAX_STRING_SIZE);
     LOG_ERROR << "Error receiving frame from decoder: " << errbuf;
-    return nullptr;
+    return false;
   }
+  return true;
+}
+
+void Decoder::setDegradeLevel(int level) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  degrade_level_ = level;
+  applySkipSettings();
+}
 
-  LOG_DEBUG << "Frame received from decoder, pts: " << frame->pts;
-  return std::unique_ptr<AVFrame>(frame);  // 返回智能指针，自动释放
+void Decoder::setDiscardNonRef(bool discard) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  discard_nonref_ = discard;
+  applySkipSettings();
+}
+
+void Decoder::applySkipSettings() {
+  if (!codec_ctx_ || type_ != Type::Video) return;
+  const int level = degrade_level_;
+  codec_ctx_->skip_loop_filter = level >= 1 ? AVDISCARD_ALL : AVDISCARD_DEFAULT;
+  if (level >= 3) {
+    codec_ctx_->skip_frame = AVDISCARD_NONKEY;
+  } else if (level >= 2 || discard_nonref_) {
+    codec_ctx_->skip_frame = AVDISCARD_NONREF;
+  } else {
+    codec_ctx_->skip_frame = AVDISCARD_DEFAULT;
+  }
 }
 
 void Decoder::flush() {
@@ -6,6 +6,8 @@ extern "C" {
 #include <libswresample/swresample.h>
 }
 
+#include <atomic>
+#include <cstdint>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -15,10 +17,16 @@ extern "C" {
 /**
  * Decoder: 封装 FFmpeg 解码器，支持音频/视频解码、重采样和转换。
  * 可通过继承重写 configureCodec() 自定义解码器配置。
+ * 视频解码使用自定义 get_buffer2：每个平面一个 AVBufferPool，行宽与平面
+ * 起始地址按 BUFFER_ALIGN 对齐，供渲染线程直接上传，稳态下不再分配像素缓冲。
  * 注意：多线程使用时需使用内部 mutex 同步
  */
 class Decoder {
  public:
+  // 解码线程模式：Frame 吞吐最高但每个线程增加一帧延迟；Slice 不增加延迟，
+  // 但依赖码流中的切片数；Auto 按解码器能力优先选 Frame
+  enum class ThreadMode { Auto, Frame, Slice, Off };
+
   struct Config {
     Type type;
     // 音频参数
@@ -29,11 +37,17 @@ class Decoder {
     int width = 0;
     int height = 0;
     AVPixelFormat pixel_format = AV_PIX_FMT_NONE;
+    // 线程参数：open() 前为请求值，open() 后为实际生效的值
+    ThreadMode thread_mode = ThreadMode::Auto;
+    int thread_count = 0;  // 0 表示按分辨率与 CPU 核数自动选择
   };
 
   Decoder(Type type);
   virtual ~Decoder();
 
+  // 设置解码线程策略，需在 open() 之前调用
+  void setThreading(ThreadMode mode, int thread_count = 0);
+
   // 用 Demuxer 获取 AVStream 指针初始化解码器上下文
   bool open(AVStream* stream);
 
@@ -43,16 +57,29 @@ class Decoder {
   // 解码 Demuxer 读取的 AVPacket
   int decodePacket(AVPacket* packet);
 
-  // 接收解码帧：从解码器获取解码后的帧。
-  std::unique_ptr<AVFrame> receiveFrame();
+  // 接收解码帧到调用方提供的 frame（原有引用会被释放），成功返回 true
+  bool receiveFrame(AVFrame* frame);
 
   // 刷新解码器：处理缓冲区剩余数据，通常在 EOF 时调用。
   void flush();
 
+  // 降级解码（仅视频）：0 正常，1 跳过环路滤波，2 再跳过非参考帧，
+  // 3 只解码关键帧。在两次 decodePacket 之间调用即可生效
+  void setDegradeLevel(int level);
+
+  // seek 解码到目标之前丢弃非参考帧（仅视频；解码器不支持时无效果）。
+  // 参考帧照常完整解码，不影响目标帧画质
+  void setDiscardNonRef(bool discard);
+
   const Config& getConfig() const { return config_; }
   AVCodecContext* getCodecContext() const { return codec_ctx_.get(); }
   bool isOpen() const { return codec_ctx_ != nullptr; }
 
+  // 视频像素缓冲池实际分配的缓冲数（稳态播放时应保持不变）
+  uint64_t getBufferAllocations() const { return buffer_allocs_.load(); }
+
+  static constexpr int BUFFER_ALIGN = 64;  // 行宽与平面起始地址的对齐字节数
+
  protected:
   virtual bool configureCodec(AVStream* stream);
 
@@ -75,11 +102,30 @@ class Decoder {
   };
 
   bool initializeCodec(AVStream* stream);  // 设置 AVCodecContext, SwrContext。
+  void applyThreading(const AVCodec* codec);  // 打开解码器前设置线程参数
+  void applySkipSettings();  // 按降级等级与 seek 状态设置丢弃策略（需持 mutex_）
   void releaseCodec();                     // 释放 AVCodecContext, SwrContext。
 
+  // get_buffer2 回调：从按平面划分的缓冲池中取像素缓冲
+  static int getVideoBuffer(AVCodecContext* ctx, AVFrame* frame, int flags);
+  static AVBufferRef* allocPoolBuffer(void* opaque, size_t size);
+  // ctx 为回调传入的上下文（帧线程模式下是各线程自己的副本）
+  int allocPooledFrame(AVCodecContext* ctx, AVFrame* frame);
+  void releaseBufferPools();
+
   Type type_;
   Config config_;
+  ThreadMode requested_thread_mode_ = ThreadMode::Auto;
+  int requested_thread_count_ = 0;
+  int degrade_level_ = 0;
+  bool discard_nonref_ = false;
   std::unique_ptr<AVCodecContext, AVCodecContextDeleter> codec_ctx_;
   std::unique_ptr<SwrContext, SwrContextDeleter> swr_ctx_;
   std::mutex mutex_;
+
+  // 视频像素缓冲池，可能在解码器的工作线程中访问，由 pool_mutex_ 保护
+  std::mutex pool_mutex_;
+  AVBufferPool* pools_[4] = {nullptr, nullptr, nullptr, nullptr};
+  size_t pool_sizes_[4] = {0, 0, 0, 0};
+  std::atomic<uint64_t> buffer_allocs_{0};
 };
\ No newline at end of file
@@ -1,11 +1,90 @@
 #include "demuxer.hpp"
 
+extern "C" {
+#include <libavutil/time.h>
+}
+
+#ifdef __linux__
+#include <sys/vfs.h>
+#endif
+
+#include <cstdlib>
+#include <cstring>
+
 #include "logger.hpp"
+#include "stream_info_cache.hpp"
+#include "trace.hpp"
 
 using namespace utils;
 
-Demuxer::Demuxer(Type type) : type_(type) {
+// 读取限流：所有队列总字节数上限，以及每个流"足够"的最少包数。
+// 只有当所有流都足够或总字节数超限时才暂停读取，避免某个流缺包时死锁。
+static const int64_t MAX_QUEUE_BYTES = 16 * 1024 * 1024;
+static const size_t MIN_QUEUE_PACKETS = 25;
+
+// 首次探测流信息的上限：大多数文件在前 1 MB / 0.5 s 内即可确定参数，
+// 不足时放宽到 FFmpeg 默认值（5 MB / 5 s）再探测一次
+static const int64_t PROBE_SIZE = 1024 * 1024;
+static const int64_t PROBE_DURATION = AV_TIME_BASE / 2;
+static const int64_t FALLBACK_PROBE_SIZE = 5000000;
+static const int64_t FALLBACK_PROBE_DURATION = 5 * AV_TIME_BASE;
+
+// 预读缓冲状态的输出间隔
+static const int64_t READ_AHEAD_REPORT_INTERVAL_US = 5 * 1000000;
+
+// 文件是否位于网络 / 用户态文件系统上：这类存储延迟抖动大，mmap 缺页会
+// 直接阻塞读取线程，改用后台预读
+static bool isNetworkFilesystem(const std::string& filename) {
+#ifdef __linux__
+  struct statfs fs;
+  if (::statfs(filename.c_str(), &fs) != 0) {
+    return false;
+  }
+  switch (static_cast<unsigned long>(fs.f_type)) {
+    case 0x6969:      // NFS
+    case 0x517B:      // SMB
+    case 0xFE534D42:  // SMB2
+    case 0xFF534D42:  // CIFS
+    case 0x65735546:  // FUSE（sshfs、rclone 等）
+      return true;
+    default:
+      return false;
+  }
+#else
+  (void)filename;
+  return false;
+#endif
+}
+
+Demuxer::Demuxer() {
   LOG_INFO << "Initializing Demuxer";
+  // 解码线程取走数据包后唤醒可能因队列足够而等待的读取线程
+  video_queue_.setPopEvent(&reader_event_);
+  audio_queue_.setPopEvent(&reader_event_);
+  const char* env = std::getenv("RTAV_DISABLE_MMAP_IO");
+  if (env && env[0] != '\0' && env[0] != '0') {
+    io_mode_ = IOMode::Default;
+  }
+  env = std::getenv("RTAV_IO_MODE");
+  if (env) {
+    if (std::strcmp(env, "default") == 0) {
+      io_mode_ = IOMode::Default;
+    } else if (std::strcmp(env, "mmap") == 0) {
+      io_mode_ = IOMode::Mmap;
+    } else if (std::strcmp(env, "readahead") == 0) {
+      io_mode_ = IOMode::ReadAhead;
+    } else if (std::strcmp(env, "auto") != 0) {
+      LOG_WARN << "Unknown RTAV_IO_MODE: " << env;
+    }
+  }
+  env = std::getenv("RTAV_DISABLE_PROBE_CACHE");
+  if (env && env[0] != '\0' && env[0] != '0') {
+    probe_cache_enabled_ = false;
+  }
+  env = std::getenv("RTAV_READAHEAD_MB");
+  if (env && std::atoi(env) > 0) {
+    read_ahead_window_ = static_cast<int64_t>(std::atoi(env)) * 1024 * 1024;
+  }
 }
 
 Demuxer::~Demuxer() {
@@ -19,46 +98,75 @@ bool Demuxer::open(const std::string& filename) {
     return false;
   }
 
-  // 打开输入文件并读取头信息
+  // 打开输入文件并读取头信息；普通文件优先使用自定义 IO
+  open_stats_ = OpenStats();
+  read_latency_.reset();
+  bytes_read_.store(0);
+  const int64_t open_start_us = av_gettime_relative();
   AVFormatContext* temp_ctx = nullptr;
+  if (AVIOContext* pb = openCustomIO(filename)) {
+    temp_ctx = avformat_alloc_context();
+    if (!temp_ctx) {
+      LOG_ERROR << "Could not allocate format context";
+      closeCustomIO();
+      return false;
+    }
+    temp_ctx->pb = pb;
+    temp_ctx->flags |= AVFMT_FLAG_CUSTOM_IO;
+  }
   if (avformat_open_input(&temp_ctx, filename.c_str(), nullptr, nullptr) < 0) {
     LOG_ERROR << "Could not open input file: " << filename;
+    closeCustomIO();  // 失败时 temp_ctx 已被释放，自定义 IO 需自行释放
     return false;
   }
   format_ctx_.reset(temp_ctx);
+  const int64_t probe_start_us = av_gettime_relative();
+  open_stats_.open_us = probe_start_us - open_start_us;
 
   // 获取流信息
-  if (avformat_find_stream_info(format_ctx_.get(), nullptr) < 0) {
+  if (!probeStreams(filename)) {
     LOG_ERROR << "Could not find stream information";
     close();
     return false;
   }
+  open_stats_.probe_us = av_gettime_relative() - probe_start_us;
 
-  // 查找目标流（根据 type_）
+  // 查找音视频流，其余流直接丢弃，不再由 av_read_frame 返回
+  video_index_ = av_find_best_stream(format_ctx_.get(), AVMEDIA_TYPE_VIDEO, -1,
+                                     -1, nullptr, 0);
+  audio_index_ = av_find_best_stream(format_ctx_.get(), AVMEDIA_TYPE_AUDIO, -1,
+                                     video_index_, nullptr, 0);
+  if (video_index_ < 0) video_index_ = -1;
+  if (audio_index_ < 0) audio_index_ = -1;
   for (unsigned int i = 0; i < format_ctx_->nb_streams; ++i) {
     AVStream* stream = format_ctx_->streams[i];
-    if ((type_ == Type::Video &&
-         stream->codecpar->codec_type == AVMEDIA_TYPE_VIDEO) ||
-        (type_ == Type::Audio &&
-         stream->codecpar->codec_type == AVMEDIA_TYPE_AUDIO)) {
-      stream_index_ = i;
-      stream_ = stream;
-      break;  // 找到第一个匹配的流
+    if (static_cast<int>(i) == video_index_) {
+      video_stream_ = stream;
+    } else if (static_cast<int>(i) == audio_index_) {
+      audio_stream_ = stream;
+    } else {
+      stream->discard = AVDISCARD_ALL;
     }
   }
 
-  if (stream_index_ < 0) {
-    LOG_ERROR << "No " << (type_ == Type::Video ? "video" : "audio")
-              << " stream found";
+  if (video_index_ < 0 && audio_index_ < 0) {
+    LOG_ERROR << "No audio or video stream found";
     close();
     return false;
   }
 
   LOG_INFO << "Opened file: " << filename << ", format: "
            << (format_ctx_->iformat ? format_ctx_->iformat->name : "unknown")
-           << ", duration: " << getDuration() / 1000000.0 << " sec, "
-           << (type_ == Type::Video ? "video" : "audio")
-           << " stream index: " << stream_index_;
+           << ", duration: " << getDuration() / 1000000.0
+           << " sec, video stream index: " << video_index_
+           << ", audio stream index: " << audio_index_ << ", open "
+           << open_stats_.open_us / 1000.0 << " ms, probe "
+           << open_stats_.probe_us / 1000.0 << " ms"
+           << (open_stats_.probe_cached ? " (cached)" : "");
+
+  if (needsKeyframeIndex()) {
+    keyframe_index_.open(filename, video_index_);
+  }
 
   eof_ = false;
   return true;
@@ -66,52 +174,219 @@ bool Demuxer::open(const std::string& filename) {
 
 void Demuxer::close() {
   LOG_INFO << "Closing demuxer";
+  stop();
+  keyframe_index_.close();
+  video_queue_.flush();
+  audio_queue_.flush();
+  const PacketPool::Stats packet_stats = packet_pool_.getStats();
+  if (packet_stats.acquired > 0) {
+    LOG_INFO << "Packet pool: " << packet_stats.allocated << " allocated, "
+             << packet_stats.acquired << " acquired, "
+             << packet_stats.outstanding << " outstanding";
+  }
+  if (packet_stats.outstanding > 0) {
+    LOG_WARN << packet_stats.outstanding
+             << " packets still held after closing the demuxer";
+  }
   format_ctx_.reset();
-  stream_ = nullptr;
-  stream_index_ = -1;
+  closeCustomIO();
+  video_stream_ = nullptr;
+  audio_stream_ = nullptr;
+  video_index_ = -1;
+  audio_index_ = -1;
   eof_ = false;  // 重置 EOF 状态
 }
 
-std::unique_ptr<AVPacket> Demuxer::readNextPacket() {
-  std::lock_guard<std::mutex> lock(mutex_);  // 锁保护，避免竞态
+void Demuxer::start() {
   if (!format_ctx_) {
-    LOG_ERROR << "Format context is not initialized";
-    return nullptr;
+    LOG_ERROR << "Demuxer not initialized";
+    return;
   }
-  if (stream_index_ < 0) {
-    LOG_ERROR << "No valid target stream";
-    return nullptr;
+  if (reading_.exchange(true)) {
+    return;  // 读取线程已在运行
   }
-  // 循环读取，直到找到目标流的数据包
-  while (true) {
-    AVPacket* packet = av_packet_alloc();
-    if (!packet) {
-      LOG_ERROR << "Could not allocate packet";
-      return nullptr;
+  LOG_INFO << "Starting demuxer reading thread";
+  reading_thread_ = std::thread(&Demuxer::readingLoop, this);
+}
+
+void Demuxer::stop() {
+  {
+    std::lock_guard<std::mutex> lock(control_mutex_);
+    reading_.store(false);
+  }
+  control_cond_.notify_all();
+  reader_event_.notifyAll();
+  video_queue_.notifyAll();  // 唤醒等待数据包的 seek
+  audio_queue_.notifyAll();
+  if (reading_thread_.joinable()) {
+    reading_thread_.join();
+    LOG_INFO << "Demuxer reading thread stopped";
+  }
+}
+
+void Demuxer::readingLoop() {
+  TRACE_THREAD_NAME("demux");
+  while (reading_.load()) {
+    // 1. 处理挂起的 seek 请求
+    {
+      std::unique_lock<std::mutex> lock(control_mutex_);
+      if (seek_pending_) {
+        seek_result_ = doSeek(seek_target_, seek_flags_);
+        seek_pending_ = false;
+        lock.unlock();
+        control_cond_.notify_all();
+        continue;
+      }
+    }
+
+    // 2. 已到达 EOF 或队列足够时阻塞，直到数据包被取走、seek 或停止
+    if (eof_.load() || !needMorePackets()) {
+      reader_event_.wait([this]() {
+        return seek_pending_.load() || !reading_.load() ||
+               (!eof_.load() && needMorePackets());
+      });
+      continue;
     }
 
-    int ret = av_read_frame(format_ctx_.get(), packet);
-    if (ret < 0) {
-      av_packet_free(&packet);
-      if (ret == AVERROR_EOF) {
-        eof_ = true;
-        LOG_INFO << "End of file reached";
+    // 3. 读取一个数据包并分发到对应流的队列
+    reportReadAhead(false);
+    PacketPtr packet = readNextPacket();
+    if (!packet) {
+      if (eof_.load()) {
+        video_queue_.setEOF();
+        audio_queue_.setEOF();
       } else {
-        char errbuf[AV_ERROR_MAX_STRING_SIZE];
-        av_strerror(ret, errbuf, AV_ERROR_MAX_STRING_SIZE);
-        LOG_ERROR << "Error reading frame: " << errbuf;
+        // 读取出错时稍后重试，seek 或停止可立即打断
+        reader_event_.waitFor(std::chrono::milliseconds(10), [this]() {
+          return seek_pending_.load() || !reading_.load();
+        });
       }
-      return nullptr;
+      continue;
+    }
+
+    if (packet->stream_index == video_index_) {
+      video_queue_.push(std::move(packet));
+    } else if (packet->stream_index == audio_index_) {
+      audio_queue_.push(std::move(packet));
     }
+    // 其他流的数据包随 PacketPtr 自动释放
+  }
+}
 
-    if (packet->stream_index == stream_index_) {
-      // 只返回目标流的数据包
-      return std::unique_ptr<AVPacket>(packet);
+bool Demuxer::probeStreams(const std::string& filename) {
+  AVFormatContext* ctx = format_ctx_.get();
+  StreamInfoCache cache(filename);
+  if (probe_cache_enabled_ && cache.apply(ctx)) {
+    open_stats_.probe_cached = true;
+    return true;
+  }
+
+  ctx->probesize = PROBE_SIZE;
+  ctx->max_analyze_duration = PROBE_DURATION;
+  if (avformat_find_stream_info(ctx, nullptr) < 0) {
+    return false;
+  }
+  if (!StreamInfoCache::isComplete(ctx)) {
+    // 已读取的数据包仍在 libavformat 内部缓冲中，再次探测只读取不足的部分
+    LOG_INFO << "Stream parameters incomplete after bounded probe, retrying";
+    ctx->probesize = FALLBACK_PROBE_SIZE;
+    ctx->max_analyze_duration = FALLBACK_PROBE_DURATION;
+    if (avformat_find_stream_info(ctx, nullptr) < 0) {
+      return false;
+    }
+  }
+  if (probe_cache_enabled_) {
+    cache.store(ctx);
+  }
+  return true;
+}
+
+AVIOContext* Demuxer::openCustomIO(const std::string& filename) {
+  IOMode mode = io_mode_;
+  if (mode == IOMode::Auto) {
+    mode = isNetworkFilesystem(filename) ? IOMode::ReadAhead : IOMode::Mmap;
+  }
+  if (mode == IOMode::ReadAhead &&
+      read_ahead_io_.open(filename, read_ahead_window_)) {
+    read_ahead_report_us_ = av_gettime_relative();
+    return read_ahead_io_.context();
+  }
+  if (mode == IOMode::Mmap && mmap_io_.open(filename)) {
+    return mmap_io_.context();
+  }
+  return nullptr;  // 默认 file 协议（或非普通文件）
+}
+
+void Demuxer::closeCustomIO() {
+  if (mmap_io_.isOpen()) {
+    const MmapIO::Stats stats = mmap_io_.getStats();
+    LOG_INFO << "mmap IO: " << stats.reads << " reads, " << stats.bytes
+             << " bytes, " << stats.seeks << " seeks, " << stats.hints
+             << " madvise hints";
+    mmap_io_.close();
+  }
+  if (read_ahead_io_.isOpen()) {
+    reportReadAhead(true);
+    read_ahead_io_.close();
+  }
+}
+
+void Demuxer::reportReadAhead(bool force) {
+  if (!read_ahead_io_.isOpen()) {
+    return;
+  }
+  const int64_t now = av_gettime_relative();
+  if (!force && now - read_ahead_report_us_ < READ_AHEAD_REPORT_INTERVAL_US) {
+    return;
+  }
+  read_ahead_report_us_ = now;
+  const ReadAheadIO::Stats stats = read_ahead_io_.getStats();
+  LOG_INFO << "Read-ahead IO: fill " << stats.fill / 1024 << "/"
+           << stats.capacity / 1024 << " KB, " << stats.stalls << " stalls ("
+           << stats.stall_us / 1000 << " ms), seeks " << stats.seeks_in_window
+           << " in window / " << stats.seeks_refill << " refill";
+}
+
+PacketPtr Demuxer::readNextPacket() {
+  TRACE_SCOPE("readNextPacket");
+  if (!format_ctx_) {
+    LOG_ERROR << "Format context is not initialized";
+    return nullptr;
+  }
+
+  PacketPtr packet = packet_pool_.acquire();
+  if (!packet) {
+    LOG_ERROR << "Could not allocate packet";
+    return nullptr;
+  }
+
+  const int64_t begin_us = av_gettime_relative();
+  int ret = av_read_frame(format_ctx_.get(), packet.get());
+  read_latency_.record(av_gettime_relative() - begin_us);
+  if (ret < 0) {
+    if (ret == AVERROR_EOF) {
+      eof_ = true;
+      LOG_INFO << "End of file reached";
     } else {
-      // 释放非目标流的数据包，继续读取
-      av_packet_free(&packet);
+      char errbuf[AV_ERROR_MAX_STRING_SIZE];
+      av_strerror(ret, errbuf, AV_ERROR_MAX_STRING_SIZE);
+      LOG_ERROR << "Error reading frame: " << errbuf;
     }
+    return nullptr;
+  }
+  bytes_read_.fetch_add(packet->size, std::memory_order_relaxed);
+  return packet;
+}
+
+bool Demuxer::needMorePackets() const {
+  if (video_queue_.bytes() + audio_queue_.bytes() > MAX_QUEUE_BYTES) {
+    return false;
   }
+  bool video_enough =
+      video_index_ < 0 || video_queue_.size() >= MIN_QUEUE_PACKETS;
+  bool audio_enough =
+      audio_index_ < 0 || audio_queue_.size() >= MIN_QUEUE_PACKETS;
+  return !(video_enough && audio_enough);
 }
 
 bool Demuxer::seek(int64_t timestamp, int flags) {
@@ -120,27 +395,71 @@ bool Demuxer::seek(int64_t timestamp, int flags) {
     return false;
   }
 
-  if (stream_index_ < 0) {
-    LOG_ERROR << "No valid stream for seeking";
-    return false;
+  if (!reading_.load()) {
+    return doSeek(timestamp, flags);
+  }
+
+  // 读取线程运行中：提交请求并等待读取线程完成 seek
+  std::unique_lock<std::mutex> lock(control_mutex_);
+  seek_target_ = timestamp;
+  seek_flags_ = flags;
+  seek_pending_ = true;
+  reader_event_.notifyAll();
+  control_cond_.wait(lock,
+                     [this]() { return !seek_pending_ || !reading_.load(); });
+  if (seek_pending_) {
+    // 读取线程已停止，直接执行
+    seek_pending_ = false;
+    lock.unlock();
+    return doSeek(timestamp, flags);
   }
+  return seek_result_;
+}
 
-  AVStream* stream = format_ctx_->streams[stream_index_];
-  if (!stream) {
-    LOG_ERROR << "Invalid stream for seeking";
+bool Demuxer::needsKeyframeIndex() const {
+  if (!video_stream_ || !format_ctx_->iformat || !format_ctx_->pb) {
+    return false;
+  }
+  if (format_ctx_->iformat->flags & (AVFMT_NO_BYTE_SEEK | AVFMT_NOFILE)) {
     return false;
   }
+  // MP4 / MKV 等在打开时已有完整索引；只有寥寥几项时说明索引缺失，
+  // av_seek_frame 会退化为按字节二分查找
+  return avformat_index_get_entries_count(video_stream_) < 16;
+}
 
-  // 将微秒转换为流的时间基准单位
-  int64_t seek_target =
-      av_rescale_q(timestamp, AV_TIME_BASE_Q, stream->time_base);
+bool Demuxer::seekByIndex(int64_t timestamp) {
+  KeyframeIndex::Entry entry;
+  if (!keyframe_index_.lookup(timestamp, &entry)) {
+    return false;
+  }
+  int ret = av_seek_frame(format_ctx_.get(), video_index_, entry.pos,
+                          AVSEEK_FLAG_BYTE);
+  if (ret < 0) {
+    LOG_WARN << "Byte seek to keyframe at " << entry.pos
+             << " failed, falling back to av_seek_frame";
+    return false;
+  }
+  LOG_DEBUG << "Seek via keyframe index: target " << timestamp
+            << "us, keyframe pts " << entry.pts << "us, pos " << entry.pos;
+  return true;
+}
 
-  LOG_DEBUG << "Seeking to " << timestamp
-            << "us (stream timebase: " << stream->time_base.num << "/"
-            << stream->time_base.den << ", target: " << seek_target << ")";
+bool Demuxer::doSeek(int64_t timestamp, int flags) {
+  LOG_DEBUG << "Seeking to " << timestamp << "us";
 
-  int ret = av_seek_frame(format_ctx_.get(), stream_index_, seek_target, flags);
+  // 向后 seek 且关键帧索引可用时直接按字节定位到目标之前的关键帧
+  if ((flags & AVSEEK_FLAG_BACKWARD) && seekByIndex(timestamp)) {
+    video_queue_.flush();
+    audio_queue_.flush();
+    eof_ = false;
+    LOG_INFO << "Successfully seeked to " << timestamp
+             << "us via keyframe index";
+    return true;
+  }
 
+  // stream_index = -1：时间戳以 AV_TIME_BASE 为单位，对所有流生效
+  int ret = av_seek_frame(format_ctx_.get(), -1, timestamp, flags);
   if (ret < 0) {
     char errbuf[AV_ERROR_MAX_STRING_SIZE];
     av_strerror(ret, errbuf, AV_ERROR_MAX_STRING_SIZE);
@@ -148,6 +467,9 @@ bool Demuxer::seek(int64_t timestamp, int flags) {
     return false;
   }
 
+  // 丢弃 seek 前读取的数据包
+  video_queue_.flush();
+  audio_queue_.flush();
   eof_ = false;
   LOG_INFO << "Successfully seeked to " << timestamp << "us";
   return true;
@@ -162,9 +484,11 @@ int64_t Demuxer::getDuration() const {
   }
 
   // 如果格式上下文没有持续时间，尝试从流中获取
-  if (stream_ && stream_->duration != AV_NOPTS_VALUE) {
-    return av_rescale_q(stream_->duration, stream_->time_base, AV_TIME_BASE_Q);
+  for (AVStream* stream : {video_stream_, audio_stream_}) {
+    if (stream && stream->duration != AV_NOPTS_VALUE) {
+      return av_rescale_q(stream->duration, stream->time_base, AV_TIME_BASE_Q);
+    }
   }
 
   return 0;
-}
\ No newline at end of file
+}
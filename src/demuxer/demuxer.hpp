@@ -4,11 +4,20 @@ extern "C" {
 #include <libavformat/avformat.h>
 }
 
+#include <atomic>
+#include <condition_variable>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <thread>
 
+#include "keyframe_index.hpp"
+#include "latency_histogram.hpp"
 #include "mediadefs.h"
+#include "mmap_io.hpp"
+#include "packet_queue.hpp"
+#include "read_ahead_io.hpp"
+#include "wait_event.hpp"
 
 // Custom deleter for AVFormatContext
 struct AVFormatContextDeleter {
@@ -20,38 +29,118 @@ struct AVFormatContextDeleter {
 };
 
 /**
- * Demuxer: 根据媒体类型分离音视频流，提供读取数据包和跳转功能。
- * 读取到 EOF 后设置标志，可通过 isEOF() 查询。
- * 注意：如果多个 Demuxer 共享 AVFormatContext，需加锁保护 readNextPacket()
- * 以避免冲突。
+ * Demuxer: 每个 Player 一个实例，只打开一次媒体文件。
+ * 读取线程 readingLoop 对容器中的每个数据包只读取、解析一次，
+ * 按流分发到对应的 PacketQueue（音频 / 视频），由各自的 StreamSource 消费。
+ * AVFormatContext 仅在读取线程中访问；读取线程运行时 seek() 以请求的方式
+ * 交给读取线程执行，对所有流只调用一次 av_seek_frame。
+ * 队列足够或到达 EOF 时读取线程阻塞在 reader_event_ 上，由出队、seek 或
+ * stop 唤醒，空闲时不做周期性轮询。
+ * 容器自带索引稀疏时（MPEG-TS 等）使用 KeyframeIndex 按字节直接定位关键帧。
+ * 文件读取方式由 IOMode 决定：Auto 时本地普通文件使用 MmapIO（mmap + madvise），
+ * 网络文件系统（NFS / SMB / FUSE）上的文件使用 ReadAheadIO 后台预读，
+ * 其余情况回退到默认 file 协议。环境变量 RTAV_IO_MODE=default|mmap|readahead
+ * 可强制指定，RTAV_READAHEAD_MB 设置预读窗口（8–64 MB），
+ * RTAV_DISABLE_MMAP_IO=1 等价于 RTAV_IO_MODE=default。
+ * 打开时先以较小的 probesize / analyzeduration 探测流信息，参数不全再放宽；
+ * 完整的探测结果由 StreamInfoCache 缓存到磁盘，再次打开同一文件时跳过探测
+ * （RTAV_DISABLE_PROBE_CACHE=1 关闭）。
  */
 class Demuxer {
  public:
-  Demuxer(Type type);
+  enum class IOMode { Auto, Default, Mmap, ReadAhead };
+
+  // 最近一次 open 的耗时分解，单位微秒(us)
+  struct OpenStats {
+    int64_t open_us = 0;        // avformat_open_input（格式探测 + 读取容器头）
+    int64_t probe_us = 0;       // 流信息探测（命中缓存时为应用缓存的耗时）
+    bool probe_cached = false;  // 流信息来自 StreamInfoCache
+  };
+
+  Demuxer();
   ~Demuxer();  // 调用 close() 释放资源
 
   // 核心功能
+  // 以下两项需在 open 前设置
+  void setIOMode(IOMode mode) { io_mode_ = mode; }
+  void setReadAheadWindow(int64_t bytes) { read_ahead_window_ = bytes; }
+  void setProbeCacheEnabled(bool enabled) { probe_cache_enabled_ = enabled; }
   bool open(const std::string& filename);
   void close();
-  std::unique_ptr<AVPacket> readNextPacket();
-  bool seek(int64_t timestamp, int flags = 0);  // timestamp: 微秒(us)
+  void start();  // 启动读取线程
+  void stop();   // 停止读取线程
+  bool seek(int64_t timestamp,
+            int flags = AVSEEK_FLAG_BACKWARD);  // timestamp: 微秒(us)
 
   // 查询状态
-  bool isEOF() const { return eof_; }
+  bool isEOF() const { return eof_.load(); }
   bool isOpen() const { return format_ctx_ != nullptr; }
+  bool isReading() const { return reading_.load(); }
 
   // 获取属性
   AVFormatContext* getFormatContext() const { return format_ctx_.get(); }
-  int getStreamIndex() const { return stream_index_; }
-  AVStream* getAVStream() const { return stream_; }
+  int getStreamIndex(Type type) const {
+    return type == Type::Video ? video_index_ : audio_index_;
+  }
+  AVStream* getAVStream(Type type) const {
+    return type == Type::Video ? video_stream_ : audio_stream_;
+  }
+  PacketQueue* getPacketQueue(Type type) {
+    return type == Type::Video ? &video_queue_ : &audio_queue_;
+  }
   int64_t getDuration() const;
+  OpenStats getOpenStats() const { return open_stats_; }
+  // 读取线程每次 av_read_frame 的耗时分布，单位微秒(us)；open 时清零
+  utils::LatencyHistogram::Snapshot getReadLatency() const {
+    return read_latency_.snapshot();
+  }
+  uint64_t getBytesRead() const { return bytes_read_.load(); }  // 数据包总字节数
 
  private:
-  Type type_;
-  std::mutex mutex_;  // 保护 readNextPacket()，如果共享上下文则启用
+  void readingLoop();                 // 读取线程主循环
+  PacketPtr readNextPacket();         // 读取下一个数据包（任意流）
+  bool doSeek(int64_t timestamp, int flags);  // 实际执行 seek
+  bool needMorePackets() const;       // 根据队列占用判断是否继续读取
+  bool needsKeyframeIndex() const;    // 容器自带索引是否不足以快速 seek
+  bool seekByIndex(int64_t timestamp);  // 用关键帧索引按字节定位
+  bool probeStreams(const std::string& filename);  // 缓存或有界探测流信息
+  AVIOContext* openCustomIO(const std::string& filename);  // 按 IOMode 选择
+  void closeCustomIO();                 // 记录统计并释放自定义 IO
+  void reportReadAhead(bool force);     // 周期性输出预读缓冲状态
+
   std::unique_ptr<AVFormatContext, AVFormatContextDeleter> format_ctx_;
+  // 自定义 IO，须在 format_ctx_ 关闭之后释放
+  MmapIO mmap_io_;
+  ReadAheadIO read_ahead_io_;
+  IOMode io_mode_ = IOMode::Auto;
+  int64_t read_ahead_window_ = ReadAheadIO::DEFAULT_WINDOW;
+  int64_t read_ahead_report_us_ = 0;  // 上次输出预读状态的时间（读取线程）
+  bool probe_cache_enabled_ = true;
+  OpenStats open_stats_;
+  utils::LatencyHistogram read_latency_;
+  std::atomic<uint64_t> bytes_read_{0};
+
+  AVStream* video_stream_ = nullptr;
+  AVStream* audio_stream_ = nullptr;
+  int video_index_ = -1;
+  int audio_index_ = -1;
+  std::atomic<bool> eof_{false};
+
+  // 每个流一个有界的数据包队列；数据包来自 packet_pool_，须先于队列构造
+  PacketPool packet_pool_;
+  PacketQueue video_queue_;
+  PacketQueue audio_queue_;
 
-  AVStream* stream_ = nullptr;
-  int stream_index_ = -1;
-  bool eof_ = false;
-};
\ No newline at end of file
+  // 读取线程与 seek 请求
+  std::thread reading_thread_;
+  std::atomic<bool> reading_{false};
+  std::mutex control_mutex_;
+  std::condition_variable control_cond_;    // seek 完成通知
+  utils::WaitEvent reader_event_;           // 唤醒空闲的读取线程
+  std::atomic<bool> seek_pending_{false};
+  int64_t seek_target_ = 0;
+  int seek_flags_ = 0;
+  bool seek_result_ = false;
+
+  KeyframeIndex keyframe_index_;  // 仅在需要时建立（见 needsKeyframeIndex）
+};
@@ -0,0 +1,217 @@
+#include "keyframe_index.hpp"
+
+extern "C" {
+#include <libavformat/avformat.h>
+#include <libavutil/time.h>
+}
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include "file_cache.hpp"
+#include "logger.hpp"
+
+using namespace utils;
+
+static const char INDEX_MAGIC[8] = {'R', 'T', 'A', 'V', 'K', 'F', 'I', '1'};
+static const uint32_t INDEX_VERSION = 1;
+
+// 旁路文件直接 mmap 使用，结构体布局必须固定
+static_assert(sizeof(KeyframeIndex::Entry) == 24, "Entry layout changed");
+
+KeyframeIndex::~KeyframeIndex() { close(); }
+
+void KeyframeIndex::open(const std::string& filename, int stream_index) {
+  close();
+
+  FileIdentity identity;
+  if (!getFileIdentity(filename, &identity)) {
+    return;  // 只为本地普通文件建立索引
+  }
+  filename_ = filename;
+  stream_index_ = stream_index;
+  file_size_ = identity.size;
+  mtime_ns_ = identity.mtime_ns;
+
+  sidecar_paths_.clear();
+  sidecar_paths_.push_back(filename + ".kfidx");
+  const std::string cache_path = cachePathFor(filename, ".kfidx");
+  if (!cache_path.empty()) {
+    sidecar_paths_.push_back(cache_path);
+  }
+
+  for (const auto& path : sidecar_paths_) {
+    if (load(path)) {
+      LOG_INFO << "Keyframe index loaded from " << path << ", " << count_
+               << " keyframes";
+      return;
+    }
+  }
+
+  LOG_INFO << "Building keyframe index in background for " << filename;
+  stop_build_.store(false);
+  build_thread_ = std::thread(&KeyframeIndex::build, this);
+}
+
+void KeyframeIndex::close() {
+  stop_build_.store(true);
+  if (build_thread_.joinable()) {
+    build_thread_.join();
+  }
+  ready_.store(false, std::memory_order_release);
+  entries_ = nullptr;
+  count_ = 0;
+  if (map_) {
+    ::munmap(map_, map_size_);
+    map_ = nullptr;
+    map_size_ = 0;
+  }
+  built_.clear();
+  built_.shrink_to_fit();
+}
+
+bool KeyframeIndex::lookup(int64_t timestamp, Entry* out) const {
+  if (!isReady() || count_ == 0) return false;
+  const Entry* end = entries_ + count_;
+  const Entry* it = std::upper_bound(
+      entries_, end, timestamp,
+      [](int64_t ts, const Entry& e) { return ts < e.pts; });
+  if (it == entries_) return false;  // 目标早于第一个关键帧
+  *out = *(it - 1);
+  return true;
+}
+
+bool KeyframeIndex::load(const std::string& path) {
+  static_assert(sizeof(Header) == 48, "Header layout changed");
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) return false;
+
+  struct stat st;
+  if (::fstat(fd, &st) != 0 ||
+      static_cast<size_t>(st.st_size) < sizeof(Header)) {
+    ::close(fd);
+    return false;
+  }
+  const size_t size = static_cast<size_t>(st.st_size);
+  void* map = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);  // 映射建立后即可关闭描述符
+  if (map == MAP_FAILED) return false;
+
+  const auto* header = static_cast<const Header*>(map);
+  const bool valid =
+      std::memcmp(header->magic, INDEX_MAGIC, sizeof(INDEX_MAGIC)) == 0 &&
+      header->version == INDEX_VERSION &&
+      header->entry_size == sizeof(Entry) && header->file_size == file_size_ &&
+      header->mtime_ns == mtime_ns_ && header->stream_index == stream_index_ &&
+      header->count == (size - sizeof(Header)) / sizeof(Entry) &&
+      sizeof(Header) + header->count * sizeof(Entry) == size;
+  if (!valid) {
+    ::munmap(map, size);  // 媒体文件已变化或格式不符，重新构建
+    return false;
+  }
+
+  map_ = map;
+  map_size_ = size;
+  publish(reinterpret_cast<const Entry*>(static_cast<const char*>(map) +
+                                         sizeof(Header)),
+          static_cast<size_t>(header->count));
+  return true;
+}
+
+bool KeyframeIndex::save(const std::vector<Entry>& entries) const {
+  Header header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+  header.version = INDEX_VERSION;
+  header.entry_size = sizeof(Entry);
+  header.file_size = file_size_;
+  header.mtime_ns = mtime_ns_;
+  header.stream_index = stream_index_;
+  header.count = entries.size();
+
+  std::vector<uint8_t> data(sizeof(header) + entries.size() * sizeof(Entry));
+  std::memcpy(data.data(), &header, sizeof(header));
+  if (!entries.empty()) {
+    std::memcpy(data.data() + sizeof(header), entries.data(),
+                entries.size() * sizeof(Entry));
+  }
+  for (const std::string& path : sidecar_paths_) {
+    if (writeFileAtomically(path, data.data(), data.size())) {
+      LOG_INFO << "Keyframe index saved to " << path;
+      return true;
+    }
+  }
+  LOG_WARN << "Could not save keyframe index for " << filename_;
+  return false;
+}
+
+void KeyframeIndex::build() {
+  const int64_t start_us = av_gettime_relative();
+
+  // 独立的格式上下文：不干扰播放中的读取线程
+  AVFormatContext* ctx = nullptr;
+  if (avformat_open_input(&ctx, filename_.c_str(), nullptr, nullptr) < 0) {
+    LOG_WARN << "Keyframe index: could not open " << filename_;
+    return;
+  }
+  if (avformat_find_stream_info(ctx, nullptr) < 0 ||
+      stream_index_ < 0 ||
+      stream_index_ >= static_cast<int>(ctx->nb_streams)) {
+    LOG_WARN << "Keyframe index: stream " << stream_index_ << " not found";
+    avformat_close_input(&ctx);
+    return;
+  }
+  for (unsigned int i = 0; i < ctx->nb_streams; ++i) {
+    if (static_cast<int>(i) != stream_index_) {
+      ctx->streams[i]->discard = AVDISCARD_ALL;
+    }
+  }
+  const AVRational time_base = ctx->streams[stream_index_]->time_base;
+
+  std::vector<Entry> entries;
+  AVPacket* packet = av_packet_alloc();
+  while (packet && !stop_build_.load() && av_read_frame(ctx, packet) >= 0) {
+    if (packet->stream_index == stream_index_ &&
+        (packet->flags & AV_PKT_FLAG_KEY) && packet->pos >= 0) {
+      const int64_t ts =
+          packet->pts != AV_NOPTS_VALUE ? packet->pts : packet->dts;
+      if (ts != AV_NOPTS_VALUE) {
+        entries.push_back({av_rescale_q(ts, time_base, AV_TIME_BASE_Q),
+                           packet->pos, FLAG_KEYFRAME, 0});
+      }
+    }
+    av_packet_unref(packet);
+  }
+  av_packet_free(&packet);
+  avformat_close_input(&ctx);
+
+  if (stop_build_.load()) {
+    return;  // 被 close() 打断，不保存不完整的索引
+  }
+
+  std::stable_sort(entries.begin(), entries.end(),
+                   [](const Entry& a, const Entry& b) { return a.pts < b.pts; });
+  entries.erase(std::unique(entries.begin(), entries.end(),
+                            [](const Entry& a, const Entry& b) {
+                              return a.pts == b.pts;
+                            }),
+                entries.end());
+
+  LOG_INFO << "Keyframe index built: " << entries.size() << " keyframes in "
+           << (av_gettime_relative() - start_us) / 1000 << " ms";
+  save(entries);
+
+  built_ = std::move(entries);
+  publish(built_.data(), built_.size());
+}
+
+void KeyframeIndex::publish(const Entry* entries, size_t count) {
+  entries_ = entries;
+  count_ = count;
+  ready_.store(true, std::memory_order_release);  // 之后只读，查找无需加锁
+}
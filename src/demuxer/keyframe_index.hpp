@@ -0,0 +1,83 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * KeyframeIndex: 视频流关键帧索引（PTS -> 字节偏移），供索引稀疏或缺失的
+ * 容器（MPEG-TS 等）直接按字节定位到目标之前的关键帧。
+ * 首次打开某个文件时在后台线程用独立的 AVFormatContext 扫描一遍数据包建立
+ * 索引，完成后写入旁路文件（sidecar）；之后打开同一文件（大小与修改时间
+ * 不变）时直接 mmap 旁路文件，无需解析即可使用。
+ *
+ * 旁路文件格式（小端，定长）：
+ *   Header { magic "RTAVKFI1", version, entry_size, file_size, mtime_ns,
+ *            stream_index, count }
+ *   Entry[count]，按 pts 升序
+ * 旁路文件优先放在媒体文件旁（<文件名>.kfidx），目录不可写时放到
+ * $XDG_CACHE_HOME（或 ~/.cache）/RealTimeAVPlayer/ 下。
+ */
+class KeyframeIndex {
+ public:
+  struct Entry {
+    int64_t pts;     // 单位微秒(us)，与 Demuxer::seek 的时间戳一致
+    int64_t pos;     // 数据包在文件中的字节偏移
+    uint32_t flags;  // FLAG_KEYFRAME 等
+    uint32_t reserved;
+  };
+  static constexpr uint32_t FLAG_KEYFRAME = 1;
+
+  KeyframeIndex() = default;
+  ~KeyframeIndex();  // 停止后台构建并释放映射
+
+  KeyframeIndex(const KeyframeIndex&) = delete;
+  KeyframeIndex& operator=(const KeyframeIndex&) = delete;
+
+  // 加载旁路文件；不存在或已过期时启动后台构建
+  void open(const std::string& filename, int stream_index);
+  void close();
+
+  bool isReady() const { return ready_.load(std::memory_order_acquire); }
+  size_t size() const { return isReady() ? count_ : 0; }
+
+  // 查找 pts <= timestamp 的最后一个关键帧；索引未就绪或没有时返回 false
+  bool lookup(int64_t timestamp, Entry* out) const;
+
+ private:
+  struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t entry_size;
+    uint64_t file_size;
+    int64_t mtime_ns;
+    int32_t stream_index;
+    uint32_t reserved;
+    uint64_t count;
+  };
+
+  bool load(const std::string& path);
+  bool save(const std::vector<Entry>& entries) const;
+  void build();  // 后台线程：扫描数据包，写旁路文件，发布索引
+  void publish(const Entry* entries, size_t count);
+
+  std::string filename_;
+  std::vector<std::string> sidecar_paths_;  // 按优先级排列的候选路径
+  int stream_index_ = -1;
+  uint64_t file_size_ = 0;
+  int64_t mtime_ns_ = 0;
+
+  std::thread build_thread_;
+  std::atomic<bool> stop_build_{false};
+
+  // 索引数据：来自 mmap 的旁路文件或后台构建结果，发布后只读
+  std::atomic<bool> ready_{false};
+  const Entry* entries_ = nullptr;
+  size_t count_ = 0;
+  void* map_ = nullptr;
+  size_t map_size_ = 0;
+  std::vector<Entry> built_;
+};
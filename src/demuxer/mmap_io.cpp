@@ -0,0 +1,156 @@
+#include "mmap_io.hpp"
+
+extern "C" {
+#include <libavutil/error.h>
+#include <libavutil/mem.h>
+}
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "logger.hpp"
+
+using namespace utils;
+
+MmapIO::~MmapIO() { close(); }
+
+bool MmapIO::open(const std::string& filename) {
+  close();
+
+  int fd = ::open(filename.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat st;
+  if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0) {
+    ::close(fd);
+    return false;  // 管道、设备、空文件等走默认的 file 协议
+  }
+  void* map = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ,
+                     MAP_PRIVATE, fd, 0);
+  ::close(fd);  // 映射建立后即可关闭描述符
+  if (map == MAP_FAILED) {
+    LOG_WARN << "mmap failed for " << filename << ", using default file IO";
+    return false;
+  }
+  data_ = static_cast<const uint8_t*>(map);
+  size_ = static_cast<int64_t>(st.st_size);
+
+  auto* buffer = static_cast<unsigned char*>(av_malloc(IO_BUFFER_SIZE));
+  if (buffer) {
+    avio_ctx_ = avio_alloc_context(buffer, IO_BUFFER_SIZE, 0, this,
+                                   &MmapIO::readPacket, nullptr, &MmapIO::seek);
+  }
+  if (!avio_ctx_) {
+    av_free(buffer);
+    close();
+    return false;
+  }
+
+  // 打开时从文件头开始顺序读取（探测格式、读取头信息）
+  pos_ = 0;
+  stats_ = Stats();
+  advise(0, size_, MADV_SEQUENTIAL);
+  adviseSequential();
+  LOG_INFO << "Using mmap IO for " << filename << " (" << size_ << " bytes)";
+  return true;
+}
+
+void MmapIO::close() {
+  if (avio_ctx_) {
+    av_freep(&avio_ctx_->buffer);  // AVIO 可能替换过缓冲，按当前指针释放
+    avio_context_free(&avio_ctx_);
+  }
+  if (data_) {
+    ::munmap(const_cast<uint8_t*>(data_), static_cast<size_t>(size_));
+    data_ = nullptr;
+  }
+  size_ = 0;
+  pos_ = 0;
+  sequential_bytes_ = 0;
+  next_hint_pos_ = 0;
+}
+
+int MmapIO::readPacket(void* opaque, uint8_t* buf, int buf_size) {
+  auto* self = static_cast<MmapIO*>(opaque);
+  if (self->pos_ >= self->size_) {
+    return AVERROR_EOF;
+  }
+  const int n = static_cast<int>(
+      std::min<int64_t>(buf_size, self->size_ - self->pos_));
+  std::memcpy(buf, self->data_ + self->pos_, n);
+  self->pos_ += n;
+  self->stats_.reads++;
+  self->stats_.bytes += n;
+
+  self->sequential_bytes_ += n;
+  if (self->sequential_bytes_ >= SEQUENTIAL_THRESHOLD &&
+      self->pos_ >= self->next_hint_pos_) {
+    self->adviseSequential();
+  }
+  return n;
+}
+
+int64_t MmapIO::seek(void* opaque, int64_t offset, int whence) {
+  auto* self = static_cast<MmapIO*>(opaque);
+  whence &= ~AVSEEK_FORCE;
+  if (whence == AVSEEK_SIZE) {
+    return self->size_;
+  }
+
+  int64_t target;
+  switch (whence) {
+    case SEEK_SET:
+      target = offset;
+      break;
+    case SEEK_CUR:
+      target = self->pos_ + offset;
+      break;
+    case SEEK_END:
+      target = self->size_ + offset;
+      break;
+    default:
+      return AVERROR(EINVAL);
+  }
+  if (target < 0 || target > self->size_) {
+    return AVERROR(EINVAL);
+  }
+
+  // 小跨度前跳 / 回退（AVIO 缓冲内的调整、解析器回读）不视为 seek
+  if (std::abs(target - self->pos_) > RANDOM_WINDOW) {
+    self->stats_.seeks++;
+    self->sequential_bytes_ = 0;
+    self->next_hint_pos_ = target;
+    self->adviseRandom(target);
+  }
+  self->pos_ = target;
+  return target;
+}
+
+void MmapIO::adviseSequential() {
+  advise(pos_, READAHEAD_WINDOW, MADV_SEQUENTIAL);
+  advise(pos_, READAHEAD_WINDOW, MADV_WILLNEED);
+  next_hint_pos_ = pos_ + HINT_INTERVAL;
+}
+
+void MmapIO::adviseRandom(int64_t offset) {
+  advise(offset - RANDOM_WINDOW / 2, RANDOM_WINDOW, MADV_RANDOM);
+}
+
+void MmapIO::advise(int64_t offset, int64_t length, int advice) {
+  // madvise 要求起始地址按页对齐
+  static const int64_t page = ::sysconf(_SC_PAGESIZE);
+  int64_t begin = std::max<int64_t>(0, offset) & ~(page - 1);
+  int64_t end = std::min(size_, offset + length);
+  if (end <= begin) return;
+  ::madvise(const_cast<uint8_t*>(data_) + begin,
+            static_cast<size_t>(end - begin), advice);
+  stats_.hints++;
+}
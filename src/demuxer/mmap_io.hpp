@@ -0,0 +1,67 @@
+#pragma once
+
+extern "C" {
+#include <libavformat/avio.h>
+}
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * MmapIO: 基于 mmap 的只读 AVIOContext，替代 libavformat 默认的 file 协议。
+ * 整个文件映射到内存，read_packet 直接从映射区拷贝到 AVIO 缓冲，
+ * 不再每个缓冲区一次 read() 系统调用。
+ * 访问模式提示：
+ *   - 顺序读取时对播放位置之后的窗口 madvise(MADV_SEQUENTIAL + MADV_WILLNEED)，
+ *     让内核提前预读；
+ *   - 大跨度 seek 后对目标附近 madvise(MADV_RANDOM)，避免 seek / 探测时的
+ *     二分查找触发无用的大块预读；恢复顺序读取后重新给出预读提示。
+ * AVIOContext 与 AVIO 缓冲由本对象持有，需在 avformat_close_input 之后 close()。
+ */
+class MmapIO {
+ public:
+  struct Stats {
+    uint64_t reads = 0;  // read_packet 调用次数
+    uint64_t bytes = 0;  // 读取的总字节数
+    uint64_t seeks = 0;  // 位置跳变次数
+    uint64_t hints = 0;  // madvise 调用次数
+  };
+
+  MmapIO() = default;
+  ~MmapIO();
+
+  MmapIO(const MmapIO&) = delete;
+  MmapIO& operator=(const MmapIO&) = delete;
+
+  // 映射文件并创建 AVIOContext；非普通文件或映射失败时返回 false
+  bool open(const std::string& filename);
+  void close();
+
+  AVIOContext* context() const { return avio_ctx_; }
+  bool isOpen() const { return avio_ctx_ != nullptr; }
+  Stats getStats() const { return stats_; }
+
+ private:
+  static int readPacket(void* opaque, uint8_t* buf, int buf_size);
+  static int64_t seek(void* opaque, int64_t offset, int whence);
+
+  void adviseSequential();            // 在当前位置之后给出预读提示
+  void adviseRandom(int64_t offset);  // seek 目标附近关闭预读
+  void advise(int64_t offset, int64_t length, int advice);
+
+  static constexpr int IO_BUFFER_SIZE = 256 * 1024;
+  static constexpr int64_t READAHEAD_WINDOW = 32 * 1024 * 1024;  // 预读窗口
+  static constexpr int64_t HINT_INTERVAL = 8 * 1024 * 1024;  // 提示间隔
+  static constexpr int64_t RANDOM_WINDOW = 2 * 1024 * 1024;  // seek 附近
+  // 顺序读取超过该量后才认为回到顺序模式（seek 探测通常只读很少的数据）
+  static constexpr int64_t SEQUENTIAL_THRESHOLD = 1024 * 1024;
+
+  const uint8_t* data_ = nullptr;
+  int64_t size_ = 0;
+  int64_t pos_ = 0;
+  int64_t sequential_bytes_ = 0;  // 上次跳变后连续顺序读取的字节数
+  int64_t next_hint_pos_ = 0;     // 下次给出预读提示的位置
+  AVIOContext* avio_ctx_ = nullptr;
+  Stats stats_;
+};
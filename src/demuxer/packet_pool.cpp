@@ -0,0 +1,109 @@
+#include "packet_pool.hpp"
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+// 池的共享状态：由 PacketPool 与在外的包共同决定生命周期
+struct PacketPoolShared {
+  std::mutex mutex;
+  std::vector<AVPacket*> free_list;
+  bool closed = false;        // PacketPool 已析构
+  uint64_t outstanding = 0;   // 在池外的包数
+  std::atomic<uint64_t> allocated{0};
+  std::atomic<uint64_t> acquired{0};
+};
+
+// 所有池中尚未销毁的 AVPacket 数
+static std::atomic<uint64_t> live_packets{0};
+
+static void destroyPacket(AVPacket* packet) {
+  av_packet_free(&packet);
+  live_packets.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void PacketRecycler::operator()(AVPacket* packet) const {
+  if (!packet) return;
+  if (!owner) {
+    av_packet_free(&packet);  // 不属于任何池
+    return;
+  }
+  av_packet_unref(packet);  // 数据引用立即释放
+
+  bool destroy_shared = false;
+  {
+    std::lock_guard<std::mutex> lock(owner->mutex);
+    if (owner->closed) {
+      destroyPacket(packet);
+    } else {
+      owner->free_list.push_back(packet);  // 已预留容量，稳态不分配
+    }
+    --owner->outstanding;
+    destroy_shared = owner->closed && owner->outstanding == 0;
+  }
+  if (destroy_shared) {
+    delete owner;
+  }
+}
+
+PacketPool::PacketPool(size_t reserve) : shared_(new PacketPoolShared) {
+  shared_->free_list.reserve(reserve);
+}
+
+PacketPool::~PacketPool() {
+  bool destroy_shared = false;
+  {
+    std::lock_guard<std::mutex> lock(shared_->mutex);
+    for (AVPacket* packet : shared_->free_list) {
+      destroyPacket(packet);
+    }
+    shared_->free_list.clear();
+    shared_->closed = true;
+    destroy_shared = shared_->outstanding == 0;
+  }
+  if (destroy_shared) {
+    delete shared_;
+  }
+}
+
+PacketPtr PacketPool::acquire() {
+  AVPacket* packet = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(shared_->mutex);
+    if (!shared_->free_list.empty()) {
+      packet = shared_->free_list.back();
+      shared_->free_list.pop_back();
+    }
+    ++shared_->outstanding;
+  }
+
+  if (!packet) {
+    packet = av_packet_alloc();
+    if (!packet) {
+      std::lock_guard<std::mutex> lock(shared_->mutex);
+      --shared_->outstanding;
+      return PacketPtr();
+    }
+    live_packets.fetch_add(1, std::memory_order_relaxed);
+    shared_->allocated.fetch_add(1, std::memory_order_relaxed);
+    // 容量随在外包数增长，保证归还时 push_back 不再分配
+    std::lock_guard<std::mutex> lock(shared_->mutex);
+    shared_->free_list.reserve(shared_->allocated.load());
+  }
+
+  shared_->acquired.fetch_add(1, std::memory_order_relaxed);
+  return PacketPtr(packet, PacketRecycler{shared_});
+}
+
+uint64_t PacketPool::livePackets() {
+  return live_packets.load(std::memory_order_relaxed);
+}
+
+PacketPool::Stats PacketPool::getStats() const {
+  Stats stats;
+  stats.allocated = shared_->allocated.load(std::memory_order_relaxed);
+  stats.acquired = shared_->acquired.load(std::memory_order_relaxed);
+  std::lock_guard<std::mutex> lock(shared_->mutex);
+  stats.outstanding = shared_->outstanding;
+  return stats;
+}
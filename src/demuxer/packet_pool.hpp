@@ -0,0 +1,52 @@
+#pragma once
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+}
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+struct PacketPoolShared;
+
+// PacketPtr 的删除器：属于某个池的包 unref 后归还空闲链表，
+// 否则（owner 为空）直接释放包本身及其引用的数据缓冲
+struct PacketRecycler {
+  PacketPoolShared* owner = nullptr;
+  void operator()(AVPacket* packet) const;
+};
+
+using PacketPtr = std::unique_ptr<AVPacket, PacketRecycler>;
+
+/**
+ * PacketPool: AVPacket 对象池，每个 Demuxer 一个。
+ * acquire() 优先复用空闲的 AVPacket，稳态读取时不再调用 av_packet_alloc；
+ * 句柄（PacketPtr）析构时 av_packet_unref() 释放数据引用并把包放回空闲链表，
+ * 可在任意线程释放（读取线程丢弃的其他流、解码线程、seek 清空队列等）。
+ * 数据缓冲由 libavformat 按包分配，不在池的管理范围内。
+ * 池可以先于在外的包销毁：最后一个包归还时释放共享状态。
+ * livePackets() 统计整个进程中尚未销毁的池化包，退出时不为 0 说明有泄漏。
+ */
+class PacketPool {
+ public:
+  struct Stats {
+    uint64_t allocated = 0;    // 新建的 AVPacket 数（堆分配）
+    uint64_t acquired = 0;     // acquire() 次数
+    uint64_t outstanding = 0;  // 当前在池外的包数
+  };
+
+  explicit PacketPool(size_t reserve = 128);
+  ~PacketPool();
+
+  PacketPool(const PacketPool&) = delete;
+  PacketPool& operator=(const PacketPool&) = delete;
+
+  PacketPtr acquire();  // 分配失败时返回空句柄
+  Stats getStats() const;
+
+  static uint64_t livePackets();
+
+ private:
+  PacketPoolShared* shared_;
+};
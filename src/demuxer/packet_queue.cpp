@@ -0,0 +1,68 @@
+#include "packet_queue.hpp"
+
+#include "trace.hpp"
+
+void PacketQueue::push(PacketPtr packet) {
+  if (!packet) return;
+  TRACE_SCOPE("PacketQueue::push");
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    bytes_ += packet->size;
+    packets_.push_back(std::move(packet));
+  }
+  cond_.notify_one();
+}
+
+PacketPtr PacketQueue::tryPop() {
+  TRACE_SCOPE("PacketQueue::tryPop");
+  PacketPtr packet;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (packets_.empty()) {
+      return nullptr;
+    }
+    packet = std::move(packets_.front());
+    packets_.pop_front();
+    bytes_ -= packet->size;
+  }
+  if (pop_event_) {
+    pop_event_->notifyAll();  // 队列有了空位，读取线程可能在等待
+  }
+  return packet;
+}
+
+void PacketQueue::notifyAll() {
+  // 加锁保证等待方要么已在 wait 中，要么随后检查条件时能看到新状态
+  { std::lock_guard<std::mutex> lock(mutex_); }
+  cond_.notify_all();
+}
+
+void PacketQueue::flush() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  packets_.clear();  // PacketPtr 自动释放
+  bytes_ = 0;
+  eof_ = false;
+}
+
+void PacketQueue::setEOF() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    eof_ = true;
+  }
+  cond_.notify_all();
+}
+
+bool PacketQueue::isFinished() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return eof_ && packets_.empty();
+}
+
+size_t PacketQueue::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return packets_.size();
+}
+
+int64_t PacketQueue::bytes() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return bytes_;
+}
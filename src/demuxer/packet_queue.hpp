@@ -0,0 +1,56 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+
+#include "packet_pool.hpp"
+#include "wait_event.hpp"
+
+/**
+ * PacketQueue: 单个流的压缩数据包队列。
+ * 由 Demuxer 读取线程写入，对应 StreamSource 的解码线程读取。
+ * 队列统计包数与字节数，Demuxer 据此决定是否继续读取（限流）。
+ * 读取线程到达文件尾后调用 setEOF()，队列取空后 isFinished() 返回 true。
+ * 消费者用 waitForPacket() 阻塞等待，外部状态变化（暂停 / 停止）后调用
+ * notifyAll() 让其重新检查；每次出队会通知 Demuxer 读取线程队列有了空位。
+ */
+class PacketQueue {
+ public:
+  PacketQueue() = default;
+  ~PacketQueue() { flush(); }
+
+  PacketQueue(const PacketQueue&) = delete;
+  PacketQueue& operator=(const PacketQueue&) = delete;
+
+  void push(PacketPtr packet);  // 入队（读取线程）
+  PacketPtr tryPop();           // 出队，队列为空时返回 nullptr（不阻塞）
+
+  // 阻塞直到有数据包、已到达 EOF 或 stop() 为真，返回是否有数据包可取
+  template <typename Pred>
+  bool waitForPacket(Pred stop) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cond_.wait(lock, [&]() { return !packets_.empty() || eof_ || stop(); });
+    return !packets_.empty();
+  }
+  // 外部条件变化后唤醒 waitForPacket() 的等待者
+  void notifyAll();
+  // 出队时通知的事件（Demuxer 读取线程在队列满时等待它）
+  void setPopEvent(utils::WaitEvent* event) { pop_event_ = event; }
+  void flush();  // 清空所有数据包并清除 EOF 标志（seek 时调用）
+
+  void setEOF();
+  bool isFinished() const;  // 已到达 EOF 且队列为空
+
+  size_t size() const;
+  int64_t bytes() const;
+
+ private:
+  mutable std::mutex mutex_;
+  std::condition_variable cond_;
+  std::deque<PacketPtr> packets_;
+  int64_t bytes_ = 0;  // 队列中数据包的总字节数
+  bool eof_ = false;
+  utils::WaitEvent* pop_event_ = nullptr;
+};
@@ -0,0 +1,221 @@
+#include "read_ahead_io.hpp"
+
+extern "C" {
+#include <libavutil/error.h>
+#include <libavutil/mem.h>
+#include <libavutil/time.h>
+}
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#include "logger.hpp"
+
+using namespace utils;
+
+ReadAheadIO::~ReadAheadIO() { close(); }
+
+bool ReadAheadIO::open(const std::string& filename, int64_t window) {
+  close();
+
+  int fd = ::open(filename.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat st;
+  if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+    ::close(fd);
+    return false;
+  }
+#ifdef POSIX_FADV_SEQUENTIAL
+  ::posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+  window = std::min(std::max(window, MIN_WINDOW), MAX_WINDOW);
+  back_keep_ = window / 4;
+  capacity_ = window + back_keep_;
+  ring_.assign(static_cast<size_t>(capacity_), 0);
+
+  auto* buffer = static_cast<unsigned char*>(av_malloc(IO_BUFFER_SIZE));
+  if (buffer) {
+    avio_ctx_ =
+        avio_alloc_context(buffer, IO_BUFFER_SIZE, 0, this,
+                           &ReadAheadIO::readPacket, nullptr, &ReadAheadIO::seek);
+  }
+  if (!avio_ctx_) {
+    av_free(buffer);
+    ::close(fd);
+    ring_.clear();
+    return false;
+  }
+
+  fd_ = fd;
+  size_ = static_cast<int64_t>(st.st_size);
+  buf_start_ = 0;
+  buf_len_ = 0;
+  pos_ = 0;
+  read_error_ = 0;
+  stats_ = Stats();
+  stats_.capacity = capacity_;
+  running_ = true;
+  prefetch_thread_ = std::thread(&ReadAheadIO::prefetchLoop, this);
+  LOG_INFO << "Using read-ahead IO for " << filename << " (window "
+           << window / (1024 * 1024) << " MB)";
+  return true;
+}
+
+void ReadAheadIO::close() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    running_ = false;
+  }
+  space_cv_.notify_all();
+  data_cv_.notify_all();
+  if (prefetch_thread_.joinable()) {
+    prefetch_thread_.join();
+  }
+  if (avio_ctx_) {
+    av_freep(&avio_ctx_->buffer);
+    avio_context_free(&avio_ctx_);
+  }
+  if (fd_ >= 0) {
+    ::close(fd_);
+    fd_ = -1;
+  }
+  ring_.clear();
+  ring_.shrink_to_fit();
+  capacity_ = 0;
+}
+
+ReadAheadIO::Stats ReadAheadIO::getStats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Stats stats = stats_;
+  stats.fill = std::max<int64_t>(0, bufferEnd() - pos_);
+  return stats;
+}
+
+void ReadAheadIO::prefetchLoop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (running_) {
+    // 读取位置之前只保留 back_keep_ 字节，其余空间用于预读
+    if (pos_ >= buf_start_ && pos_ <= bufferEnd() &&
+        pos_ - buf_start_ > back_keep_) {
+      const int64_t drop = pos_ - back_keep_ - buf_start_;
+      buf_start_ += drop;
+      buf_len_ -= drop;
+    }
+
+    const int64_t end = bufferEnd();
+    const int64_t space = capacity_ - buf_len_;
+    if (end >= size_ || space <= 0 || read_error_ != 0) {
+      space_cv_.wait(lock);  // 读满、到达文件尾或出错：等待读取 / seek
+      continue;
+    }
+
+    // pread 写入的区域不在有效数据范围内，读取方不会访问，可不持锁
+    const int64_t ring_off = end % capacity_;
+    const int64_t n =
+        std::min({READ_CHUNK, space, capacity_ - ring_off, size_ - end});
+    const uint64_t generation = generation_;
+    lock.unlock();
+    const ssize_t got = ::pread(fd_, ring_.data() + ring_off,
+                                static_cast<size_t>(n), static_cast<off_t>(end));
+    const int err = errno;
+    lock.lock();
+
+    if (generation != generation_) {
+      continue;  // 读取期间发生了缓冲区外的 seek，结果作废
+    }
+    if (got < 0) {
+      if (err == EINTR) continue;
+      read_error_ = AVERROR(err);
+      LOG_ERROR << "Read-ahead pread failed at " << end << ": "
+                << std::strerror(err);
+    } else if (got == 0) {
+      read_error_ = AVERROR_EOF;  // 文件被截短
+    } else {
+      buf_len_ += got;
+    }
+    data_cv_.notify_all();
+  }
+}
+
+int ReadAheadIO::readPacket(void* opaque, uint8_t* buf, int buf_size) {
+  auto* self = static_cast<ReadAheadIO*>(opaque);
+  std::unique_lock<std::mutex> lock(self->mutex_);
+  if (self->pos_ >= self->size_) {
+    return AVERROR_EOF;
+  }
+
+  if (self->pos_ >= self->bufferEnd() && self->read_error_ == 0) {
+    // 缓冲区已被读空：存储跟不上，记录等待时间
+    const int64_t begin_us = av_gettime_relative();
+    self->stats_.stalls++;
+    self->space_cv_.notify_one();
+    self->data_cv_.wait(lock, [self]() {
+      return !self->running_ || self->pos_ < self->bufferEnd() ||
+             self->read_error_ != 0;
+    });
+    self->stats_.stall_us += av_gettime_relative() - begin_us;
+  }
+  if (self->pos_ >= self->bufferEnd()) {
+    return self->read_error_ != 0 ? self->read_error_ : AVERROR_EOF;
+  }
+
+  const int64_t n = std::min<int64_t>(buf_size, self->bufferEnd() - self->pos_);
+  const int64_t ring_off = self->pos_ % self->capacity_;
+  const int64_t first = std::min(n, self->capacity_ - ring_off);
+  std::memcpy(buf, self->ring_.data() + ring_off, static_cast<size_t>(first));
+  if (first < n) {
+    std::memcpy(buf + first, self->ring_.data(), static_cast<size_t>(n - first));
+  }
+  self->pos_ += n;
+  self->space_cv_.notify_one();  // 读取后可回收旧数据，继续预读
+  return static_cast<int>(n);
+}
+
+int64_t ReadAheadIO::seek(void* opaque, int64_t offset, int whence) {
+  auto* self = static_cast<ReadAheadIO*>(opaque);
+  whence &= ~AVSEEK_FORCE;
+  if (whence == AVSEEK_SIZE) {
+    return self->size_;
+  }
+
+  std::lock_guard<std::mutex> lock(self->mutex_);
+  int64_t target;
+  switch (whence) {
+    case SEEK_SET:
+      target = offset;
+      break;
+    case SEEK_CUR:
+      target = self->pos_ + offset;
+      break;
+    case SEEK_END:
+      target = self->size_ + offset;
+      break;
+    default:
+      return AVERROR(EINVAL);
+  }
+  if (target < 0 || target > self->size_) {
+    return AVERROR(EINVAL);
+  }
+
+  if (target >= self->buf_start_ && target <= self->bufferEnd()) {
+    self->stats_.seeks_in_window++;  // 目标已在缓冲区内，直接由内存满足
+  } else {
+    self->stats_.seeks_refill++;
+    self->buf_start_ = target;
+    self->buf_len_ = 0;
+    self->generation_++;
+    self->read_error_ = 0;
+    self->space_cv_.notify_one();
+  }
+  self->pos_ = target;
+  return target;
+}
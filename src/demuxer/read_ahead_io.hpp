@@ -0,0 +1,85 @@
+#pragma once
+
+extern "C" {
+#include <libavformat/avio.h>
+}
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * ReadAheadIO: 带后台预读线程的只读 AVIOContext，用于慢速或抖动明显的存储
+ * （NFS / SMB 挂载、竞争中的机械硬盘）。
+ * 预读线程用 pread 把读取位置之后的数据填入定长的内存环形缓冲区，
+ * 保持最多 window 字节的预读量；Demuxer 读取线程只从内存拷贝，存储短暂
+ * 卡顿时由缓冲区吸收，不再直接阻塞在 av_read_frame 上。
+ * 缓冲区同时保留读取位置之前的一部分数据（窗口的 1/4），落在缓冲区内的
+ * seek（前后小跨度跳转、格式探测回读）直接由内存满足，不丢弃已读数据。
+ */
+class ReadAheadIO {
+ public:
+  struct Stats {
+    int64_t capacity = 0;          // 缓冲区容量（字节）
+    int64_t fill = 0;              // 读取位置之后已预读的字节数
+    uint64_t stalls = 0;           // 读取时缓冲区为空、需等待的次数
+    int64_t stall_us = 0;          // 累计等待时间
+    uint64_t seeks_in_window = 0;  // 由缓冲区满足的 seek
+    uint64_t seeks_refill = 0;     // 需要丢弃缓冲区重新预读的 seek
+  };
+
+  static constexpr int64_t DEFAULT_WINDOW = 32 * 1024 * 1024;
+  static constexpr int64_t MIN_WINDOW = 8 * 1024 * 1024;
+  static constexpr int64_t MAX_WINDOW = 64 * 1024 * 1024;
+
+  ReadAheadIO() = default;
+  ~ReadAheadIO();
+
+  ReadAheadIO(const ReadAheadIO&) = delete;
+  ReadAheadIO& operator=(const ReadAheadIO&) = delete;
+
+  // window 超出 [MIN_WINDOW, MAX_WINDOW] 时截断；非普通文件返回 false
+  bool open(const std::string& filename, int64_t window = DEFAULT_WINDOW);
+  void close();
+
+  AVIOContext* context() const { return avio_ctx_; }
+  bool isOpen() const { return avio_ctx_ != nullptr; }
+  Stats getStats() const;
+
+ private:
+  static int readPacket(void* opaque, uint8_t* buf, int buf_size);
+  static int64_t seek(void* opaque, int64_t offset, int whence);
+  void prefetchLoop();  // 预读线程主循环
+
+  int64_t bufferEnd() const { return buf_start_ + buf_len_; }
+
+  static constexpr int IO_BUFFER_SIZE = 64 * 1024;
+  static constexpr int64_t READ_CHUNK = 1024 * 1024;  // 单次 pread 上限
+
+  int fd_ = -1;
+  int64_t size_ = 0;
+  AVIOContext* avio_ctx_ = nullptr;
+
+  // 环形缓冲区：文件偏移 o 存放在 ring_[o % capacity_]；
+  // [buf_start_, buf_start_ + buf_len_) 为有效数据，pos_ 为读取位置
+  std::vector<uint8_t> ring_;
+  int64_t capacity_ = 0;
+  int64_t back_keep_ = 0;  // 读取位置之前保留的字节数
+  int64_t buf_start_ = 0;
+  int64_t buf_len_ = 0;
+  int64_t pos_ = 0;
+  uint64_t generation_ = 0;  // seek 重置缓冲区时递增，丢弃过期的 pread 结果
+  int read_error_ = 0;       // pread 失败时的 AVERROR
+
+  mutable std::mutex mutex_;
+  std::condition_variable data_cv_;   // 有新数据 / 出错（读取方等待）
+  std::condition_variable space_cv_;  // 有空位 / seek / 停止（预读线程等待）
+  std::thread prefetch_thread_;
+  bool running_ = false;
+
+  Stats stats_;  // 由 mutex_ 保护
+};
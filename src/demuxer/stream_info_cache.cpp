@@ -0,0 +1,314 @@
+#include "stream_info_cache.hpp"
+
+extern "C" {
+#include <libavutil/channel_layout.h>
+#include <libavutil/mem.h>
+}
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "logger.hpp"
+
+using namespace utils;
+
+static const char CACHE_MAGIC[8] = {'R', 'T', 'A', 'V', 'S', 'I', 'F', '1'};
+static const uint32_t CACHE_VERSION = 1;
+
+namespace {
+
+// 缓存文件格式（本机字节序，仅本机使用）：
+//   Header, { StreamRecord, extradata[extradata_size] } * stream_count
+struct Header {
+  char magic[8];
+  uint32_t version;
+  uint32_t stream_count;
+  uint64_t file_size;
+  int64_t mtime_ns;
+  int64_t start_time;
+  int64_t duration;
+  int64_t bit_rate;
+  char format_name[32];
+};
+
+struct StreamRecord {
+  // AVCodecParameters
+  int32_t codec_type;
+  int32_t codec_id;
+  uint32_t codec_tag;
+  int32_t format;
+  int64_t bit_rate;
+  int32_t bits_per_coded_sample;
+  int32_t bits_per_raw_sample;
+  int32_t profile;
+  int32_t level;
+  int32_t width;
+  int32_t height;
+  AVRational sample_aspect_ratio;
+  int32_t field_order;
+  int32_t color_range;
+  int32_t color_primaries;
+  int32_t color_trc;
+  int32_t color_space;
+  int32_t chroma_location;
+  int32_t video_delay;
+  int32_t ch_order;
+  int32_t nb_channels;
+  uint64_t ch_mask;
+  int32_t sample_rate;
+  int32_t block_align;
+  int32_t frame_size;
+  int32_t initial_padding;
+  int32_t trailing_padding;
+  int32_t seek_preroll;
+  // AVStream
+  AVRational time_base;
+  AVRational avg_frame_rate;
+  AVRational r_frame_rate;
+  AVRational stream_sar;
+  int64_t start_time;
+  int64_t duration;
+  int64_t nb_frames;
+  int32_t disposition;
+  int32_t extradata_size;
+};
+
+// 自定义声道映射无法用定长记录表达，这类流不缓存
+bool cacheableLayout(const AVChannelLayout& layout) {
+  return layout.order == AV_CHANNEL_ORDER_UNSPEC ||
+         layout.order == AV_CHANNEL_ORDER_NATIVE;
+}
+
+void fillRecord(const AVStream* st, StreamRecord* r) {
+  const AVCodecParameters* par = st->codecpar;
+  std::memset(r, 0, sizeof(*r));
+  r->codec_type = par->codec_type;
+  r->codec_id = par->codec_id;
+  r->codec_tag = par->codec_tag;
+  r->format = par->format;
+  r->bit_rate = par->bit_rate;
+  r->bits_per_coded_sample = par->bits_per_coded_sample;
+  r->bits_per_raw_sample = par->bits_per_raw_sample;
+  r->profile = par->profile;
+  r->level = par->level;
+  r->width = par->width;
+  r->height = par->height;
+  r->sample_aspect_ratio = par->sample_aspect_ratio;
+  r->field_order = par->field_order;
+  r->color_range = par->color_range;
+  r->color_primaries = par->color_primaries;
+  r->color_trc = par->color_trc;
+  r->color_space = par->color_space;
+  r->chroma_location = par->chroma_location;
+  r->video_delay = par->video_delay;
+  r->ch_order = par->ch_layout.order;
+  r->nb_channels = par->ch_layout.nb_channels;
+  r->ch_mask = par->ch_layout.order == AV_CHANNEL_ORDER_NATIVE
+                   ? par->ch_layout.u.mask
+                   : 0;
+  r->sample_rate = par->sample_rate;
+  r->block_align = par->block_align;
+  r->frame_size = par->frame_size;
+  r->initial_padding = par->initial_padding;
+  r->trailing_padding = par->trailing_padding;
+  r->seek_preroll = par->seek_preroll;
+  r->time_base = st->time_base;
+  r->avg_frame_rate = st->avg_frame_rate;
+  r->r_frame_rate = st->r_frame_rate;
+  r->stream_sar = st->sample_aspect_ratio;
+  r->start_time = st->start_time;
+  r->duration = st->duration;
+  r->nb_frames = st->nb_frames;
+  r->disposition = st->disposition;
+  r->extradata_size = par->extradata_size;
+}
+
+bool applyRecord(const StreamRecord& r, const uint8_t* extradata,
+                 AVStream* st) {
+  AVCodecParameters* par = st->codecpar;
+  if (r.extradata_size > 0 &&
+      (par->extradata_size != r.extradata_size ||
+       std::memcmp(par->extradata, extradata, r.extradata_size) != 0)) {
+    auto* data = static_cast<uint8_t*>(
+        av_mallocz(r.extradata_size + AV_INPUT_BUFFER_PADDING_SIZE));
+    if (!data) return false;
+    std::memcpy(data, extradata, r.extradata_size);
+    av_freep(&par->extradata);
+    par->extradata = data;
+    par->extradata_size = r.extradata_size;
+  }
+
+  par->codec_id = static_cast<AVCodecID>(r.codec_id);
+  par->codec_tag = r.codec_tag;
+  par->format = r.format;
+  par->bit_rate = r.bit_rate;
+  par->bits_per_coded_sample = r.bits_per_coded_sample;
+  par->bits_per_raw_sample = r.bits_per_raw_sample;
+  par->profile = r.profile;
+  par->level = r.level;
+  par->width = r.width;
+  par->height = r.height;
+  par->sample_aspect_ratio = r.sample_aspect_ratio;
+  par->field_order = static_cast<decltype(par->field_order)>(r.field_order);
+  par->color_range = static_cast<AVColorRange>(r.color_range);
+  par->color_primaries = static_cast<AVColorPrimaries>(r.color_primaries);
+  par->color_trc = static_cast<AVColorTransferCharacteristic>(r.color_trc);
+  par->color_space = static_cast<AVColorSpace>(r.color_space);
+  par->chroma_location = static_cast<AVChromaLocation>(r.chroma_location);
+  par->video_delay = r.video_delay;
+  av_channel_layout_uninit(&par->ch_layout);
+  if (r.ch_order == AV_CHANNEL_ORDER_NATIVE) {
+    av_channel_layout_from_mask(&par->ch_layout, r.ch_mask);
+  } else {
+    par->ch_layout.order = AV_CHANNEL_ORDER_UNSPEC;
+    par->ch_layout.nb_channels = r.nb_channels;
+  }
+  par->sample_rate = r.sample_rate;
+  par->block_align = r.block_align;
+  par->frame_size = r.frame_size;
+  par->initial_padding = r.initial_padding;
+  par->trailing_padding = r.trailing_padding;
+  par->seek_preroll = r.seek_preroll;
+
+  st->time_base = r.time_base;
+  st->avg_frame_rate = r.avg_frame_rate;
+  st->r_frame_rate = r.r_frame_rate;
+  st->sample_aspect_ratio = r.stream_sar;
+  st->start_time = r.start_time;
+  st->duration = r.duration;
+  st->nb_frames = r.nb_frames;
+  st->disposition = r.disposition;
+  return true;
+}
+
+}  // namespace
+
+StreamInfoCache::StreamInfoCache(const std::string& filename) {
+  if (getFileIdentity(filename, &identity_)) {
+    path_ = cachePathFor(filename, ".sinfo");
+  }
+}
+
+bool StreamInfoCache::apply(AVFormatContext* ctx) const {
+  if (path_.empty() || !ctx->iformat) return false;
+
+  FILE* fp = std::fopen(path_.c_str(), "rb");
+  if (!fp) return false;
+  std::vector<uint8_t> data;
+  uint8_t chunk[16 * 1024];
+  size_t n;
+  while ((n = std::fread(chunk, 1, sizeof(chunk), fp)) > 0) {
+    data.insert(data.end(), chunk, chunk + n);
+  }
+  std::fclose(fp);
+
+  Header header;
+  if (data.size() < sizeof(header)) return false;
+  std::memcpy(&header, data.data(), sizeof(header));
+  header.format_name[sizeof(header.format_name) - 1] = '\0';
+  if (std::memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 ||
+      header.version != CACHE_VERSION ||
+      header.file_size != identity_.size ||
+      header.mtime_ns != identity_.mtime_ns ||
+      header.stream_count != ctx->nb_streams ||
+      std::strcmp(header.format_name, ctx->iformat->name) != 0) {
+    return false;
+  }
+
+  // 先完整校验所有记录，再修改 ctx，避免半途失败留下不一致的流信息
+  std::vector<StreamRecord> records(header.stream_count);
+  std::vector<size_t> extradata_offsets(header.stream_count);
+  size_t offset = sizeof(header);
+  for (uint32_t i = 0; i < header.stream_count; ++i) {
+    StreamRecord& r = records[i];
+    if (data.size() - offset < sizeof(r)) return false;
+    std::memcpy(&r, data.data() + offset, sizeof(r));
+    offset += sizeof(r);
+    if (r.extradata_size < 0 ||
+        data.size() - offset < static_cast<size_t>(r.extradata_size)) {
+      return false;
+    }
+    extradata_offsets[i] = offset;
+    offset += r.extradata_size;
+
+    const AVCodecParameters* par = ctx->streams[i]->codecpar;
+    if (r.codec_type != par->codec_type ||
+        (par->codec_id != AV_CODEC_ID_NONE && r.codec_id != par->codec_id)) {
+      LOG_INFO << "Stream info cache does not match stream " << i
+               << ", probing";
+      return false;
+    }
+  }
+  if (offset != data.size()) return false;
+
+  ctx->start_time = header.start_time;
+  ctx->duration = header.duration;
+  ctx->bit_rate = header.bit_rate;
+  for (uint32_t i = 0; i < header.stream_count; ++i) {
+    if (!applyRecord(records[i], data.data() + extradata_offsets[i],
+                     ctx->streams[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool StreamInfoCache::store(const AVFormatContext* ctx) const {
+  if (path_.empty() || !ctx->iformat || !isComplete(ctx)) return false;
+
+  Header header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+  header.version = CACHE_VERSION;
+  header.stream_count = ctx->nb_streams;
+  header.file_size = identity_.size;
+  header.mtime_ns = identity_.mtime_ns;
+  header.start_time = ctx->start_time;
+  header.duration = ctx->duration;
+  header.bit_rate = ctx->bit_rate;
+  std::snprintf(header.format_name, sizeof(header.format_name), "%s",
+                ctx->iformat->name);
+
+  std::vector<uint8_t> data(reinterpret_cast<const uint8_t*>(&header),
+                            reinterpret_cast<const uint8_t*>(&header + 1));
+  for (unsigned int i = 0; i < ctx->nb_streams; ++i) {
+    const AVStream* st = ctx->streams[i];
+    if (!cacheableLayout(st->codecpar->ch_layout)) return false;
+    StreamRecord r;
+    fillRecord(st, &r);
+    const auto* bytes = reinterpret_cast<const uint8_t*>(&r);
+    data.insert(data.end(), bytes, bytes + sizeof(r));
+    if (r.extradata_size > 0) {
+      data.insert(data.end(), st->codecpar->extradata,
+                  st->codecpar->extradata + r.extradata_size);
+    }
+  }
+
+  if (!writeFileAtomically(path_, data.data(), data.size())) {
+    LOG_WARN << "Could not write stream info cache " << path_;
+    return false;
+  }
+  LOG_INFO << "Stream info cached to " << path_;
+  return true;
+}
+
+bool StreamInfoCache::isComplete(const AVFormatContext* ctx) {
+  for (unsigned int i = 0; i < ctx->nb_streams; ++i) {
+    const AVStream* st = ctx->streams[i];
+    const AVCodecParameters* par = st->codecpar;
+    if (par->codec_type == AVMEDIA_TYPE_VIDEO &&
+        !(st->disposition & AV_DISPOSITION_ATTACHED_PIC)) {
+      if (par->codec_id == AV_CODEC_ID_NONE || par->width <= 0 ||
+          par->height <= 0 || par->format < 0) {
+        return false;
+      }
+    } else if (par->codec_type == AVMEDIA_TYPE_AUDIO) {
+      if (par->codec_id == AV_CODEC_ID_NONE || par->sample_rate <= 0 ||
+          par->ch_layout.nb_channels <= 0 || par->format < 0) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
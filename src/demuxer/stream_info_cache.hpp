@@ -0,0 +1,37 @@
+#pragma once
+
+extern "C" {
+#include <libavformat/avformat.h>
+}
+
+#include <string>
+
+#include "file_cache.hpp"
+
+/**
+ * StreamInfoCache: avformat_find_stream_info 结果的磁盘缓存。
+ * find_stream_info 需要读取并解码文件开头的数据才能补全编码参数，
+ * 大文件上是打开耗时的主要部分。首次完整探测后把各流的编码参数
+ * （AVCodecParameters 含 extradata）、时间基、时长、帧率等写入缓存；
+ * 再次打开同一文件（大小与修改时间不变）时，在 avformat_open_input 读完
+ * 容器头后直接填回，跳过 find_stream_info。
+ * 容器头给出的流数量、类型或编码与缓存不一致时视为失效，回退到正常探测。
+ *
+ * 缓存文件：$XDG_CACHE_HOME（或 ~/.cache）/RealTimeAVPlayer/<路径哈希>.sinfo
+ */
+class StreamInfoCache {
+ public:
+  explicit StreamInfoCache(const std::string& filename);
+
+  // 用缓存补全 ctx 的流信息；没有可用缓存时返回 false，ctx 不被修改
+  bool apply(AVFormatContext* ctx) const;
+  // 保存探测结果（仅在 isComplete 时写入）
+  bool store(const AVFormatContext* ctx) const;
+
+  // 音视频流的关键参数（分辨率、像素格式、采样率、声道等）是否都已确定
+  static bool isComplete(const AVFormatContext* ctx);
+
+ private:
+  std::string path_;  // 为空表示不可缓存（非普通文件或无缓存目录）
+  utils::FileIdentity identity_;
+};
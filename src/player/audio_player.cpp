@@ -1,26 +1,69 @@
 #include "audio_player.hpp"
 
 #include <algorithm>
+#include <cstdlib>
 #include <cstring>
+#include <string>
+#include <time.h>
 
+#include "audio_resampler.hpp"
 #include "libavutil/avutil.h"
 #include "logger.hpp"
+#include "trace.hpp"
 
 extern "C" {
 #include <libavutil/channel_layout.h>
 #include <libavutil/frame.h>
-#include <libavutil/opt.h>
 #include <libavutil/samplefmt.h>
 }
 
 using namespace utils;
 
+// 欠载退避：BACKOFF_WINDOW 内欠载达到 BACKOFF_UNDERRUNS 次时加倍设备周期
+static const auto BACKOFF_WINDOW = std::chrono::seconds(2);
+static const uint64_t BACKOFF_UNDERRUNS = 3;
+// 重采样开销日志间隔（帧）
+static const uint64_t CONVERT_LOG_INTERVAL = 1000;
+
+// SDL 音频格式 -> 重采样输出格式；回调以 0 填充静音，不支持无符号格式
+static AVSampleFormat toSampleFormat(SDL_AudioFormat format) {
+  switch (format) {
+    case AUDIO_S16SYS:
+      return AV_SAMPLE_FMT_S16;
+    case AUDIO_S32SYS:
+      return AV_SAMPLE_FMT_S32;
+    case AUDIO_F32SYS:
+      return AV_SAMPLE_FMT_FLT;
+    default:
+      return AV_SAMPLE_FMT_NONE;
+  }
+}
+
+// 当前线程的 CPU 时间（纳秒）；没有线程时钟的平台退化为单调时钟
+static uint64_t threadCpuNs() {
+#ifdef CLOCK_THREAD_CPUTIME_ID
+  timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL +
+         static_cast<uint64_t>(ts.tv_nsec);
+#else
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now().time_since_epoch())
+          .count());
+#endif
+}
+
+// 单调时钟，单位微秒(us)；与 Player / GLRenderer 的时间基准相同
+static int64_t nowUs() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
 AudioPlayer::AudioPlayer()
     : swr_ctx_(nullptr, SwrContextDeleter{}),  // 修复：使用自定义删除器
       audio_dev_(0),
-      pcm_ring_cap_(0),
-      pcm_ring_read_(0),
-      pcm_ring_write_(0),
       pulling_(false),
       paused_(false),
       stop_(false),
@@ -30,9 +73,19 @@ AudioPlayer::AudioPlayer()
       sample_fmt_(AV_SAMPLE_FMT_NONE),
       channel_layout_(AV_CH_LAYOUT_STEREO),
       volume_(SDL_MIX_MAXVOLUME),
-      audio_clock_(0),
       base_pts_(0),
-      consumed_samples_(0) {}
+      consumed_samples_(0) {
+  // 设备缓冲之后的额外输出延迟（蓝牙耳机、声卡 / 音频服务器内部缓冲），
+  // SDL 无法查询，按需手动设置
+  const char* env = std::getenv("RTAV_AUDIO_LATENCY_MS");
+  if (env) {
+    output_latency_us_ = std::max(0, std::atoi(env)) * int64_t{1000};
+  }
+  env = std::getenv("RTAV_AUDIO_PROFILE");
+  if (env && std::string(env) == "low") {
+    profile_ = LatencyProfile::lowLatency();
+  }
+}
 
 AudioPlayer::~AudioPlayer() {
   stop();
@@ -69,61 +122,35 @@ bool AudioPlayer::initialize(std::shared_ptr<StreamSource> audio_reader) {
     }
   }
 
-  // 打开音频设备并校验参数
-  SDL_AudioSpec want, have;
-  SDL_zero(want);
-  want.freq = sample_rate_;
-  want.format = AUDIO_S16SYS;
-  want.channels = static_cast<Uint8>(channels_);
-  want.samples = 1024;
-  want.callback = audioCallback;
-  want.userdata = this;
-
-  audio_dev_ = SDL_OpenAudioDevice(nullptr, 0, &want, &have, 0);
-  if (audio_dev_ == 0) {
-    LOG_ERROR << "Failed to open audio device: " << SDL_GetError();
+  // 按设备原生规格打开设备，重采样直接输出该规格
+  profile_.period_frames = std::max(profile_.period_frames, 64);
+  profile_.max_period_frames =
+      std::max(profile_.max_period_frames, profile_.period_frames);
+  SDL_AudioSpec have;
+  const SDL_AudioDeviceID dev =
+      openDevice(profile_.period_frames, true, have);
+  if (dev == 0) {
     return false;
   }
-  if (have.freq != want.freq || have.format != want.format ||
-      have.channels != want.channels) {
-    LOG_ERROR << "Audio device returned different spec than requested";
-    SDL_CloseAudioDevice(audio_dev_);
-    audio_dev_ = 0;
-    return false;
-  }
-
-  // 初始化重采样上下文
-  SwrContext* new_ctx = swr_alloc();
-  if (!new_ctx) {
-    LOG_ERROR << "Failed to allocate SwrContext";
+  adoptDevice(dev, have);
+  device_failed_ = false;
+  backoff_disabled_ = false;
+  if (!initResampler()) {
     SDL_CloseAudioDevice(audio_dev_);
     audio_dev_ = 0;
     return false;
   }
 
-  av_opt_set_int(new_ctx, "in_channel_layout", channel_layout_, 0);
-  av_opt_set_int(new_ctx, "in_sample_rate", sample_rate_, 0);
-  av_opt_set_sample_fmt(new_ctx, "in_sample_fmt", sample_fmt_, 0);
-  av_opt_set_int(new_ctx, "out_channel_layout", channel_layout_, 0);
-  av_opt_set_int(new_ctx, "out_sample_rate", sample_rate_, 0);
-  av_opt_set_sample_fmt(new_ctx, "out_sample_fmt", AV_SAMPLE_FMT_S16, 0);
-  if (swr_init(new_ctx) < 0) {
-    LOG_ERROR << "Failed to initialize SwrContext";
-    swr_free(&new_ctx);
-    SDL_CloseAudioDevice(audio_dev_);
-    audio_dev_ = 0;
-    return false;
-  }
-  swr_ctx_.reset(new_ctx);  // 使用智能指针
-
-  // 分配环形缓冲区（2秒音频）
-  int bytes_per_sample = av_get_bytes_per_sample(AV_SAMPLE_FMT_S16);
-  int buffer_bytes = sample_rate_ * channels_ * bytes_per_sample * 2;
-  if (buffer_bytes < 4096) buffer_bytes = 4096;
-  pcm_ring_cap_ = buffer_bytes;
-  pcm_ring_buf_.resize(pcm_ring_cap_, 0);
-  pcm_ring_read_ = 0;
-  pcm_ring_write_ = 0;
+  // 环形缓冲区按周期退避到上限时的上水位分配，退避时不必重新分配
+  const int64_t max_ring_frames = std::max<int64_t>(
+      static_cast<int64_t>(profile_.ring_ms) * device_rate_ / 1000 *
+          profile_.max_period_frames / profile_.period_frames,
+      2 * profile_.max_period_frames);
+  pcm_ring_.allocate(static_cast<size_t>(max_ring_frames) * bytes_per_frame_);
+  underrun_count_ = 0;
+  backoff_window_underruns_ = 0;
+  backoff_window_start_ = std::chrono::steady_clock::now();
+  freezeClock(base_pts_.load());
 
   // 启动生产者线程
   pulling_ = true;
@@ -132,12 +159,164 @@ bool AudioPlayer::initialize(std::shared_ptr<StreamSource> audio_reader) {
   // 启动音频播放
   SDL_PauseAudioDevice(audio_dev_, 0);
 
-  LOG_INFO << "AudioPlayer initialized: freq=" << sample_rate_
-           << " channels=" << channels_ << " buffer=" << pcm_ring_cap_
-           << " bytes";
+  LOG_INFO << "AudioPlayer initialized: stream " << sample_rate_ << "Hz "
+           << channels_ << "ch " << av_get_sample_fmt_name(sample_fmt_)
+           << " -> device " << device_rate_ << "Hz " << device_channels_
+           << "ch " << av_get_sample_fmt_name(device_sample_fmt_)
+           << ", period=" << period_frames_.load()
+           << " frames, ring limit=" << ring_limit_bytes_ << " bytes (refill "
+           << refill_bytes_ << "), extra latency=" << output_latency_us_ / 1000
+           << " ms";
   return true;
 }
 
+SDL_AudioDeviceID AudioPlayer::openDevice(int period_frames, bool negotiate,
+                                          SDL_AudioSpec& have) {
+  SDL_AudioSpec want;
+  SDL_zero(want);
+  want.freq = negotiate ? sample_rate_ : device_rate_;
+  want.format = negotiate ? AUDIO_F32SYS : device_format_;
+  want.channels = static_cast<Uint8>(
+      negotiate ? std::min(channels_, 8) : device_channels_);
+  want.samples = static_cast<Uint16>(period_frames);
+  want.callback = audioCallback;
+  want.userdata = this;
+
+  // 协商时接受设备的原生采样率 / 声道数 / 格式，由 SwrContext 一次转换到位；
+  // 退避重开时沿用已协商的规格，重采样器不必重建
+  int allowed = negotiate ? SDL_AUDIO_ALLOW_FREQUENCY_CHANGE |
+                                SDL_AUDIO_ALLOW_CHANNELS_CHANGE |
+                                SDL_AUDIO_ALLOW_FORMAT_CHANGE
+                          : 0;
+  SDL_AudioDeviceID dev =
+      SDL_OpenAudioDevice(nullptr, 0, &want, &have, allowed);
+  if (dev != 0 && toSampleFormat(have.format) == AV_SAMPLE_FMT_NONE) {
+    // 设备原生格式无法直接输出（无符号 / 非本机字节序），改由 SDL 转换
+    LOG_WARN << "Audio device format 0x" << std::hex << have.format
+             << std::dec << " not supported, requesting F32";
+    SDL_CloseAudioDevice(dev);
+    allowed &= ~SDL_AUDIO_ALLOW_FORMAT_CHANGE;
+    dev = SDL_OpenAudioDevice(nullptr, 0, &want, &have, allowed);
+  }
+  if (dev == 0) {
+    LOG_ERROR << "Failed to open audio device: " << SDL_GetError();
+    return 0;
+  }
+  if (have.channels < 1 || have.channels > 8 || have.freq <= 0) {
+    LOG_ERROR << "Audio device returned unusable spec: " << have.freq
+              << "Hz " << static_cast<int>(have.channels) << "ch";
+    SDL_CloseAudioDevice(dev);
+    return 0;
+  }
+  return dev;
+}
+
+void AudioPlayer::adoptDevice(SDL_AudioDeviceID dev,
+                              const SDL_AudioSpec& have) {
+  // 新设备处于暂停状态、旧设备已关闭，回调不在运行，可以直接更新其参数
+  audio_dev_ = dev;
+  device_rate_ = have.freq;
+  device_channels_ = have.channels;
+  device_format_ = have.format;
+  device_sample_fmt_ = toSampleFormat(have.format);
+  bytes_per_frame_ =
+      av_get_bytes_per_sample(device_sample_fmt_) * device_channels_;
+  device_buffer_frames_ = have.samples;
+  period_frames_.store(have.samples);
+  // 回调停止（暂停之外的欠载、设备卡住）时最多外推两个回调周期
+  max_extrapolate_us_.store(2 * static_cast<int64_t>(have.samples) *
+                            AV_TIME_BASE / device_rate_);
+
+  // 水位随实际周期缩放：退避后缓冲同步加深；上水位至少容纳两个周期
+  auto msToBytes = [&](int64_t ms) {
+    const int64_t frames =
+        ms * device_rate_ / 1000 * have.samples / profile_.period_frames;
+    return static_cast<size_t>(frames) * bytes_per_frame_;
+  };
+  const size_t min_limit =
+      2 * static_cast<size_t>(have.samples) * bytes_per_frame_;
+  ring_limit_bytes_ = std::max(msToBytes(profile_.ring_ms), min_limit);
+  refill_bytes_ = std::min(msToBytes(profile_.refill_ms),
+                           ring_limit_bytes_ - bytes_per_frame_);
+}
+
+bool AudioPlayer::initResampler() {
+  AudioResampleSpec spec;
+  spec.in_layout = channel_layout_;
+  spec.in_channels = channels_;
+  spec.in_rate = sample_rate_;
+  spec.in_fmt = sample_fmt_;
+  spec.out_channels = device_channels_;
+  spec.out_rate = device_rate_;
+  spec.out_fmt = device_sample_fmt_;
+  SwrContext* new_ctx = createAudioResampler(spec);
+  if (!new_ctx) {
+    LOG_ERROR << "Failed to initialize SwrContext";
+    return false;
+  }
+  swr_ctx_.reset(new_ctx);  // 使用智能指针
+  convert_hist_.reset();
+  convert_cpu_ns_ = 0;
+  converted_ns_ = 0;
+  converts_since_log_ = 0;
+  return true;
+}
+
+void AudioPlayer::maybeBackOffPeriod() {
+  const auto now = std::chrono::steady_clock::now();
+  const uint64_t underruns = underrun_count_.load();
+  if (now - backoff_window_start_ >= BACKOFF_WINDOW) {
+    backoff_window_start_ = now;
+    backoff_window_underruns_ = underruns;
+    return;
+  }
+  if (underruns - backoff_window_underruns_ < BACKOFF_UNDERRUNS) return;
+  backoff_window_start_ = now;
+  backoff_window_underruns_ = underruns;
+
+  const int current = period_frames_.load();
+  if (backoff_disabled_ || current >= profile_.max_period_frames) return;
+  const int next = std::min(current * 2, profile_.max_period_frames);
+
+  // 重开设备会丢掉设备缓冲中未播放的一个周期，只在已经欠载时才这样做。
+  // 先打开新设备再关闭旧设备：打开失败时旧设备照常播放
+  std::lock_guard<std::mutex> lock(device_mutex_);
+  if (stop_ || paused_ || audio_dev_ == 0) return;
+  SDL_AudioSpec have;
+  const SDL_AudioDeviceID dev = openDevice(next, false, have);
+  if (dev == 0) {
+    backoff_disabled_ = true;
+    LOG_WARN << "Audio underruns, but a device with a " << next
+             << "-frame period could not be opened; keeping " << current
+             << " frames";
+    return;
+  }
+  SDL_CloseAudioDevice(audio_dev_);  // 等待进行中的回调返回
+  adoptDevice(dev, have);
+  SDL_PauseAudioDevice(audio_dev_, 0);
+  LOG_WARN << "Audio underruns, device period " << current << " -> "
+           << period_frames_.load() << " frames, ring limit "
+           << ring_limit_bytes_ << " bytes";
+}
+
+void AudioPlayer::checkDevice() {
+  std::lock_guard<std::mutex> lock(device_mutex_);
+  if (device_failed_.load() || stop_ || audio_dev_ == 0) return;
+  // 断开的设备不再回调，状态变为 STOPPED（暂停时为 PAUSED）
+  if (SDL_GetAudioDeviceStatus(audio_dev_) == SDL_AUDIO_STOPPED) {
+    device_failed_.store(true);
+    LOG_ERROR << "Audio device lost, audio output stopped";
+  }
+}
+
+int64_t AudioPlayer::getBufferedUs() const {
+  const int64_t bytes_per_second =
+      static_cast<int64_t>(device_rate_) * bytes_per_frame_;
+  return bytes_per_second > 0 ? static_cast<int64_t>(pcm_ring_.available()) *
+                                    AV_TIME_BASE / bytes_per_second
+                              : 0;
+}
+
 void AudioPlayer::audioCallback(void* userdata, uint8_t* stream, int len) {
   auto* player = static_cast<AudioPlayer*>(userdata);
   if (!player || !player->audio_dev_) {
@@ -148,74 +327,135 @@ void AudioPlayer::audioCallback(void* userdata, uint8_t* stream, int len) {
 }
 
 void AudioPlayer::fillAudioData(uint8_t* stream, int len) {
-  std::memset(stream, 0, len);  // 先填充静音数据
-  if (paused_ || stop_) return;
-
-  int bytes_per_sample = av_get_bytes_per_sample(AV_SAMPLE_FMT_S16);
-  int bytes_per_frame = bytes_per_sample * channels_;
-  int total_bytes_needed = len;
-  int total_bytes_filled = 0;
-
-  while (total_bytes_filled < total_bytes_needed) {
-    // 如果音频流已结束且缓冲区已空，直接静音
-    if (playback_finished_ && pcm_ring_read_ == pcm_ring_write_) {
-      break;
-    }
+  // 运行在 SDL 实时音频线程：不加锁、不分配内存、不写日志
+  // （启用追踪时仅首次回调分配本线程的追踪缓冲区）
+  TRACE_THREAD_NAME("audio callback");
+  TRACE_SCOPE("fillAudioData");
+  const int64_t callback_us = nowUs();
+  if (paused_ || stop_ || len <= 0) {
+    std::memset(stream, 0, len);
+    return;
+  }
 
-    int bytes_to_fill = total_bytes_needed - total_bytes_filled;
-    // 从环形缓冲先读入临时缓冲，再根据当前音量写入/混音到输出 buffer
-    std::vector<uint8_t> tmp_buf(bytes_to_fill);
-    size_t bytes_available = popPCMData(tmp_buf.data(), bytes_to_fill);
-    LOG_DEBUG << "popPCMData got " << bytes_available << " bytes";
-    if (bytes_available == 0) {
-      break;
-    }
+  // 只取整数个采样帧，避免欠载时把半个帧和静音拼在一起造成声道错位
+  const size_t bytes_needed = static_cast<size_t>(len);
+  size_t bytes_to_read = std::min(bytes_needed, pcm_ring_.available());
+  bytes_to_read -= bytes_to_read % bytes_per_frame_;
+
+  size_t bytes_filled = 0;
+  int vol = volume_.load(std::memory_order_acquire);
+  if (vol >= SDL_MIX_MAXVOLUME) {
+    // 最大音量，直接从环形缓冲区复制到输出区
+    bytes_filled = pcm_ring_.read(stream, bytes_to_read);
+  } else {
+    // 其余音量从环形缓冲区原地混音到静音的输出区；音量为 0 时只消费数据
+    std::memset(stream, 0, bytes_to_read);
+    uint8_t* dst = stream;
+    bytes_filled =
+        pcm_ring_.consume(bytes_to_read, [&](const uint8_t* src, size_t n) {
+          if (vol > 0) {
+            SDL_MixAudioFormat(dst, src, device_format_, static_cast<Uint32>(n),
+                               vol);
+          }
+          dst += n;
+        });
+  }
 
-    int vol = volume_.load(std::memory_order_acquire);
-    if (vol <= 0) {
-      // 音量为 0，保持目标区域为静音（已 memset 为 0），无需写入
-    } else if (vol >= SDL_MIX_MAXVOLUME) {
-      // 最大音量，直接复制到目标输出区
-      std::memcpy(stream + total_bytes_filled, tmp_buf.data(), bytes_available);
-    } else {
-      // 非 0 非满，安全地将 src(tmp_buf) 混音到目标区 (dst 初始为0)
-      SDL_MixAudioFormat(stream + total_bytes_filled, tmp_buf.data(),
-                         AUDIO_S16SYS, static_cast<Uint32>(bytes_available),
-                         vol);
+  if (bytes_filled < bytes_needed) {
+    std::memset(stream + bytes_filled, 0, bytes_needed - bytes_filled);
+    // 启动 / seek 后缓冲尚未写入数据时的静音不算欠载
+    if (primed_.load(std::memory_order_relaxed) &&
+        !playback_finished_.load(std::memory_order_acquire)) {
+      underrun_count_.fetch_add(1, std::memory_order_relaxed);
+      TRACE_INSTANT("audio underrun");
     }
-
-    total_bytes_filled += static_cast<int>(bytes_available);
-    consumed_samples_ += bytes_available / bytes_per_frame;
-    int64_t base = base_pts_.load(std::memory_order_acquire);  // 获取基准时间戳
-    audio_clock_.store(base + (consumed_samples_ * AV_TIME_BASE) / sample_rate_,
-                       std::memory_order_release);
   }
+
+  // 回调时刻设备里还排着一个缓冲区未播放：此刻听到的是本次取数之前
+  // device_buffer_frames_ 个采样帧处的数据，再扣除设备之后的额外延迟
+  const int64_t frames_filled =
+      static_cast<int64_t>(bytes_filled / bytes_per_frame_);
+  const int64_t consumed_before =
+      consumed_samples_.fetch_add(frames_filled, std::memory_order_relaxed);
+  const int64_t playing = consumed_before - device_buffer_frames_;
+  const int64_t base = base_pts_.load(std::memory_order_acquire);
+  ClockAnchor anchor;
+  anchor.pts_us =
+      std::max(base, base + playing * AV_TIME_BASE / device_rate_ -
+                         output_latency_us_);
+  anchor.time_us = callback_us;
+  anchor.running = consumed_before + frames_filled > 0;
+  storeClockAnchor(anchor);
+}
+
+int64_t AudioPlayer::getAudioClock() const {
+  const ClockAnchor anchor = loadClockAnchor();
+  if (!anchor.running) return anchor.pts_us;
+  const int64_t elapsed = nowUs() - anchor.time_us;
+  return anchor.pts_us + std::clamp<int64_t>(elapsed, 0, max_extrapolate_us_);
+}
+
+void AudioPlayer::storeClockAnchor(const ClockAnchor& anchor) noexcept {
+  const uint32_t seq = anchor_seq_.load(std::memory_order_relaxed);
+  anchor_seq_.store(seq + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  anchor_pts_us_.store(anchor.pts_us, std::memory_order_relaxed);
+  anchor_time_us_.store(anchor.time_us, std::memory_order_relaxed);
+  anchor_running_.store(anchor.running, std::memory_order_relaxed);
+  anchor_seq_.store(seq + 2, std::memory_order_release);
+}
+
+AudioPlayer::ClockAnchor AudioPlayer::loadClockAnchor() const noexcept {
+  ClockAnchor anchor;
+  uint32_t seq;
+  do {
+    seq = anchor_seq_.load(std::memory_order_acquire);
+    anchor.pts_us = anchor_pts_us_.load(std::memory_order_relaxed);
+    anchor.time_us = anchor_time_us_.load(std::memory_order_relaxed);
+    anchor.running = anchor_running_.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+  } while ((seq & 1) != 0 ||
+           seq != anchor_seq_.load(std::memory_order_relaxed));
+  return anchor;
+}
+
+void AudioPlayer::freezeClock(int64_t pts) noexcept {
+  ClockAnchor anchor;
+  anchor.pts_us = pts;
+  anchor.time_us = nowUs();
+  anchor.running = false;
+  storeClockAnchor(anchor);
 }
 
 void AudioPlayer::producerThreadLoop() {
   using namespace std::chrono_literals;
+  TRACE_THREAD_NAME("audio resample");
   std::vector<uint8_t> pcm_buffer;
 
-  while (!stop_ && !playback_finished_) {
-    if (paused_) {
-      std::this_thread::sleep_for(10ms);
+  while (!stop_) {
+    if (paused_ || playback_finished_) {
+      // 暂停或播放结束时阻塞，直到恢复、seek（resetClock）或停止
+      state_event_.wait([this]() {
+        return stop_.load() || (!paused_.load() && !playback_finished_.load());
+      });
       continue;
     }
 
+    maybeBackOffPeriod();
+    checkDevice();
     auto frame = audio_reader_->getNextFrame();
     if (!frame) {
-      // 读取音频帧失败，可能是流结束或出错
-      if (audio_reader_->isEOF()) {
+      // 阻塞直到有新帧；解码线程到达 EOF 退出或本播放器停止 / 暂停时返回
+      bool has_frame = audio_reader_->waitForFrame(
+          [this]() { return stop_.load() || paused_.load(); });
+      if (!has_frame && audio_reader_->isEOF() && !stop_ && !paused_) {
         playback_finished_.store(true);
-        std::this_thread::sleep_for(10ms);
-        continue;
       }
-      std::this_thread::sleep_for(5ms);
       continue;
     }
 
-    // 将平面格式转换为交错格式 (S16)
-    convertPlanarToInterleaved(frame->frame.get(), pcm_buffer);
+    // 重采样 / 下混为设备格式的交错 PCM
+    convertPlanarToInterleaved(frame->frame, pcm_buffer);
     if (pcm_buffer.empty()) {
       continue;
     }
@@ -229,18 +469,39 @@ void AudioPlayer::producerThreadLoop() {
     size_t bytes_to_write = pcm_buffer.size();
     const uint8_t* data_ptr = pcm_buffer.data();
 
-    auto wait_start = std::chrono::high_resolution_clock::now();
-    const auto max_wait_duration = 200ms;  // 最大等待时间
+    auto wait_start = std::chrono::steady_clock::now();
+    const int64_t bytes_per_second =
+        static_cast<int64_t>(device_rate_) * bytes_per_frame_;
+    // 设备停止消耗的判定：超过排空整个上水位所需时间后再等 200ms
+    const auto max_wait_duration =
+        200ms + std::chrono::microseconds(static_cast<int64_t>(
+                    ring_limit_bytes_) * AV_TIME_BASE / bytes_per_second);
 
     while (bytes_to_write > 0 && !stop_ && !paused_) {
-      size_t bytes_written = pushPCMData(data_ptr, bytes_to_write);
+      const size_t fill = pcm_ring_.available();
+      const size_t room =
+          fill < ring_limit_bytes_ ? ring_limit_bytes_ - fill : 0;
+      size_t bytes_written =
+          room > 0 ? pcm_ring_.write(data_ptr, std::min(bytes_to_write, room))
+                   : 0;
       if (bytes_written > 0) {
         data_ptr += bytes_written;
         bytes_to_write -= bytes_written;
+        primed_.store(true, std::memory_order_relaxed);
+        wait_start = std::chrono::steady_clock::now();
       } else {
-        // 环形缓冲区满，等待一段时间再尝试
-        std::this_thread::sleep_for(5ms);
-        auto now = std::chrono::high_resolution_clock::now();
+        // 达到上水位：等回调消耗到补充水位以下再写，按设备消耗速率估算等待
+        // 时间。不由音频回调通知，保证回调中不加锁；暂停 / 停止可立即打断
+        const size_t excess =
+            fill > refill_bytes_ ? fill - refill_bytes_ : bytes_per_frame_;
+        const auto refill_time = std::chrono::microseconds(
+            static_cast<int64_t>(excess) * AV_TIME_BASE / bytes_per_second +
+            1);
+        state_event_.waitFor(refill_time, [&]() {
+          return stop_.load() || paused_.load() ||
+                 pcm_ring_.available() <= refill_bytes_;
+        });
+        auto now = std::chrono::steady_clock::now();
         if (now - wait_start > max_wait_duration) {
           LOG_WARN << "Producer thread wait timeout, dropping audio data";
           break;  // 超过最大等待时间，跳出循环
@@ -252,6 +513,7 @@ void AudioPlayer::producerThreadLoop() {
 
 void AudioPlayer::convertPlanarToInterleaved(const AVFrame* frame,
                                              std::vector<uint8_t>& out) {
+  TRACE_SCOPE("resample");
   if (!frame || frame->nb_samples <= 0) {
     LOG_ERROR << "Invalid frame for conversion";
     out.clear();
@@ -260,92 +522,63 @@ void AudioPlayer::convertPlanarToInterleaved(const AVFrame* frame,
 
   // 计算重采样后所需的缓冲区大小
   int64_t delay = swr_get_delay(swr_ctx_.get(), frame->sample_rate);
-  int max_out_samples = av_rescale_rnd(delay + frame->nb_samples, sample_rate_,
+  int max_out_samples = av_rescale_rnd(delay + frame->nb_samples, device_rate_,
                                        frame->sample_rate, AV_ROUND_UP);
-  int bytes_per_sample = av_get_bytes_per_sample(AV_SAMPLE_FMT_S16);
-  int total_bytes = max_out_samples * channels_ * bytes_per_sample;
+  int total_bytes = max_out_samples * bytes_per_frame_;
   out.resize(total_bytes);
 
   uint8_t* out_data[1] = {out.data()};
+  const uint64_t cpu_start = threadCpuNs();
   int converted_samples =
       swr_convert(swr_ctx_.get(), out_data, max_out_samples,
                   (const uint8_t**)frame->data, frame->nb_samples);
+  const uint64_t cpu_ns = threadCpuNs() - cpu_start;
   if (converted_samples < 0) {
     LOG_ERROR << "Error during resampling";
     out.clear();
     return;
   }
-
-  int expected_bytes = converted_samples * channels_ * bytes_per_sample;
-  out.resize(expected_bytes);
-}
-
-size_t AudioPlayer::pushPCMData(const uint8_t* data, size_t bytes) {
-  if (!data || bytes == 0 || pcm_ring_cap_ == 0) {
-    return 0;
-  }
-
-  std::lock_guard<std::mutex> lock(pcm_mutex_);
-
-  size_t free_space = pcm_ring_cap_ - (pcm_ring_write_ - pcm_ring_read_);
-  if (free_space == 0) {
-    return 0;  // 环形缓冲区满
+  convert_hist_.record(static_cast<int64_t>(cpu_ns / 1000));
+  convert_cpu_ns_.fetch_add(cpu_ns, std::memory_order_relaxed);
+  converted_ns_.fetch_add(static_cast<uint64_t>(frame->nb_samples) *
+                              1000000000ULL / frame->sample_rate,
+                          std::memory_order_relaxed);
+  if (++converts_since_log_ >= CONVERT_LOG_INTERVAL) {
+    converts_since_log_ = 0;
+    auto stats = convert_hist_.snapshot();
+    LOG_INFO << "Audio convert " << channels_ << "ch -> " << device_channels_
+             << "ch " << av_get_sample_fmt_name(device_sample_fmt_)
+             << ": mean=" << stats.mean << "us p99=" << stats.p99
+             << "us, CPU per channel=" << getConvertCpuPerChannel() * 100.0
+             << "%";
   }
 
-  size_t bytes_to_write = std::min(bytes, free_space);
-  size_t first_chunk = std::min(
-      bytes_to_write, pcm_ring_cap_ - (pcm_ring_write_ % pcm_ring_cap_));
-  size_t second_chunk = bytes_to_write - first_chunk;
-
-  // 写入第一块数据
-  std::memcpy(&pcm_ring_buf_[pcm_ring_write_ % pcm_ring_cap_], data,
-              first_chunk);
-  // 写入第二块数据（如果有的话）
-  if (second_chunk > 0) {
-    std::memcpy(&pcm_ring_buf_[0], data + first_chunk, second_chunk);
-  }
-
-  pcm_ring_write_ += bytes_to_write;
-  return bytes_to_write;
+  int expected_bytes = converted_samples * bytes_per_frame_;
+  out.resize(expected_bytes);
 }
 
-size_t AudioPlayer::popPCMData(uint8_t* out, size_t bytes) {
-  if (!out || bytes == 0 || pcm_ring_cap_ == 0) {
-    return 0;
-  }
-
-  std::lock_guard<std::mutex> lock(pcm_mutex_);
-
-  size_t available_data = pcm_ring_write_ - pcm_ring_read_;
-  if (available_data == 0) {
-    return 0;  // 环形缓冲区空
-  }
-
-  size_t bytes_to_read = std::min(bytes, available_data);
-  size_t first_chunk =
-      std::min(bytes_to_read, pcm_ring_cap_ - (pcm_ring_read_ % pcm_ring_cap_));
-  size_t second_chunk = bytes_to_read - first_chunk;
-
-  // 读取第一块数据
-  std::memcpy(out, &pcm_ring_buf_[pcm_ring_read_ % pcm_ring_cap_], first_chunk);
-  // 读取第二块数据（如果有的话）
-  if (second_chunk > 0) {
-    std::memcpy(out + first_chunk, &pcm_ring_buf_[0], second_chunk);
-  }
-
-  pcm_ring_read_ += bytes_to_read;
-  return bytes_to_read;
+double AudioPlayer::getConvertCpuPerChannel() const {
+  const uint64_t audio_ns = converted_ns_.load(std::memory_order_relaxed);
+  if (audio_ns == 0 || channels_ <= 0) return 0.0;
+  return static_cast<double>(convert_cpu_ns_.load(std::memory_order_relaxed)) /
+         static_cast<double>(audio_ns) / channels_;
 }
 
 void AudioPlayer::pause() {
   paused_.store(true);
+  state_event_.notifyAll();
+  std::lock_guard<std::mutex> lock(device_mutex_);
   if (audio_dev_ != 0) {
     SDL_PauseAudioDevice(audio_dev_, 1);  // 暂停音频播放
   }
+  // 回调已停止，时钟停在当前插值位置，不再外推
+  freezeClock(getAudioClock());
 }
 
 void AudioPlayer::resume() {
   paused_.store(false);
+  state_event_.notifyAll();
+  std::lock_guard<std::mutex> lock(device_mutex_);
   if (audio_dev_ != 0) {
     SDL_PauseAudioDevice(audio_dev_, 0);  // 恢复音频播放
   }
@@ -354,70 +587,66 @@ void AudioPlayer::resume() {
 void AudioPlayer::stop() {
   stop_.store(true);
   paused_.store(false);
+  state_event_.notifyAll();
+  if (audio_reader_) {
+    audio_reader_->wakeWaiters();  // 生产者可能正阻塞在帧队列上
+  }
 
   if (producer_thread_.joinable() &&
       producer_thread_.get_id() != std::this_thread::get_id()) {
     producer_thread_.join();
   }
 
-  if (audio_dev_ != 0) {
-    SDL_CloseAudioDevice(audio_dev_);
-    audio_dev_ = 0;
+  {
+    std::lock_guard<std::mutex> lock(device_mutex_);
+    if (audio_dev_ != 0) {
+      SDL_CloseAudioDevice(audio_dev_);
+      audio_dev_ = 0;
+    }
   }
   swr_ctx_.reset();  // 智能指针自动释放
   SDL_Quit();
 
-  {
-    std::lock_guard<std::mutex> lock(pcm_mutex_);
-    pcm_ring_buf_.clear();
-    pcm_ring_cap_ = 0;
-    pcm_ring_read_ = 0;
-    pcm_ring_write_ = 0;
-  }
+  pcm_ring_.release();  // 生产者与回调都已停止
+  primed_ = false;
 
   audio_reader_.reset();
   base_pts_ = 0;
   consumed_samples_ = 0;
-  audio_clock_ = 0;
+  freezeClock(0);
   pulling_ = false;
   stop_.store(false);
   playback_finished_ = false;
 }
 
 void AudioPlayer::clear() {
-  std::lock_guard<std::mutex> lock(pcm_mutex_);
-  pcm_ring_buf_.clear();
-  pcm_ring_cap_ = 0;
-  pcm_ring_read_ = 0;
-  pcm_ring_write_ = 0;
+  // 仅在 stop() 之后调用：此时生产者线程与 SDL 回调都不再访问环形缓冲区
+  pcm_ring_.release();
   base_pts_ = 0;
   consumed_samples_ = 0;
-  audio_clock_ = 0;
+  freezeClock(0);
 }
 
 void AudioPlayer::resetClock(int64_t pts) noexcept {
   // Pause SDL callback to stop further consumption while we reset
+  std::lock_guard<std::mutex> lock(device_mutex_);
   if (audio_dev_ != 0) {
     SDL_PauseAudioDevice(audio_dev_, 1);
   }
 
-  // Clear ring buffer and reset counters under pcm_mutex_
-  {
-    std::lock_guard<std::mutex> lock(pcm_mutex_);
-    pcm_ring_read_ = 0;
-    pcm_ring_write_ = 0;
-    if (!pcm_ring_buf_.empty()) {
-      std::fill(pcm_ring_buf_.begin(), pcm_ring_buf_.end(), 0);
-    }
-  }
+  // The callback is paused, so this thread may act as the consumer and
+  // drop everything buffered so far
+  pcm_ring_.discard();
+  primed_.store(false, std::memory_order_relaxed);
 
   // Reset timing state
   consumed_samples_.store(0, std::memory_order_release);
   base_pts_.store(pts, std::memory_order_release);
-  audio_clock_.store(pts, std::memory_order_release);
+  freezeClock(pts);  // 直到恢复后的首次回调
 
   // Ensure playback_finished_ cleared so producer will refill
   playback_finished_.store(false, std::memory_order_release);
+  state_event_.notifyAll();
 
   // Resume audio callback
   if (audio_dev_ != 0) {
@@ -17,7 +17,10 @@ extern "C" {
 #include <libswresample/swresample.h>
 }
 
+#include "latency_histogram.hpp"
+#include "spsc_byte_ring.hpp"
 #include "stream_source.hpp"
+#include "wait_event.hpp"
 
 // Custom deleter for SwrContext
 struct SwrContextDeleter {
@@ -32,38 +35,91 @@ struct SwrContextDeleter {
  * AudioPlayer: 封装 SDL 音频播放器，用于实时音频帧播放。
  * 支持 PCM 数据缓冲、音量控制、时钟同步和线程安全操作。
  * 使用 SDL 处理音频输出，SwrContext 处理重采样。
+ * 设备参数（采样率、声道数、采样格式）按设备原生规格协商，SwrContext 直接
+ * 转换 / 下混到该规格，SDL 内部不再做第二次转换。
  */
 class AudioPlayer {
  public:
+  // 延迟配置：设备周期、PCM 环形缓冲区深度（上水位）与补充水位。
+  // 生产者把缓冲写到 ring_ms 后停下，等回调消耗到 refill_ms 以下再继续
+  struct LatencyProfile {
+    int period_frames = 1024;      // SDL 设备周期（每次回调的采样帧数）
+    int max_period_frames = 1024;  // 频繁欠载时周期最多退避到的值
+    int ring_ms = 2000;            // 环形缓冲区最多缓存的时长
+    int refill_ms = 1500;          // 缓冲低于该时长时生产者继续写入
+
+    static LatencyProfile standard() { return LatencyProfile{}; }
+    // 低延迟：256 帧周期 + 15ms 缓冲，端到端约 26ms（48kHz）
+    static LatencyProfile lowLatency() { return {256, 1024, 15, 8}; }
+  };
+
   AudioPlayer();
   ~AudioPlayer();
 
   // 初始化音频播放器：设置音频源和 SDL 设备。
   bool initialize(std::shared_ptr<StreamSource> audio_reader);
+  // 在 initialize() 之前设置；默认 standard()，RTAV_AUDIO_PROFILE=low 选低延迟
+  void setLatencyProfile(const LatencyProfile& profile) { profile_ = profile; }
   void pause();   // 暂停播放
   void resume();  // 恢复播放
   void stop();    // 停止播放
   void clear();   // 清空缓冲区
 
-  int64_t getAudioClock() const { return audio_clock_.load(); }
+  // 当前正在输出的媒体时间（微秒）：回调时扣除设备缓冲中尚未播放的数据，
+  // 两次回调之间按单调时钟插值
+  int64_t getAudioClock() const;
   void resetClock(int64_t pts) noexcept;
 
   bool isPaused() const { return paused_.load(); }
+  // 音频设备已丢失，无法继续输出（时钟随之停止），由 Player 转为错误状态
+  bool hasDeviceFailed() const { return device_failed_.load(); }
 
   void setVolume(double norm);  // norm: 0.0 ~ 1.0
   double getVolume() const;
 
+  // 回调取数不足（欠载）的次数，用于诊断爆音 / 断音
+  uint64_t getUnderrunCount() const { return underrun_count_.load(); }
+  int getPeriodFrames() const { return period_frames_.load(); }
+  // 环形缓冲区中尚未被回调取走的时长（微秒）
+  int64_t getBufferedUs() const;
+  // 每帧重采样 / 下混耗时（线程 CPU 时间，微秒）
+  utils::LatencyHistogram::Snapshot getConvertLatency() const {
+    return convert_hist_.snapshot();
+  }
+  // 重采样占用的 CPU 比例（相对一个核），按输入声道数平均
+  double getConvertCpuPerChannel() const;
+
  private:
   // SDL 音频回调函数：填充音频数据。
   static void audioCallback(void* userdata, uint8_t* stream, int len);
   void fillAudioData(uint8_t* stream, int len);  // 填充音频数据到 SDL 缓冲区。
   void producerThreadLoop();  // 生产者线程循环：从音频源拉取帧并转换。
+  // 打开 SDL 设备（暂停状态），实际规格写入 have，失败返回 0；不修改成员。
+  // negotiate 为真时接受设备的原生采样率 / 声道数 / 格式，否则沿用当前规格
+  SDL_AudioDeviceID openDevice(int period_frames, bool negotiate,
+                               SDL_AudioSpec& have);
+  // 启用新打开的设备：按实际规格与周期更新水位与时钟参数（回调未运行时调用）
+  void adoptDevice(SDL_AudioDeviceID dev, const SDL_AudioSpec& have);
+  bool initResampler();  // 按流参数与设备规格创建 SwrContext
+  // 生产者线程中调用：短时间内欠载过多时加倍设备周期并重开设备
+  void maybeBackOffPeriod();
+  // 生产者线程中调用：检查设备是否已丢失（拔出、音频服务退出）
+  void checkDevice();
 
   void convertPlanarToInterleaved(  // 将平面音频帧转换为交织格式。
       const AVFrame* frame, std::vector<uint8_t>& out);
 
-  size_t pushPCMData(const uint8_t* data, size_t bytes);
-  size_t popPCMData(uint8_t* out, size_t bytes);
+  // 时钟锚点：time_us 时刻正在输出 pts_us；running 为假时时钟停在 pts_us。
+  // 只由音频回调写入，其余写入方（pause / resume / resetClock / stop）都在
+  // SDL 暂停或关闭设备、回调不再运行之后进行
+  struct ClockAnchor {
+    int64_t pts_us = 0;
+    int64_t time_us = 0;
+    bool running = false;
+  };
+  void storeClockAnchor(const ClockAnchor& anchor) noexcept;
+  ClockAnchor loadClockAnchor() const noexcept;
+  void freezeClock(int64_t pts) noexcept;  // 时钟停在 pts（回调未运行时调用）
 
   // 音频源和上下文
   std::shared_ptr<StreamSource> audio_reader_;  // 音频流源
@@ -71,13 +127,21 @@ class AudioPlayer {
                                                           SwrContextDeleter{}};
 
   SDL_AudioDeviceID audio_dev_{0};  // SDL 音频设备 ID
-
-  // PCM 环形缓冲区
-  mutable std::mutex pcm_mutex_;       // PCM 缓冲区锁
-  std::vector<uint8_t> pcm_ring_buf_;  // 环形缓冲区
-  size_t pcm_ring_cap_ = 0;            // 环形缓冲区容量
-  uint64_t pcm_ring_read_ = 0;         // 读位置
-  uint64_t pcm_ring_write_ = 0;        // 写位置
+  // 保护 audio_dev_ 的暂停 / 关闭与退避时的重开（回调中不使用）
+  std::mutex device_mutex_;
+
+  // PCM 环形缓冲区：生产者线程写，SDL 回调读，无锁
+  utils::SpscByteRing pcm_ring_;
+  int bytes_per_frame_ = 4;  // 输出每个采样帧的字节数（样本字节 * 声道数）
+  LatencyProfile profile_;
+  std::atomic<int> period_frames_{0};  // 当前设备周期
+  // 上水位 / 补充水位（字节），只由生产者线程使用
+  size_t ring_limit_bytes_ = 0;
+  size_t refill_bytes_ = 0;
+  uint64_t backoff_window_underruns_ = 0;  // 退避窗口开始时的欠载计数
+  bool backoff_disabled_ = false;  // 无法同时打开第二个设备时不再退避
+  std::atomic<bool> device_failed_{false};
+  std::chrono::steady_clock::time_point backoff_window_start_;
 
 #ifndef NDEBUG
   std::ofstream pcm_out_;  // 调试：保存 PCM 数据（仅调试模式）
@@ -89,6 +153,7 @@ class AudioPlayer {
   std::atomic<bool> paused_{false};             // 播放是否暂停
   std::atomic<bool> stop_{false};               // 是否停止播放
   std::atomic<bool> playback_finished_{false};  // 播放是否结束
+  utils::WaitEvent state_event_;  // 生产者等待暂停 / 结束 / 停止状态变化
 
   // 音频参数
   int sample_rate_ = 44100;                         // 音频采样率
@@ -98,8 +163,31 @@ class AudioPlayer {
   std::atomic<int> volume_{
       SDL_MIX_MAXVOLUME};  // 音量，范围 0~SDL_MIX_MAXVOLUME
 
+  // 设备规格（协商结果），重采样输出与回调混音都使用该规格
+  int device_rate_ = 44100;
+  int device_channels_ = 2;
+  SDL_AudioFormat device_format_ = AUDIO_S16SYS;
+  AVSampleFormat device_sample_fmt_ = AV_SAMPLE_FMT_S16;
+
+  // 重采样开销统计（生产者线程写）
+  utils::LatencyHistogram convert_hist_;
+  std::atomic<uint64_t> convert_cpu_ns_{0};  // 累计线程 CPU 时间
+  std::atomic<uint64_t> converted_ns_{0};    // 累计输入音频时长
+  uint64_t converts_since_log_ = 0;
+
   // 时钟同步
-  std::atomic<int64_t> audio_clock_;          // 音频时钟，单位微秒 (us)
   std::atomic<int64_t> base_pts_{0};          // 缓冲区基准时间戳，单位微秒 (us)
   std::atomic<int64_t> consumed_samples_{0};  // 已消耗音频样本数
+  std::atomic<uint64_t> underrun_count_{0};   // 欠载次数
+  std::atomic<bool> primed_{false};  // 启动 / seek 后缓冲已写入过数据
+  // 设备缓冲的采样帧数（SDL 实际给出的），退避重开设备时在回调停止期间更新
+  int device_buffer_frames_ = 1024;
+  int64_t output_latency_us_ = 0;  // 额外输出延迟，RTAV_AUDIO_LATENCY_MS
+  std::atomic<int64_t> max_extrapolate_us_{0};  // 回调停止时最多外推的时长
+
+  // 时钟锚点（seqlock：写入期间序号为奇数，读方重试）
+  std::atomic<uint32_t> anchor_seq_{0};
+  std::atomic<int64_t> anchor_pts_us_{0};
+  std::atomic<int64_t> anchor_time_us_{0};
+  std::atomic<bool> anchor_running_{false};
 };
\ No newline at end of file
@@ -0,0 +1,57 @@
+#include "audio_resampler.hpp"
+
+extern "C" {
+#include <libavutil/channel_layout.h>
+#include <libavutil/opt.h>
+}
+
+int64_t sdlChannelLayout(int channels) {
+  switch (channels) {
+    case 1:
+      return AV_CH_LAYOUT_MONO;
+    case 3:
+      return AV_CH_LAYOUT_2POINT1;  // FL FR LFE
+    case 4:
+      return AV_CH_LAYOUT_QUAD;  // FL FR BL BR
+    case 5:
+      return AV_CH_LAYOUT_2POINT1 | AV_CH_BACK_LEFT | AV_CH_BACK_RIGHT;
+    case 6:
+      return AV_CH_LAYOUT_5POINT1;  // FL FR FC LFE SL SR
+    case 7:
+      return AV_CH_LAYOUT_6POINT1;  // FL FR FC LFE BC SL SR
+    case 8:
+      return AV_CH_LAYOUT_7POINT1;  // FL FR FC LFE BL BR SL SR
+    default:
+      return AV_CH_LAYOUT_STEREO;
+  }
+}
+
+SwrContext* createAudioResampler(const AudioResampleSpec& spec) {
+  AVChannelLayout in_layout{}, out_layout{};
+  if (spec.in_layout == 0 ||
+      av_channel_layout_from_mask(&in_layout, spec.in_layout) < 0 ||
+      in_layout.nb_channels != spec.in_channels) {
+    av_channel_layout_uninit(&in_layout);
+    av_channel_layout_default(&in_layout, spec.in_channels);
+  }
+  av_channel_layout_from_mask(&out_layout,
+                              sdlChannelLayout(spec.out_channels));
+
+  SwrContext* ctx = nullptr;
+  int ret = swr_alloc_set_opts2(&ctx, &out_layout, spec.out_fmt,
+                                spec.out_rate, &in_layout, spec.in_fmt,
+                                spec.in_rate, 0, nullptr);
+  av_channel_layout_uninit(&in_layout);
+  av_channel_layout_uninit(&out_layout);
+  if (ret < 0 || !ctx) {
+    swr_free(&ctx);
+    return nullptr;
+  }
+  av_opt_set_sample_fmt(ctx, "internal_sample_fmt", AV_SAMPLE_FMT_FLTP, 0);
+  av_opt_set_double(ctx, "rematrix_maxval", 1.0, 0);
+  if (swr_init(ctx) < 0) {
+    swr_free(&ctx);
+    return nullptr;
+  }
+  return ctx;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+
+extern "C" {
+#include <libavutil/samplefmt.h>
+#include <libswresample/swresample.h>
+}
+
+/**
+ * 音频重采样上下文的统一创建入口：AudioPlayer 与基准测试共用，保证测到的
+ * 就是播放时的转换路径。输入为流参数，输出为设备的交错格式；声道布局按
+ * SDL 多声道输出的声道顺序选取。内部以平面 float 计算（下混矩阵走
+ * swresample 的 SIMD 混音函数），矩阵归一化到 1.0，5.1 -> 立体声不削波。
+ */
+struct AudioResampleSpec {
+  int64_t in_layout = 0;  // 声道掩码；0 或与声道数不符时按声道数取默认布局
+  int in_channels = 2;
+  int in_rate = 48000;
+  AVSampleFormat in_fmt = AV_SAMPLE_FMT_FLTP;
+  int out_channels = 2;
+  int out_rate = 48000;
+  AVSampleFormat out_fmt = AV_SAMPLE_FMT_FLT;
+};
+
+// 创建并初始化 SwrContext，失败返回 nullptr（由调用方 swr_free）
+SwrContext* createAudioResampler(const AudioResampleSpec& spec);
+
+// SDL 多声道输出的声道顺序（见 SDL_AudioSpec 文档）对应的 FFmpeg 声道掩码
+int64_t sdlChannelLayout(int channels);
@@ -0,0 +1,42 @@
+#include "degrade_controller.hpp"
+
+#include "utils/logger.hpp"
+
+using namespace utils;
+
+int DegradeController::update(int64_t lateness_us, int64_t now_us) {
+  // 指数平滑，单帧抖动（调度延迟、偶发的慢帧）不触发降级
+  smoothed_us_ = smoothed_us_ * 0.8 + static_cast<double>(lateness_us) * 0.2;
+
+  if (smoothed_us_ > ESCALATE_LATENESS_US) {
+    caught_up_since_us_ = -1;
+    if (level_ < MAX_LEVEL && now_us - last_change_us_ >= ESCALATE_HOLD_US) {
+      ++level_;
+      last_change_us_ = now_us;
+      LOG_WARN << "Video is " << static_cast<int64_t>(smoothed_us_ / 1000)
+               << " ms behind audio, decode degradation level -> " << level_;
+    }
+  } else if (smoothed_us_ < RECOVER_LATENESS_US) {
+    if (caught_up_since_us_ < 0) {
+      caught_up_since_us_ = now_us;
+    }
+    if (level_ > 0 && now_us - caught_up_since_us_ >= RECOVER_HOLD_US &&
+        now_us - last_change_us_ >= RECOVER_HOLD_US) {
+      --level_;
+      last_change_us_ = now_us;
+      caught_up_since_us_ = now_us;  // 每降一级重新观察
+      LOG_INFO << "Video caught up with audio, decode degradation level -> "
+               << level_;
+    }
+  } else {
+    caught_up_since_us_ = -1;  // 介于两个阈值之间：保持当前等级
+  }
+  return level_;
+}
+
+void DegradeController::reset() {
+  level_ = 0;
+  smoothed_us_ = 0.0;
+  last_change_us_ = 0;
+  caught_up_since_us_ = -1;
+}
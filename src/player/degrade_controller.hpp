@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * DegradeController: 视频落后于音频时钟时的解码降级反馈环。
+ * 渲染线程每帧调用 update() 报告该帧相对音频时钟的滞后量，控制器对滞后做
+ * 指数平滑，持续超过阈值时逐级升高降级等级，追上后持续一段时间再逐级恢复：
+ *   0: 正常解码
+ *   1: 跳过环路滤波（skip_loop_filter）
+ *   2: 再跳过非参考帧（skip_frame = AVDISCARD_NONREF）
+ *   3: 只解码关键帧（skip_frame = AVDISCARD_NONKEY）
+ * 等级变化后保持一段时间，等待效果体现在后续帧上，避免来回振荡。
+ * 只在渲染线程中使用，不做同步。
+ */
+class DegradeController {
+ public:
+  static constexpr int MAX_LEVEL = 3;
+
+  // 每帧调用：lateness_us 为视频帧落后音频时钟的时间（提前为负），
+  // now_us 为单调时钟；返回更新后的降级等级
+  int update(int64_t lateness_us, int64_t now_us);
+
+  void reset();  // seek / 重新播放时恢复到正常解码
+  int level() const { return level_; }
+
+ private:
+  static constexpr int64_t ESCALATE_LATENESS_US = 80000;  // 滞后超过 80ms 升级
+  static constexpr int64_t RECOVER_LATENESS_US = 20000;   // 低于 20ms 视为追上
+  static constexpr int64_t ESCALATE_HOLD_US = 500000;     // 升级后至少观察 0.5s
+  static constexpr int64_t RECOVER_HOLD_US = 2000000;     // 持续追上 2s 才降一级
+
+  int level_ = 0;
+  double smoothed_us_ = 0.0;
+  int64_t last_change_us_ = 0;       // 上次等级变化的时间
+  int64_t caught_up_since_us_ = -1;  // 开始持续追上的时间，-1 表示未追上
+};
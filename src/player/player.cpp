@@ -3,10 +3,13 @@
 #include <algorithm>
 #include <chrono>
 #include <condition_variable>
+#include <cstdlib>
 #include <mutex>
 #include <queue>
 
 #include "utils/logger.hpp"
+#include "utils/metrics_server.hpp"
+#include "utils/trace.hpp"
 
 extern "C" {
 #include <SDL2/SDL.h>
@@ -16,33 +19,74 @@ extern "C" {
 }
 
 #include "audio_player.hpp"
+#include "demuxer.hpp"
 #include "gl_renderer.hpp"
 #include "stream_source.hpp"
 
 using namespace utils;
 
-// 同步阈值：最小阈值为40ms，最大阈值为100ms，超过200ms则进行帧重复
+// 同步阈值：晚于音频 40ms 计为迟到帧，超过 100ms（且超过两帧）丢帧
 const int64_t AV_SYNC_THRESHOLD_MIN = static_cast<int64_t>(0.04 * AV_TIME_BASE);
 const int64_t AV_SYNC_THRESHOLD_MAX = static_cast<int64_t>(0.1 * AV_TIME_BASE);
-const int64_t AV_SYNC_FRAMEDUP_THRESHOLD =
-    static_cast<int64_t>(0.2 * AV_TIME_BASE);  // 音视频时间差过大时，允许重复帧
+// 过晚帧最多连续丢弃的数量
+const int MAX_CONSECUTIVE_DROPS = 4;
+
+// 单调时钟，单位微秒(us)
+static int64_t nowUs() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// 视频解码线程策略，可通过环境变量覆盖：
+// RTAV_DECODE_THREAD_MODE=auto|frame|slice|off，RTAV_DECODE_THREADS=N（0 为自动）
+
+static Decoder::ThreadMode decodeThreadModeFromEnv() {
+  const char* env = std::getenv("RTAV_DECODE_THREAD_MODE");
+  if (!env) return Decoder::ThreadMode::Auto;
+  const std::string mode(env);
+  if (mode == "frame") return Decoder::ThreadMode::Frame;
+  if (mode == "slice") return Decoder::ThreadMode::Slice;
+  if (mode == "off") return Decoder::ThreadMode::Off;
+  if (mode != "auto") {
+    LOG_WARN << "Unknown RTAV_DECODE_THREAD_MODE: " << mode << ", using auto";
+  }
+  return Decoder::ThreadMode::Auto;
+}
+
+static int decodeThreadCountFromEnv() {
+  const char* env = std::getenv("RTAV_DECODE_THREADS");
+  return env ? std::max(0, std::atoi(env)) : 0;
+}
 
 Player::Player()
     : state_(State::Stopped),
       render_thread_(),
       timestamp_cb_(nullptr),
-      state_cb_(nullptr),
-      last_delay_(0.0) {
+      state_cb_(nullptr) {
   LOG_INFO << "Initializing Player";
   video_reader_ = std::make_unique<StreamSource>(Type::Video);
   audio_reader_ = std::make_shared<StreamSource>(Type::Audio);
   renderer_ = std::make_unique<GLRenderer>();
   audio_player_ = std::make_unique<AudioPlayer>();
+  // 视频先结束时渲染线程等待音频 EOF，由音频解码线程唤醒
+  audio_reader_->setEOFCallback([this]() { state_event_.notifyAll(); });
+  seek_thread_ = std::thread(&Player::seekLoop, this);
+  initMetrics();
 }
 
 Player::~Player() {
   LOG_INFO << "Destroying Player";
+  metrics_server_.reset();  // 采集回调引用本对象的成员，先停止服务
   close();
+  {
+    std::lock_guard<std::mutex> lock(seek_mutex_);
+    seek_quit_ = true;
+  }
+  seek_cv_.notify_all();
+  if (seek_thread_.joinable()) {
+    seek_thread_.join();
+  }
 }
 
 bool Player::open(const std::string& filename) {
@@ -51,14 +95,41 @@ bool Player::open(const std::string& filename) {
     return false;
   }
 
-  if (!video_reader_->open(filename)) {
+  // 文件只打开、解析一次，由音视频 StreamSource 共享
+  auto demuxer = std::make_shared<Demuxer>();
+  if (!demuxer->open(filename)) {
+    LOG_ERROR << "Failed to open media file: " << filename;
+    std::lock_guard<std::mutex> lock(demuxer_mutex_);
+    demuxer_.reset();
+    return false;
+  }
+  {
+    std::lock_guard<std::mutex> lock(demuxer_mutex_);
+    demuxer_ = demuxer;
+  }
+  const Demuxer::OpenStats open_stats = demuxer_->getOpenStats();
+  startup_ = StartupStats();
+  startup_.open_us = open_stats.open_us;
+  startup_.probe_us = open_stats.probe_us;
+  startup_.probe_cached = open_stats.probe_cached;
+  startup_play_us_.store(0);
+  first_decode_us_.store(0);
+  first_present_us_.store(0);
+  startup_decoded_at_us_ = 0;
+  const int64_t decoder_open_start = nowUs();
+
+  video_reader_->setDecoderThreading(decodeThreadModeFromEnv(),
+                                     decodeThreadCountFromEnv());
+  if (!video_reader_->open(demuxer_)) {
     LOG_ERROR << "Failed to open video stream";
     video_reader_->close();
+    demuxer_->close();
     return false;
   }
-  if (!audio_reader_->open(filename)) {
+  if (!audio_reader_->open(demuxer_)) {
     LOG_ERROR << "Failed to open audio stream";
     video_reader_->close();
+    demuxer_->close();
     return false;
   } else {
     // Initialize audio player if audio stream is available
@@ -67,9 +138,11 @@ bool Player::open(const std::string& filename) {
       LOG_ERROR << "Failed to initialize audio player";
       video_reader_->close();
       audio_reader_->close();
+      demuxer_->close();
       return false;
     }
   }
+  startup_.decoder_open_us = nowUs() - decoder_open_start;
 
   // Initialize renderer if video stream is available
   if (video_reader_) {
@@ -79,11 +152,13 @@ bool Player::open(const std::string& filename) {
       LOG_ERROR << "Failed to start renderer";
       video_reader_->close();
       audio_reader_->close();
+      demuxer_->close();
       updateState(State::Error);
       return false;
     }
   }
 
+  startup_pending_.store(true);
   is_running_.store(true);
   render_thread_ = std::thread(&Player::renderLoop, this);
   updateState(State::Stopped);  // 打开后默认停止
@@ -91,12 +166,17 @@ bool Player::open(const std::string& filename) {
 }
 
 void Player::close() {
+  cancelSeeks();  // 异步 seek 不能与资源释放并发
   if (getState() == State::Stopped) {
     return;
   }
   LOG_INFO << "Closing Player";
 
   is_running_.store(false);
+  wakeRenderThread();
+  if (renderer_) {
+    renderer_->clearFrames();  // 打断阻塞在 presentAt() 的渲染线程
+  }
   if (render_thread_.joinable()) {
     render_thread_.join();
   }
@@ -110,6 +190,12 @@ void Player::close() {
     renderer_->clearFrames();
   }
   if (video_reader_) {
+    const SyncStats stats = getSyncStats();
+    LOG_INFO << "Sync stats: degrade level " << stats.degrade_level
+             << ", frames skipped " << stats.frames_skipped
+             << ", frames dropped " << stats.frames_dropped;
+    video_reader_->setDegradeLevel(0);
+    degrade_reset_.store(true);
     video_reader_->stopDecoding();
     video_reader_->close();
   }
@@ -117,16 +203,69 @@ void Player::close() {
     audio_reader_->stopDecoding();
     audio_reader_->close();
   }
+  if (demuxer_) {
+    demuxer_->close();
+  }
 
   updateState(State::Stopped);
 }
 
+// 异步 seek 进行中时，play / pause / resume 只记录 seek 完成后的期望状态：
+// seek 线程正在暂停状态下解码到目标，此时恢复会让音频设备跑在重置后的
+// 时钟之前。状态转换都在 state_mutex_ 下进行，与 seek 线程的转换互斥
+bool Player::deferToSeek(bool play_after) {
+  std::lock_guard<std::mutex> lock(seek_mutex_);
+  if (!seek_in_flight_.load()) {
+    return false;
+  }
+  seek_play_after_ = play_after;
+  return true;
+}
+
 bool Player::play() {
+  std::lock_guard<std::mutex> lock(state_mutex_);
+  if (deferToSeek(true)) {
+    return true;
+  }
+  return playLocked();
+}
+
+void Player::pause() {
+  std::lock_guard<std::mutex> lock(state_mutex_);
+  if (!deferToSeek(false)) {
+    pauseLocked();
+  }
+}
+
+void Player::resume() {
+  std::lock_guard<std::mutex> lock(state_mutex_);
+  if (!deferToSeek(true)) {
+    resumeLocked();
+  }
+}
+
+void Player::togglePause() {
+  std::lock_guard<std::mutex> lock(state_mutex_);
+  {
+    std::lock_guard<std::mutex> seek_lock(seek_mutex_);
+    if (seek_in_flight_.load()) {
+      seek_play_after_ = !seek_play_after_;
+      return;
+    }
+  }
+  if (getState() == State::Playing) {
+    pauseLocked();
+  } else if (getState() == State::Paused) {
+    resumeLocked();
+  }
+}
+
+bool Player::playLocked() {
   if (getState() == State::Playing) {
     return true;  // 已经在播放
   }
   if (getState() == State::Paused) {
-    resume();
+    resumeLocked();
     return true;
   }
 
@@ -142,6 +281,12 @@ bool Player::play() {
 
   // Start audio playback first to ensure audio is ready
   LOG_INFO << "Starting playback";
+  if (startup_pending_.load() && startup_play_us_.load() == 0) {
+    startup_play_us_.store(nowUs());
+  }
+  if (demuxer_) {
+    demuxer_->start();
+  }
   if (audio_reader_) {
     audio_reader_->startDecoding();
     if (audio_player_ && !audio_player_->isPaused()) {
@@ -155,7 +300,7 @@ bool Player::play() {
   return true;
 }
 
-void Player::pause() {
+void Player::pauseLocked() {
   if (getState() != State::Playing) {
     return;
   }
@@ -168,7 +313,7 @@ void Player::pause() {
   updateState(State::Paused);
 }
 
-void Player::resume() {
+void Player::resumeLocked() {
   if (getState() != State::Paused) {
     return;
   }
@@ -186,6 +331,7 @@ void Player::resume() {
 }
 
 void Player::stop() {
+  std::lock_guard<std::mutex> lock(state_mutex_);
   if (getState() == State::Stopped) {
     return;
   }
@@ -199,6 +345,9 @@ void Player::stop() {
   if (video_reader_) {
     video_reader_->stopDecoding();
   }
+  if (demuxer_) {
+    demuxer_->stop();
+  }
   if (renderer_) {
     renderer_->clearFrames();
   }
@@ -206,27 +355,185 @@ void Player::stop() {
 }
 
 bool Player::seek(double timestamp_seconds) {
+  std::lock_guard<std::mutex> exec_lock(seek_exec_mutex_);
+  return performSeek(timestamp_seconds, nullptr);
+}
+
+void Player::seekAsync(double timestamp_seconds, bool play_after,
+                       SeekCallback cb) {
+  timestamp_seconds = std::min(std::max(0.0, timestamp_seconds), getDuration());
+  SeekRequest superseded;
+  bool has_superseded = false;
+  {
+    std::lock_guard<std::mutex> lock(seek_mutex_);
+    if (seek_pending_) {
+      superseded = std::move(pending_seek_);
+      has_superseded = true;
+    }
+    pending_seek_.timestamp_sec = timestamp_seconds;
+    pending_seek_.play_after = play_after;
+    seek_play_after_ = play_after;
+    pending_seek_.cb = std::move(cb);
+    pending_seek_.generation = seek_generation_.fetch_add(1) + 1;
+    seek_pending_ = true;
+    seek_target_sec_.store(timestamp_seconds);
+    seek_in_flight_.store(true);
+  }
+  seek_cv_.notify_one();
+
+  // 执行中的 seek 可能阻塞在数据包队列上，唤醒它检查取消条件
+  if (demuxer_) {
+    if (auto* q = demuxer_->getPacketQueue(Type::Video)) q->notifyAll();
+    if (auto* q = demuxer_->getPacketQueue(Type::Audio)) q->notifyAll();
+  }
+  if (has_superseded && superseded.cb) {
+    superseded.cb(false, superseded.timestamp_sec);  // 尚未执行即被取代
+  }
+}
+
+void Player::seekLoop() {
+  TRACE_THREAD_NAME("seek");
+  std::unique_lock<std::mutex> lock(seek_mutex_);
+  while (true) {
+    seek_cv_.wait(lock, [this]() { return seek_quit_ || seek_pending_; });
+    if (seek_quit_) {
+      break;
+    }
+    SeekRequest req = std::move(pending_seek_);
+    pending_seek_ = SeekRequest();
+    seek_pending_ = false;
+    lock.unlock();
+
+    bool ok = false;
+    bool superseded = false;
+    {
+      std::lock_guard<std::mutex> exec_lock(seek_exec_mutex_);
+      const uint64_t gen = req.generation;
+      auto cancel = [this, gen]() { return seek_generation_.load() != gen; };
+      ok = performSeek(req.timestamp_sec, cancel, req.play_after);
+      superseded = cancel();
+      // 结束 seek 与按期望状态恢复播放在 state_mutex_ 下一起完成，期间的
+      // pause / resume 要么被记录到期望状态，要么在恢复之后才执行
+      std::lock_guard<std::mutex> state_lock(state_mutex_);
+      lock.lock();
+      if (!seek_pending_) {
+        seek_in_flight_.store(false);
+      }
+      const bool play_after = seek_play_after_;
+      lock.unlock();
+      if (ok && !superseded && play_after) {
+        playLocked();
+      }
+    }
+
+    if (req.cb) {
+      req.cb(ok && !superseded, req.timestamp_sec);
+    }
+    lock.lock();
+  }
+}
+
+void Player::cancelSeeks() {
+  SeekRequest dropped;
+  {
+    std::lock_guard<std::mutex> lock(seek_mutex_);
+    if (seek_pending_) {
+      dropped = std::move(pending_seek_);
+      pending_seek_ = SeekRequest();
+      seek_pending_ = false;
+    }
+    seek_generation_.fetch_add(1);  // 执行中的 seek 随之放弃
+  }
+  if (demuxer_) {
+    if (auto* q = demuxer_->getPacketQueue(Type::Video)) q->notifyAll();
+    if (auto* q = demuxer_->getPacketQueue(Type::Audio)) q->notifyAll();
+  }
+  if (dropped.cb) {
+    dropped.cb(false, dropped.timestamp_sec);
+  }
+  // 等待执行中的 seek 退出
+  std::lock_guard<std::mutex> exec_lock(seek_exec_mutex_);
+  seek_in_flight_.store(false);
+}
+
+bool Player::performSeek(double timestamp_seconds,
+                         const std::function<bool()>& cancel,
+                         bool measure_present) {
+  const int64_t start_us = nowUs();
+  if (getState() == State::Playing) {
+    measure_present = true;
+  }
+  seek_start_us_.store(0);  // 上一次 seek 尚未显示首帧则放弃统计
   // pause during seek to avoid races
-  pause();
+  {
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    pauseLocked();
+  }
   timestamp_seconds = std::min(std::max(0.0, timestamp_seconds), getDuration());
   int64_t seek_target = static_cast<int64_t>(timestamp_seconds * AV_TIME_BASE);
 
-  if (video_reader_) {
-    if (!video_reader_->seek(seek_target)) {
-      LOG_ERROR << "Failed to seek video to timestamp: " << seek_target;
-      return false;
-    }
+  // 所有流只做一次 av_seek_frame，之后各流从自己的数据包队列解码到目标位置
+  if (!demuxer_ || !demuxer_->seek(seek_target)) {
+    LOG_ERROR << "Failed to seek demuxer to timestamp: " << seek_target;
+    return false;
+  }
+  const int64_t demux_done_us = nowUs();
+  if (cancel && cancel()) {
+    return false;  // 已有更新的请求，不再解码到本次目标
   }
 
+  // 音视频流各自从数据包队列解码到目标，互不依赖，并行执行
+  bool audio_ok = true;
+  std::thread audio_seek;
   if (audio_reader_) {
     if (audio_player_) audio_player_->resetClock(seek_target);
-    if (!audio_reader_->seek(seek_target)) {
-      LOG_ERROR << "Failed to seek audio to timestamp: " << seek_target;
-      return false;
-    }
+    audio_seek = std::thread([this, seek_target, &cancel, &audio_ok]() {
+      audio_ok = audio_reader_->seek(seek_target, cancel);
+    });
+  }
+
+  bool video_ok = true;
+  if (video_reader_) {
+    // seek 目标帧需完整解码；降级控制器从正常等级重新开始
+    video_reader_->setDegradeLevel(0);
+    degrade_reset_.store(true);
+    video_ok = video_reader_->seek(seek_target, cancel);
+  }
+  if (audio_seek.joinable()) {
+    audio_seek.join();
   }
 
-  LOG_INFO << "Seeked to timestamp: " << seek_target;
+  if (cancel && cancel()) {
+    LOG_INFO << "Seek to " << seek_target << " superseded by a newer request";
+    return false;
+  }
+  if (!video_ok) {
+    LOG_ERROR << "Failed to seek video to timestamp: " << seek_target;
+    return false;
+  }
+  if (!audio_ok) {
+    LOG_ERROR << "Failed to seek audio to timestamp: " << seek_target;
+    return false;
+  }
+
+  const int64_t decode_done_us = nowUs();
+  seek_hist_->record(decode_done_us - start_us);
+  seek_demux_us_.store(demux_done_us - start_us);
+  seek_decode_us_.store(decode_done_us - demux_done_us);
+  seek_present_us_.store(0);
+  LOG_INFO << "Seeked to timestamp: " << seek_target << " (demux-seek "
+           << seek_demux_us_.load() / 1000.0 << " ms, decode-to-target "
+           << seek_decode_us_.load() / 1000.0 << " ms; video "
+           << (video_reader_ ? video_reader_->getLastSeekDecodeUs() / 1000.0
+                             : 0.0)
+           << " ms, audio "
+           << (audio_reader_ ? audio_reader_->getLastSeekDecodeUs() / 1000.0
+                             : 0.0)
+           << " ms)";
+  // 首帧显示时间由渲染线程在恢复播放后记录
+  if (measure_present) {
+    seek_start_us_.store(start_us);
+  }
   return true;
 }
 
@@ -238,6 +545,175 @@ bool Player::isFinished() const noexcept {
 
 Player::State Player::getState() const noexcept { return state_.load(); }
 
+Player::SeekStats Player::getLastSeekStats() const noexcept {
+  SeekStats stats;
+  stats.demux_seek_us = seek_demux_us_.load();
+  stats.decode_to_target_us = seek_decode_us_.load();
+  stats.first_present_us = seek_present_us_.load();
+  return stats;
+}
+
+Player::StartupStats Player::getStartupStats() const noexcept {
+  StartupStats stats = startup_;
+  stats.first_decode_us = first_decode_us_.load();
+  stats.first_present_us = first_present_us_.load();
+  return stats;
+}
+
+Player::SyncStats Player::getSyncStats() const noexcept {
+  SyncStats stats;
+  if (video_reader_) {
+    stats.degrade_level = video_reader_->getDegradeLevel();
+    stats.frames_skipped = video_reader_->getFramesSkipped();
+  }
+  stats.frames_dropped = frames_dropped_.load(std::memory_order_relaxed);
+  return stats;
+}
+
+void Player::initMetrics() {
+  frames_presented_metric_ = &metrics_.counter(
+      "rtav_frames_presented_total", "Video frames handed to the renderer");
+  frames_late_metric_ = &metrics_.counter(
+      "rtav_frames_late_total",
+      "Video frames presented more than 40 ms behind the audio clock");
+  av_drift_metric_ = &metrics_.gauge(
+      "rtav_av_drift_seconds",
+      "Video PTS minus audio clock of the last frame (positive: video ahead)");
+  av_drift_hist_ = &metrics_.histogram("rtav_av_drift_abs_seconds",
+                                       "Absolute A/V drift per video frame");
+  seek_hist_ = &metrics_.histogram(
+      "rtav_seek_seconds", "Seek request to target frame decoded");
+  seek_present_hist_ = &metrics_.histogram(
+      "rtav_seek_present_seconds", "Seek request to first frame presented");
+  metrics_.addCollector([this](std::vector<utils::MetricSample>& out) {
+    collectMetrics(out);
+  });
+
+  const char* env = std::getenv("RTAV_METRICS_PORT");
+  const int port = env ? std::atoi(env) : 0;
+  if (port > 0 && port < 65536) {
+    metrics_server_ = std::make_unique<utils::MetricsServer>();
+    if (!metrics_server_->start(port, [this]() { return getMetricsText(); })) {
+      metrics_server_.reset();
+    }
+  }
+}
+
+// 采集时从各组件读取已有的统计，不在热路径上重复记录
+void Player::collectMetrics(std::vector<utils::MetricSample>& out) const {
+  using utils::MetricSample;
+  const State state = getState();
+  out.push_back(MetricSample::gauge(
+      "rtav_playing", "1 while playing, 0 otherwise",
+      state == State::Playing ? 1.0 : 0.0));
+  out.push_back(MetricSample::gauge("rtav_error", "1 if the player failed",
+                                    state == State::Error ? 1.0 : 0.0));
+  out.push_back(MetricSample::gauge("rtav_position_seconds",
+                                    "Current playback position",
+                                    getCurrentTimestamp()));
+
+  const SyncStats sync = getSyncStats();
+  out.push_back(MetricSample::counter(
+      "rtav_frames_dropped_total",
+      "Decoded video frames dropped for being too late",
+      static_cast<double>(sync.frames_dropped)));
+  out.push_back(MetricSample::counter(
+      "rtav_frames_skipped_total",
+      "Video frames skipped by decode degradation",
+      static_cast<double>(sync.frames_skipped)));
+  out.push_back(MetricSample::gauge("rtav_degrade_level",
+                                    "Current video decode degradation level",
+                                    sync.degrade_level));
+  if (audio_player_) {
+    out.push_back(MetricSample::counter(
+        "rtav_audio_underruns_total",
+        "Audio callbacks that ran out of PCM data",
+        static_cast<double>(audio_player_->getUnderrunCount())));
+    out.push_back(MetricSample::gauge(
+        "rtav_audio_buffered_seconds",
+        "PCM queued in the ring buffer ahead of the audio device",
+        audio_player_->getBufferedUs() / 1e6));
+    out.push_back(MetricSample::gauge(
+        "rtav_audio_period_frames", "Current audio device period in frames",
+        audio_player_->getPeriodFrames()));
+    out.push_back(MetricSample::latency(
+        "rtav_audio_convert_seconds",
+        "Per-frame resample/downmix CPU time",
+        audio_player_->getConvertLatency()));
+    out.push_back(MetricSample::gauge(
+        "rtav_audio_convert_cpu_per_channel",
+        "Resample/downmix CPU share of one core per input channel",
+        audio_player_->getConvertCpuPerChannel()));
+  }
+  if (renderer_) {
+    out.push_back(MetricSample::latency("rtav_texture_upload_seconds",
+                                        "Per-frame texture upload time",
+                                        renderer_->getUploadLatency()));
+    out.push_back(MetricSample::latency(
+        "rtav_present_error_seconds",
+        "Absolute difference between a frame's deadline and its buffer swap",
+        renderer_->getPresentError()));
+    out.push_back(MetricSample::latency(
+        "rtav_frame_hold_seconds",
+        "Time each video frame stayed on screen",
+        renderer_->getFrameHold()));
+    out.push_back(MetricSample::gauge(
+        "rtav_display_refresh_interval_seconds",
+        "Estimated display refresh interval (0 when vsync is off)",
+        renderer_->getRefreshInterval() / 1e6));
+    out.push_back(MetricSample::counter(
+        "rtav_vsync_dropped_frames_total",
+        "Frames dropped because they missed their vsync slot",
+        static_cast<double>(renderer_->getVsyncDrops())));
+  }
+
+  const std::pair<const StreamSource*, const char*> sources[] = {
+      {video_reader_.get(), "stream=\"video\""},
+      {audio_reader_.get(), "stream=\"audio\""}};
+  for (const auto& [source, labels] : sources) {
+    if (!source) continue;
+    out.push_back(MetricSample::gauge(
+        "rtav_frame_queue_frames", "Decoded frames waiting for output",
+        static_cast<double>(source->getQueuedFrames()), labels));
+    out.push_back(MetricSample::latency(
+        "rtav_decode_seconds", "Decode time per packet",
+        source->getStageLatency().decode, labels));
+  }
+
+  std::shared_ptr<Demuxer> demuxer;
+  {
+    std::lock_guard<std::mutex> lock(demuxer_mutex_);
+    demuxer = demuxer_;
+  }
+  if (demuxer) {
+    const std::pair<Type, const char*> queues[] = {
+        {Type::Video, "stream=\"video\""},
+        {Type::Audio, "stream=\"audio\""}};
+    for (const auto& [type, labels] : queues) {
+      PacketQueue* queue = demuxer->getPacketQueue(type);
+      if (!queue) continue;
+      out.push_back(MetricSample::gauge(
+          "rtav_packet_queue_packets", "Demuxed packets waiting for decode",
+          static_cast<double>(queue->size()), labels));
+      out.push_back(MetricSample::gauge(
+          "rtav_packet_queue_bytes", "Bytes of demuxed packets queued",
+          static_cast<double>(queue->bytes()), labels));
+    }
+    out.push_back(MetricSample::latency("rtav_demux_read_seconds",
+                                        "av_read_frame time per packet",
+                                        demuxer->getReadLatency()));
+    out.push_back(MetricSample::counter(
+        "rtav_demux_bytes_total", "Packet bytes read from the input",
+        static_cast<double>(demuxer->getBytesRead())));
+  }
+}
+
+std::vector<utils::MetricSample> Player::getMetrics() const {
+  return metrics_.collect();
+}
+
+std::string Player::getMetricsText() const { return metrics_.renderText(); }
+
 double Player::getDuration() const noexcept {
   if (video_reader_)
     return static_cast<double>(video_reader_->getDuration()) / AV_TIME_BASE;
@@ -248,6 +724,10 @@ double Player::getDuration() const noexcept {
 
 // 返回当前时间戳，优先使用音频时钟，其次是视频PTS（单位秒）
 double Player::getCurrentTimestamp() const noexcept {
+  // 异步 seek 未完成时返回其目标，连续的相对跳转以最新目标为基准
+  if (seek_in_flight_.load()) {
+    return seek_target_sec_.load();
+  }
   if (audio_reader_ && audio_player_) {
     int64_t ac = audio_player_->getAudioClock();
     if (ac > 0) return static_cast<double>(ac) / AV_TIME_BASE;
@@ -278,6 +758,7 @@ double Player::getVolume() const noexcept {
 
 void Player::renderLoop() {
   LOG_INFO << "Render thread started";
+  TRACE_THREAD_NAME("av sync");
 
   if (!renderer_ || !video_reader_) {
     LOG_ERROR << "Renderer or video reader not initialized";
@@ -285,13 +766,7 @@ void Player::renderLoop() {
     return;
   }
 
-  // Wait until the renderer window is ready
-  int wait_count = 0;
-  while (wait_count < 50 && !renderer_->isRunning()) {
-    std::this_thread::sleep_for(std::chrono::milliseconds(5));
-    wait_count++;
-  }
-
+  // GLRenderer::start() 在 open() 中同步完成，此时窗口已创建
   // Install key callback if provided
   if (key_callback_) {
     GLFWwindow* window = renderer_->window();
@@ -302,7 +777,10 @@ void Player::renderLoop() {
 
   while (is_running_.load()) {
     if (getState() == State::Paused) {
-      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      // 暂停期间阻塞，直到恢复、停止或关闭
+      state_event_.wait([this]() {
+        return !is_running_.load() || getState() != State::Paused;
+      });
       continue;
     }
 
@@ -313,14 +791,26 @@ void Player::renderLoop() {
       break;
     }
 
+    // 音频设备丢失后音频时钟不再前进，无法继续同步播放
+    if (audio_player_ && audio_player_->hasDeviceFailed()) {
+      LOG_ERROR << "Audio device lost, stopping playback";
+      is_running_.store(false);
+      updateState(State::Error);
+      break;
+    }
+
     // Get next video frame
     auto video_frame = video_reader_->getNextFrame();
     if (!video_frame) {
       if (video_reader_->isEOF()) {
         LOG_INFO << "Video stream EOF reached";
         if (audio_reader_ && !audio_reader_->isEOF()) {
-          // Wait for audio to finish
-          std::this_thread::sleep_for(std::chrono::milliseconds(10));
+          // Wait for audio to finish（音频 EOF 或状态变化时被唤醒）
+          const State state = getState();
+          state_event_.wait([this, state]() {
+            return !is_running_.load() || audio_reader_->isEOF() ||
+                   getState() != state;
+          });
           continue;
         } else {
           // Both streams finished
@@ -329,45 +819,100 @@ void Player::renderLoop() {
           break;
         }
       } else {
-        // No frame available yet, wait a bit
-        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        // No frame available yet, block until the decoder pushes one
+        video_reader_->waitForFrame([this]() {
+          return !is_running_.load() || getState() == State::Paused;
+        });
         continue;
       }
     }
 
+    // 打开后的首帧：play() 之前 seek 解出的帧不计入
+    if (startup_decoded_at_us_ == 0 && startup_pending_.load()) {
+      const int64_t play_us = startup_play_us_.load();
+      if (play_us != 0) {
+        startup_decoded_at_us_ = nowUs();
+        first_decode_us_.store(startup_decoded_at_us_ - play_us);
+      }
+    }
+
     int64_t video_pts = video_frame->pts;
     int64_t audio_clock = audio_player_ ? audio_player_->getAudioClock() : 0;
 
     // Calculate the time difference between video PTS and audio clock
     double diff = static_cast<double>(video_pts - audio_clock) / AV_TIME_BASE;
+    if (audio_player_) {
+      av_drift_metric_->set(diff);
+      av_drift_hist_->record(std::llabs(video_pts - audio_clock));
+    }
 
-    // Determine delay based on frame rate
+    // Frame duration, used as the drop threshold
     int64_t frame_delay =
         (video_frame->duration > 0)
             ? video_frame->duration
             : static_cast<int64_t>(AV_TIME_BASE /
                                    video_reader_->getFrameRate());
-    double delay = static_cast<double>(frame_delay) / AV_TIME_BASE;
-
-    // Adjust delay based on AV sync logic
-    if (fabs(diff) < AV_SYNC_THRESHOLD_MIN) {
-      // 时间差很小，不做处理，正常渲染
-    } else if (fabs(diff) > AV_SYNC_THRESHOLD_MAX) {
-      // 时间差太大，强制同步（丢帧或补帧）
-      delay = std::max(0.0, delay + diff);
-    } else if (diff > AV_SYNC_FRAMEDUP_THRESHOLD) {
-      // 视频滞后太多，重复上一帧
-      delay = 0.0;
+
+    // 视频持续落后音频时提高解码降级等级，追上后逐级恢复
+    if (degrade_reset_.exchange(false)) {
+      degrade_.reset();
+      present_scheduler_.reset();
+      consecutive_drops_ = 0;
     }
+    if (audio_player_) {
+      const int64_t lateness = audio_clock - video_pts;
+      const int level = degrade_.update(lateness, nowUs());
+      if (level != video_reader_->getDegradeLevel()) {
+        video_reader_->setDegradeLevel(level);
+      }
 
-    // Smooth delay to avoid jitter (简单低通滤波)
-    if (last_delay_ > 0) {
-      delay = last_delay_ * 0.9 + delay * 0.1;
+      // 已明显晚于音频的帧不再上传显示；限制连续丢帧数，保证画面仍在更新
+      if (lateness > std::max(AV_SYNC_THRESHOLD_MAX, 2 * frame_delay) &&
+          consecutive_drops_ < MAX_CONSECUTIVE_DROPS) {
+        ++consecutive_drops_;
+        frames_dropped_.fetch_add(1, std::memory_order_relaxed);
+        TRACE_INSTANT("drop frame");
+        continue;  // video_frame 析构时归还帧池
+      }
+      consecutive_drops_ = 0;
+      if (lateness > AV_SYNC_THRESHOLD_MIN) {
+        frames_late_metric_->inc();  // 仍然显示，但已晚于音频
+      }
     }
-    last_delay_ = delay;
 
+    // 按主时钟换算出绝对显示时刻，交给渲染线程在该时刻上屏；
+    // 上一帧尚未显示时在此阻塞，起到原来帧间 sleep 的节拍作用
     if (renderer_) {
-      renderer_->enqueueFrame(video_frame->frame);
+      const int64_t deadline_us = present_scheduler_.deadlineFor(
+          video_pts,
+          audio_player_ ? audio_clock : PresentScheduler::NO_CLOCK, nowUs());
+      TRACE_SCOPE("presentAt");
+      if (renderer_->presentAt(std::move(video_frame), deadline_us)) {
+        frames_presented_metric_->inc();
+      }
+    }
+
+    if (startup_decoded_at_us_ != 0 && startup_pending_.exchange(false)) {
+      first_present_us_.store(nowUs() - startup_decoded_at_us_);
+      const StartupStats stats = getStartupStats();
+      LOG_INFO << "Time to first frame: "
+               << (stats.open_us + stats.probe_us + stats.decoder_open_us +
+                   stats.first_decode_us + stats.first_present_us) /
+                      1000.0
+               << " ms (open " << stats.open_us / 1000.0 << ", probe "
+               << stats.probe_us / 1000.0
+               << (stats.probe_cached ? " cached" : "") << ", decoder open "
+               << stats.decoder_open_us / 1000.0 << ", first decode "
+               << stats.first_decode_us / 1000.0 << ", first present "
+               << stats.first_present_us / 1000.0 << ")";
+    }
+
+    const int64_t seek_start = seek_start_us_.exchange(0);
+    if (seek_start != 0) {
+      seek_present_us_.store(nowUs() - seek_start);
+      seek_present_hist_->record(seek_present_us_.load());
+      LOG_INFO << "Seek first-present: " << seek_present_us_.load() / 1000.0
+               << " ms";
     }
 
     last_timestamp_ = video_pts;
@@ -375,21 +920,24 @@ void Player::renderLoop() {
       int64_t duration_us = static_cast<int64_t>(getDuration() * AV_TIME_BASE);
       timestamp_cb_(last_timestamp_, duration_us);
     }
-
-    if (delay > 0) {
-      int delay_ms = static_cast<int>(delay * 1000);
-      if (delay_ms > 0) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(delay_ms));
-      }
-    }
   }
   LOG_INFO << "Render thread exiting";
-  updateState(State::Stopped);
+  if (getState() != State::Error) {
+    updateState(State::Stopped);
+  }
 }
 
 void Player::updateState(State new_state) {
   state_.store(new_state);
+  wakeRenderThread();
   if (state_cb_) {
     state_cb_(new_state);
   }
-}
\ No newline at end of file
+}
+
+void Player::wakeRenderThread() {
+  state_event_.notifyAll();
+  if (video_reader_) {
+    video_reader_->wakeWaiters();  // 渲染线程可能正阻塞在帧队列上
+  }
+}
@@ -4,17 +4,28 @@
 #include <GLFW/glfw3.h>
 
 #include <atomic>
+#include <condition_variable>
 #include <cstdint>
 #include <functional>
 #include <memory>
 #include <mutex>
 #include <string>
 #include <thread>
+#include <vector>
+
+#include "degrade_controller.hpp"
+#include "metrics.hpp"
+#include "present_scheduler.hpp"
+#include "wait_event.hpp"
 
 class GLRenderer;
 class AudioPlayer;
+class Demuxer;
 class StreamSource;
 class GLFWwindow;
+namespace utils {
+class MetricsServer;
+}
 
 /**
  * Player: 支持播放控制、跳转、音量控制和回调机制。
@@ -27,6 +38,33 @@ class Player {
   using TimestampCallback =
       std::function<void(int64_t timestamp, int64_t duration)>;
   using StateCallback = std::function<void(State state)>;
+  // seek 完成回调（在 seek 线程中执行）；被更新的请求取代或失败时 success 为 false
+  using SeekCallback = std::function<void(bool success, double timestamp_sec)>;
+
+  // 音视频同步统计
+  struct SyncStats {
+    int degrade_level = 0;        // 当前解码降级等级（见 DegradeController）
+    uint64_t frames_skipped = 0;  // 解码降级跳过的帧数
+    uint64_t frames_dropped = 0;  // 已解码但因过晚未上传显示的帧数
+  };
+
+  // 最近一次 seek 的耗时分解，单位微秒(us)
+  struct SeekStats {
+    int64_t demux_seek_us = 0;        // Demuxer::seek（定位 + 清空数据包队列）
+    int64_t decode_to_target_us = 0;  // 音视频流从关键帧解码到目标帧
+    int64_t first_present_us = 0;     // seek 开始到首帧交给渲染器（暂停时为 0）
+  };
+
+  // 打开后首帧的耗时分解（time-to-first-frame），单位微秒(us)
+  // 前三项在 open() 中测得，后两项从 play() 开始计时
+  struct StartupStats {
+    int64_t open_us = 0;           // avformat_open_input
+    int64_t probe_us = 0;          // 流信息探测（或应用缓存）
+    bool probe_cached = false;     // 流信息来自磁盘缓存
+    int64_t decoder_open_us = 0;   // 音视频解码器打开
+    int64_t first_decode_us = 0;   // play() 到渲染线程取得首帧
+    int64_t first_present_us = 0;  // 取得首帧到交给渲染器
+  };
 
   Player();
   ~Player();
@@ -34,12 +72,19 @@ class Player {
   bool open(const std::string& filename);  // 打开媒体文件
   void close();                            // 关闭并释放资源
 
-  bool play();    // 开始播放
-  void resume();  // 恢复播放
-  void pause();   // 暂停播放
-  void stop();    // 停止播放
+  // 异步 seek 进行中时 play / pause / resume 只改变 seek 完成后的状态
+  bool play();         // 开始播放
+  void resume();       // 恢复播放
+  void pause();        // 暂停播放
+  void togglePause();  // 播放 <-> 暂停；seek 中切换 seek 完成后的状态
+  void stop();         // 停止播放
 
-  bool seek(double timestamp_sec);  // 跳转到指定时间戳（秒）。
+  bool seek(double timestamp_sec);  // 跳转到指定时间戳（秒），阻塞直到完成。
+  // 异步跳转：立即返回，由 seek 线程执行，音视频流并行解码到目标。
+  // 连续请求只执行最新的一个：排队中的旧请求直接作废，执行中的旧请求被取消。
+  // play_after 为 true 时完成后恢复播放
+  void seekAsync(double timestamp_sec, bool play_after = true,
+                 SeekCallback cb = nullptr);
 
   bool isFinished() const noexcept;
 
@@ -47,6 +92,15 @@ class Player {
   double getDuration() const noexcept;          // 获取总时长（秒）。
   double getCurrentTimestamp() const noexcept;  // 获取当前时间戳（秒）。
   GLFWwindow* getWindow() const noexcept;
+  SyncStats getSyncStats() const noexcept;
+  SeekStats getLastSeekStats() const noexcept;
+  StartupStats getStartupStats() const noexcept;
+
+  // 运行指标（队列深度、丢帧 / 晚帧、音画偏差、欠载、解码 / 上传 / seek 耗时）。
+  // 设置环境变量 RTAV_METRICS_PORT=<端口> 时同时在 127.0.0.1 上提供
+  // Prometheus 抓取接口 /metrics
+  std::vector<utils::MetricSample> getMetrics() const;
+  std::string getMetricsText() const;  // Prometheus 文本格式
 
   void setVolume(double norm) noexcept;  // norm: 0.0 ~ 1.0
   double getVolume() const noexcept;
@@ -60,8 +114,31 @@ class Player {
  private:
   void renderLoop();
   void updateState(State new_state);
+  void wakeRenderThread();  // 状态变化后唤醒阻塞中的渲染线程
+  // 以下状态转换的调用方持有 state_mutex_
+  bool playLocked();
+  void pauseLocked();
+  void resumeLocked();
+  // 异步 seek 进行中时记录其完成后的期望状态并返回 true（需持 state_mutex_）
+  bool deferToSeek(bool play_after);
+
+  struct SeekRequest {
+    double timestamp_sec = 0.0;
+    bool play_after = false;
+    SeekCallback cb;
+    uint64_t generation = 0;
+  };
+  void seekLoop();  // seek 线程主循环
+  // 执行一次 seek（调用方持有 seek_exec_mutex_）；cancel() 为真时尽快放弃
+  // measure_present: 记录首帧显示耗时（seek 后会恢复播放时）
+  bool performSeek(double timestamp_sec, const std::function<bool()>& cancel,
+                   bool measure_present = false);
+  void cancelSeeks();  // 作废排队中的请求并取消执行中的 seek
+  void initMetrics();
+  void collectMetrics(std::vector<utils::MetricSample>& out) const;
 
   // 窗口和渲染相关
+  std::shared_ptr<Demuxer> demuxer_;  // 单一读取线程，音视频流共享
   std::unique_ptr<StreamSource> video_reader_;
   std::shared_ptr<StreamSource> audio_reader_;
   std::unique_ptr<GLRenderer> renderer_;
@@ -70,12 +147,60 @@ class Player {
   std::thread render_thread_;
   std::atomic<bool> is_running_{false};
   std::atomic<State> state_{State::Stopped};
-  std::mutex state_mutex_;  // 状态锁
+  std::mutex state_mutex_;  // 串行化 play / pause / resume / stop 与 seek 的转换
+  utils::WaitEvent state_event_;  // 渲染线程等待状态变化 / 音频 EOF
 
   TimestampCallback timestamp_cb_ = nullptr;
   StateCallback state_cb_ = nullptr;
   GLFWkeyfun key_callback_ = nullptr;
 
   int64_t last_timestamp_ = 0;  // 上一次回调的时间戳，单位微秒(us)
-  double last_delay_ = 0.0;     // 上一次回调的延迟，单位秒
+  PresentScheduler present_scheduler_;  // PTS -> 显示时刻（仅渲染线程访问）
+
+  // 视频落后音频时的降级与丢帧（degrade_ 仅渲染线程访问）
+  DegradeController degrade_;
+  std::atomic<bool> degrade_reset_{false};  // seek 后由渲染线程复位控制器
+  std::atomic<uint64_t> frames_dropped_{0};
+  int consecutive_drops_ = 0;
+
+  // seek 耗时统计；seek_start_us_ 非 0 表示等待渲染线程记录首帧时间
+  std::atomic<int64_t> seek_start_us_{0};
+  std::atomic<int64_t> seek_demux_us_{0};
+  std::atomic<int64_t> seek_decode_us_{0};
+  std::atomic<int64_t> seek_present_us_{0};
+
+  // 首帧耗时统计；startup_pending_ 为真表示 open 后尚未显示首帧
+  StartupStats startup_;  // open 阶段的各项，在渲染线程启动前写入
+  std::atomic<bool> startup_pending_{false};
+  std::atomic<int64_t> startup_play_us_{0};  // 首次 play() 的时间，0 为未开始
+  std::atomic<int64_t> first_decode_us_{0};
+  std::atomic<int64_t> first_present_us_{0};
+  int64_t startup_decoded_at_us_ = 0;  // 取得首帧的时间（仅渲染线程访问）
+
+  // 异步 seek：每次请求递增 seek_generation_，执行中的 seek 发现代数变化即放弃
+  std::thread seek_thread_;
+  // 保护 pending_seek_ / seek_pending_ / seek_quit_ / seek_play_after_；
+  // 与 state_mutex_ 同时持有时先取 state_mutex_
+  std::mutex seek_mutex_;
+  std::condition_variable seek_cv_;
+  SeekRequest pending_seek_;
+  bool seek_pending_ = false;
+  bool seek_quit_ = false;
+  std::atomic<uint64_t> seek_generation_{0};
+  std::atomic<bool> seek_in_flight_{false};  // 有排队或执行中的异步 seek
+  bool seek_play_after_ = false;  // 异步 seek 完成后是否恢复播放
+  std::atomic<double> seek_target_sec_{0.0};  // 最新的异步 seek 目标
+  std::mutex seek_exec_mutex_;  // 串行化 seek 的执行（同步、异步与 close）
+
+  // 指标：以下由渲染 / seek 线程直接更新，其余在采集时从各组件读取。
+  // demuxer_ 在 open() 中替换，采集线程通过 demuxer_mutex_ 读取
+  utils::MetricsRegistry metrics_;
+  mutable std::mutex demuxer_mutex_;
+  utils::Counter* frames_presented_metric_ = nullptr;
+  utils::Counter* frames_late_metric_ = nullptr;
+  utils::Gauge* av_drift_metric_ = nullptr;
+  utils::LatencyHistogram* av_drift_hist_ = nullptr;
+  utils::LatencyHistogram* seek_hist_ = nullptr;
+  utils::LatencyHistogram* seek_present_hist_ = nullptr;
+  std::unique_ptr<utils::MetricsServer> metrics_server_;
 };
\ No newline at end of file
@@ -0,0 +1,24 @@
+#include "present_scheduler.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+int64_t PresentScheduler::deadlineFor(int64_t pts_us, int64_t master_clock_us,
+                                      int64_t now_us) {
+  if (master_clock_us != NO_CLOCK) {
+    const double observed = static_cast<double>(now_us - master_clock_us);
+    if (!anchored_ || std::fabs(observed - offset_us_) > RESYNC_US) {
+      offset_us_ = observed;
+      anchored_ = true;
+    } else {
+      offset_us_ += (observed - offset_us_) * CORRECTION_GAIN;
+    }
+  } else if (!anchored_ ||
+             pts_us + static_cast<int64_t>(offset_us_) < now_us - RESYNC_US) {
+    // 以视频自身为时钟：首帧或暂停恢复后（deadline 已远在过去）重新锚定
+    offset_us_ = static_cast<double>(now_us - pts_us);
+    anchored_ = true;
+  }
+  const int64_t deadline = pts_us + std::llround(offset_us_);
+  return std::min(deadline, now_us + MAX_AHEAD_US);
+}
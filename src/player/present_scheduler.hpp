@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+
+/**
+ * PresentScheduler: 把视频帧 PTS 换算为单调时钟上的绝对显示时刻（deadline）。
+ * 主时钟（音频时钟）按音频回调的粒度跳变，直接用 now + (pts - clock) 会把
+ * 时钟的台阶抖动带到每一帧上。这里维护 "单调时钟 - 媒体时间" 的偏移量，
+ * 每帧用新的观测值做小步修正；观测值与偏移量相差超过 RESYNC_US（暂停恢复、
+ * seek、时钟跳变）时直接重新锚定。没有主时钟时以首帧锚定，按 PTS 间隔显示。
+ * 只在渲染线程中使用，不做同步。
+ */
+class PresentScheduler {
+ public:
+  static constexpr int64_t NO_CLOCK = std::numeric_limits<int64_t>::min();
+
+  // pts_us / master_clock_us 为媒体时间，now_us 为单调时钟（均为微秒）；
+  // 没有主时钟时 master_clock_us 传 NO_CLOCK。返回该帧的显示时刻
+  int64_t deadlineFor(int64_t pts_us, int64_t master_clock_us, int64_t now_us);
+
+  void reset() { anchored_ = false; }  // seek 后重新锚定
+
+ private:
+  static constexpr int64_t RESYNC_US = 100000;     // 偏差超过 100ms 重新锚定
+  static constexpr int64_t MAX_AHEAD_US = 1000000;  // deadline 最多在 1s 之后
+  static constexpr double CORRECTION_GAIN = 0.05;   // 每帧修正观测偏差的 5%
+
+  bool anchored_ = false;
+  double offset_us_ = 0.0;  // 单调时钟 - 媒体时间
+};
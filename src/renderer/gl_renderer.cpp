@@ -1,9 +1,20 @@
 #define GL_SILENCE_DEPRECATION
 #include "gl_renderer.hpp"
 
+#include <algorithm>
+#include <cerrno>
 #include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+#ifdef __linux__
+#include <time.h>
+#endif
 
 #include "utils/logger.hpp"
+#include "utils/trace.hpp"
+#include "yuv_copy.hpp"
 
 using namespace utils;
 
@@ -42,8 +53,50 @@ void main() {
 }
 )";
 
-GLRenderer::GLRenderer(size_t max_queue_size)
-    : max_queue_size_(max_queue_size) {}
+// 上传耗时 / 显示误差日志间隔（帧）
+static const uint64_t UPLOAD_LOG_INTERVAL = 300;
+// 距目标 vblank 不足该时长时已来不及绘制并交换，视为错过该 vblank
+static const int64_t SWAP_MARGIN_US = 2000;
+// 超过该时长的保持（暂停、卡顿）不计入保持时长统计
+static const int64_t MAX_HOLD_US = 500000;
+// 距 deadline 不足该时长时不再用条件变量等待（唤醒延迟可达毫秒级），
+// 改为按绝对时刻睡眠
+static const int64_t PRECISE_WAIT_US = 2000;
+
+// 单调时钟，单位微秒(us)；与 Player 的时间基准相同
+static int64_t nowUs() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// 睡眠到单调时钟的绝对时刻 deadline_us
+static void sleepUntilUs(int64_t deadline_us) {
+#ifdef __linux__
+  // steady_clock 即 CLOCK_MONOTONIC；TIMER_ABSTIME 不会因被信号打断或
+  // 重新计算相对时长而累积误差
+  timespec ts;
+  ts.tv_sec = static_cast<time_t>(deadline_us / 1000000);
+  ts.tv_nsec = static_cast<long>(deadline_us % 1000000) * 1000;
+  while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) ==
+         EINTR) {
+  }
+#else
+  std::this_thread::sleep_until(std::chrono::steady_clock::time_point(
+      std::chrono::microseconds(deadline_us)));
+#endif
+}
+
+GLRenderer::GLRenderer() {
+  const char* env = std::getenv("RTAV_DISABLE_PBO");
+  if (env && env[0] != '\0' && env[0] != '0') {
+    pbo_enabled_ = false;
+  }
+  env = std::getenv("RTAV_VSYNC");
+  if (env && env[0] == '0') {
+    vsync_enabled_ = false;
+  }
+}
 
 GLRenderer::~GLRenderer() {
   stop();
@@ -83,6 +136,11 @@ bool GLRenderer::start(int width, int height) {
     return false;
   }
 
+  // 显示模式只能在主线程查询；渲染线程再用实测的交换间隔修正
+  const GLFWvidmode* mode = glfwGetVideoMode(glfwGetPrimaryMonitor());
+  nominal_interval_us_ =
+      (mode && mode->refreshRate > 0) ? 1000000 / mode->refreshRate : 0;
+
   // 创建渲染线程
   running_.store(true);
   render_thread_ = std::thread(&GLRenderer::renderLoop, this);
@@ -97,8 +155,11 @@ void GLRenderer::stop() {
   }
 
   // 停止渲染线程
-  running_.store(false);
-  queue_cv_.notify_all();
+  {
+    std::lock_guard<std::mutex> lock(frame_mutex_);
+    running_.store(false);
+  }
+  frame_cv_.notify_all();
   if (render_thread_.joinable()) {
     render_thread_.join();
   }
@@ -113,23 +174,28 @@ void GLRenderer::stop() {
   LOG_INFO << "Renderer stopped";
 }
 
-bool GLRenderer::enqueueFrame(std::shared_ptr<AVFrame> frame) {
-  std::unique_lock<std::mutex> lock(queue_mutex_);
-  if (frame_queue_.size() >= max_queue_size_) {
-    LOG_WARN << "Frame queue is full, dropping frame with PTS: " << frame->pts;
-    frame_queue_.pop_front();  // 移除最旧帧
+bool GLRenderer::presentAt(FramePtr frame, int64_t deadline_us) {
+  if (!frame) return false;
+  std::unique_lock<std::mutex> lock(frame_mutex_);
+  const uint64_t generation = frame_generation_;
+  frame_cv_.wait(lock, [this, generation] {
+    return !pending_frame_ || !running_.load() ||
+           frame_generation_ != generation;
+  });
+  if (!running_.load() || frame_generation_ != generation) {
+    return false;  // frame 析构时归还帧池
   }
-  frame_queue_.push_back(frame);
-  queue_cv_.notify_one();  // 通知渲染线程
+  pending_frame_ = std::move(frame);
+  pending_deadline_us_ = deadline_us;
+  frame_cv_.notify_all();  // 通知渲染线程
   return true;
 }
 
 void GLRenderer::clearFrames() {
-  std::lock_guard<std::mutex> lock(queue_mutex_);
-  while (!frame_queue_.empty()) {
-    frame_queue_.pop_front();
-  }
-  queue_cv_.notify_all();  // 通知渲染线程
+  std::lock_guard<std::mutex> lock(frame_mutex_);
+  pending_frame_.reset();
+  ++frame_generation_;
+  frame_cv_.notify_all();  // 唤醒渲染线程和阻塞在 presentAt() 的调用方
 }
 
 void GLRenderer::requestResize(int width, int height) {
@@ -137,10 +203,11 @@ void GLRenderer::requestResize(int width, int height) {
   resize_width_ = width;
   resize_height_ = height;
   resize_pending_ = true;
-  queue_cv_.notify_one();  // 通知渲染线程
+  frame_cv_.notify_all();  // 通知渲染线程
 }
 
 void GLRenderer::renderLoop() {
+  TRACE_THREAD_NAME("gl render");
   // 在渲染线程中初始化 OpenGL 上下文
   if (!initContext(width_, height_)) {  // 默认大小，稍后会根据窗口调整
     LOG_ERROR << "Failed to initialize OpenGL context";
@@ -158,25 +225,52 @@ void GLRenderer::renderLoop() {
   LOG_INFO << "Entering render loop";
 
   while (running_.load()) {
-    std::shared_ptr<AVFrame> frame;
+    FramePtr frame;
+    int64_t deadline_us = 0;
+    uint64_t generation = 0;
     {
-      std::unique_lock<std::mutex> lock(queue_mutex_);
+      std::unique_lock<std::mutex> lock(frame_mutex_);
       // 等待帧或停止信号
-      queue_cv_.wait(
-          lock, [this] { return !frame_queue_.empty() || !running_.load(); });
+      frame_cv_.wait(lock,
+                     [this] { return pending_frame_ || !running_.load(); });
 
       if (!running_.load()) {
         break;  // 退出如果停止
       }
-
-      if (!frame_queue_.empty()) {
-        frame = frame_queue_.front();
-        frame_queue_.pop_front();
+      frame = std::move(pending_frame_);
+      deadline_us = pending_deadline_us_;
+      generation = frame_generation_;
+    }
+    frame_cv_.notify_all();  // 槽位已空，调用方可以放入下一帧
+
+    int64_t wake_us = deadline_us;  // 发出交换的时刻
+    if (vsync_enabled_ && vsync_.hasPhase()) {
+      // 交换在下一个 vblank 生效：对齐到离 deadline 最近的 vblank，并提前
+      // 半个周期发出，两侧都留有余量
+      const int64_t slot_us = vsync_.slotFor(deadline_us);
+      wake_us = slot_us - vsync_.interval() / 2;
+      bool has_newer;
+      {
+        std::lock_guard<std::mutex> lock(frame_mutex_);
+        has_newer = pending_frame_ != nullptr;
+      }
+      // 上传前判断：按上传耗时的 p95 估计上传完成时刻，赶不上目标 vblank
+      // 时丢弃而不是在下一个刷新周期中途顶替，也省掉这一帧的上传
+      if (has_newer &&
+          nowUs() + upload_hist_.snapshot().p95 > slot_us - SWAP_MARGIN_US) {
+        frame.reset();
+        vsync_drops_.fetch_add(1, std::memory_order_relaxed);
+        TRACE_INSTANT("vsync drop");
+        continue;
       }
     }
 
-    if (frame) {
-      updateTexture(frame.get());
+    // 先上传，再等待显示时刻：上传耗时不计入显示延迟
+    updateTexture(frame->frame);
+    frame.reset();  // 纹理已更新，帧尽早归还帧池
+
+    if (!waitForDeadline(wake_us, generation)) {
+      continue;  // 停止或帧被 clearFrames() 作废
     }
 
     // 处理窗口大小调整请求
@@ -192,49 +286,101 @@ void GLRenderer::renderLoop() {
       }
     }
 
-    // 渲染当前帧
-    glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
-    glClear(GL_COLOR_BUFFER_BIT);
-
-    if (frame) {
-      // 根据渲染模式调整视口
-      int win_w, win_h;
-      glfwGetFramebufferSize(window_, &win_w, &win_h);
-      float win_aspect = static_cast<float>(win_w) / win_h;
-      float tex_aspect = static_cast<float>(tex_width_) / tex_height_;
-
-      int view_w = win_w;
-      int view_h = win_h;
-      if (render_mode_ == RenderMode::KeepAspectRatio) {
-        if (win_aspect > tex_aspect) {
-          view_w = static_cast<int>(win_h * tex_aspect);
-        } else {
-          view_h = static_cast<int>(win_w / tex_aspect);
-        }
+    drawFrame();
+    {
+      TRACE_SCOPE("glfwSwapBuffers");
+      glfwSwapBuffers(window_);
+      if (vsync_enabled_) {
+        // 部分驱动在下一次 GL 调用时才阻塞；等交换完成，返回时刻即 vblank
+        glFinish();
       }
-      int view_x = (win_w - view_w) / 2;
-      int view_y = (win_h - view_h) / 2;
-      glViewport(view_x, view_y, view_w, view_h);
-
-      // 绘制纹理
-      glUseProgram(shader_program_);
-      glActiveTexture(GL_TEXTURE0);
-      glBindTexture(GL_TEXTURE_2D, tex_y_);
-      glActiveTexture(GL_TEXTURE1);
-      glBindTexture(GL_TEXTURE_2D, tex_u_);
-      glActiveTexture(GL_TEXTURE2);
-      glBindTexture(GL_TEXTURE_2D, tex_v_);
-      glBindVertexArray(vao_);
-      glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
     }
-    glfwSwapBuffers(window_);
+    const int64_t swap_us = nowUs();
+    if (vsync_enabled_) {
+      vsync_.onSwap(swap_us);
+      refresh_interval_us_.store(vsync_.interval());
+    }
+    present_error_hist_.record(std::llabs(swap_us - deadline_us));
+    if (last_present_us_ != 0 && swap_us - last_present_us_ < MAX_HOLD_US) {
+      hold_hist_.record(swap_us - last_present_us_);
+    }
+    last_present_us_ = swap_us;
     glfwPollEvents();
+
+    if (++presents_since_log_ >= UPLOAD_LOG_INTERVAL) {
+      presents_since_log_ = 0;
+      auto error = present_error_hist_.snapshot();
+      auto hold = hold_hist_.snapshot();
+      LOG_INFO << "Present error vs deadline: mean=" << error.mean
+               << "us p95=" << error.p95 << "us max=" << error.max
+               << "us; frame hold p50=" << hold.p50 << "us p95=" << hold.p95
+               << "us; refresh=" << refresh_interval_us_.load()
+               << "us vsync drops=" << vsync_drops_.load();
+    }
   }
 
   // 清理 OpenGL 资源和上下文
   shutdownContext();
 }
 
+bool GLRenderer::waitForDeadline(int64_t deadline_us, uint64_t generation) {
+  TRACE_SCOPE("wait present deadline");
+  auto invalidated = [this, generation] {
+    return !running_.load() || frame_generation_ != generation;
+  };
+  {
+    // 大部分时间在条件变量上等待，stop() / clearFrames() 可以立即打断
+    std::unique_lock<std::mutex> lock(frame_mutex_);
+    const auto coarse = std::chrono::steady_clock::time_point(
+        std::chrono::microseconds(deadline_us - PRECISE_WAIT_US));
+    frame_cv_.wait_until(lock, coarse, invalidated);
+    if (invalidated()) return false;
+  }
+  // 最后一小段按绝对时刻睡眠，不受条件变量唤醒延迟影响
+  if (deadline_us > nowUs()) {
+    sleepUntilUs(deadline_us);
+  }
+  return true;
+}
+
+void GLRenderer::drawFrame() {
+  glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+  glClear(GL_COLOR_BUFFER_BIT);
+  if (tex_width_ <= 0 || tex_height_ <= 0) {
+    return;  // 还没有上传过帧
+  }
+
+  // 根据渲染模式调整视口
+  int win_w, win_h;
+  glfwGetFramebufferSize(window_, &win_w, &win_h);
+  float win_aspect = static_cast<float>(win_w) / win_h;
+  float tex_aspect = static_cast<float>(tex_width_) / tex_height_;
+
+  int view_w = win_w;
+  int view_h = win_h;
+  if (render_mode_ == RenderMode::KeepAspectRatio) {
+    if (win_aspect > tex_aspect) {
+      view_w = static_cast<int>(win_h * tex_aspect);
+    } else {
+      view_h = static_cast<int>(win_w / tex_aspect);
+    }
+  }
+  int view_x = (win_w - view_w) / 2;
+  int view_y = (win_h - view_h) / 2;
+  glViewport(view_x, view_y, view_w, view_h);
+
+  // 绘制纹理
+  glUseProgram(shader_program_);
+  glActiveTexture(GL_TEXTURE0);
+  glBindTexture(GL_TEXTURE_2D, tex_y_);
+  glActiveTexture(GL_TEXTURE1);
+  glBindTexture(GL_TEXTURE_2D, tex_u_);
+  glActiveTexture(GL_TEXTURE2);
+  glBindTexture(GL_TEXTURE_2D, tex_v_);
+  glBindVertexArray(vao_);
+  glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+}
+
 bool GLRenderer::initContext(int width, int height) {
   // 在此线程中使 OpenGL 上下文当前
   glfwMakeContextCurrent(window_);
@@ -246,6 +392,19 @@ bool GLRenderer::initContext(int width, int height) {
     return false;
   }
 
+  // 开启垂直同步后交换在 vblank 生效，显示节奏由 VsyncClock 对齐
+  glfwSwapInterval(vsync_enabled_ ? 1 : 0);
+  if (vsync_enabled_) {
+    vsync_.setNominalInterval(nominal_interval_us_);
+    vsync_.resetPhase();
+    refresh_interval_us_.store(vsync_.interval());
+    LOG_INFO << "VSync on, refresh interval " << vsync_.interval() << "us"
+             << (nominal_interval_us_ > 0 ? "" : " (assumed)");
+  } else {
+    refresh_interval_us_.store(0);
+    LOG_INFO << "VSync off";
+  }
+
   // 设置视口
   glViewport(0, 0, width, height);
   return true;
@@ -312,6 +471,13 @@ void GLRenderer::shutdownContext() {
     glDeleteTextures(1, &tex_v_);
     tex_v_ = 0;
   }
+  if (pbos_[0]) {
+    glDeleteBuffers(PBO_COUNT, pbos_);
+    std::fill(std::begin(pbos_), std::end(pbos_), 0);
+  }
+  tex_width_ = 0;
+  tex_height_ = 0;
+  tex_format_ = -1;
   if (shader_program_) {
     glDeleteProgram(shader_program_);
     shader_program_ = 0;
@@ -417,16 +583,131 @@ bool GLRenderer::initTexture() {
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
   glBindTexture(GL_TEXTURE_2D, 0);  // 解绑
+
+  // 纹理存储在收到第一帧时按帧尺寸分配；这里只创建 PBO 对象
+  glGenBuffers(PBO_COUNT, pbos_);
+  for (GLuint pbo : pbos_) {
+    if (!pbo) {
+      LOG_WARN << "Failed to generate PBOs, falling back to direct upload";
+      pbo_enabled_ = false;
+      break;
+    }
+  }
   return true;
 }
 
 void GLRenderer::updateTexture(AVFrame* frame) {
   if (!frame) return;
+  TRACE_SCOPE("updateTexture");
   if (frame->format != AV_PIX_FMT_YUV420P) {
     LOG_WARN << "Unsupported pixel format: " << frame->format;
     return;
   }
 
+  auto start = std::chrono::steady_clock::now();
+  ensureTextureStorage(frame->width, frame->height, frame->format);
+  bool use_pbo = pbo_enabled_.load();
+  if (!use_pbo || !uploadWithPbo(frame)) {
+    uploadDirect(frame);
+  }
+  auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start);
+  upload_hist_.record(elapsed.count());
+
+  if (++uploads_since_log_ >= UPLOAD_LOG_INTERVAL) {
+    uploads_since_log_ = 0;
+    auto stats = upload_hist_.snapshot();
+    LOG_INFO << "Texture upload (" << (use_pbo ? "pbo" : "direct") << ", "
+             << tex_width_ << "x" << tex_height_ << "): frames=" << stats.count
+             << " mean=" << stats.mean << "us p50=" << stats.p50
+             << "us p95=" << stats.p95 << "us p99=" << stats.p99
+             << "us max=" << stats.max << "us";
+  }
+}
+
+void GLRenderer::ensureTextureStorage(int width, int height, int format) {
+  if (width == tex_width_ && height == tex_height_ && format == tex_format_) {
+    return;
+  }
+
+  int half_w = (width + 1) / 2;
+  int half_h = (height + 1) / 2;
+  glBindTexture(GL_TEXTURE_2D, tex_y_);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, width, height, 0, GL_RED,
+               GL_UNSIGNED_BYTE, nullptr);
+  glBindTexture(GL_TEXTURE_2D, tex_u_);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, half_w, half_h, 0, GL_RED,
+               GL_UNSIGNED_BYTE, nullptr);
+  glBindTexture(GL_TEXTURE_2D, tex_v_);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, half_w, half_h, 0, GL_RED,
+               GL_UNSIGNED_BYTE, nullptr);
+  glBindTexture(GL_TEXTURE_2D, 0);
+
+  tex_width_ = width;
+  tex_height_ = height;
+  tex_format_ = format;
+  // PBO 每帧以 glBufferData 重新指定存储，尺寸变化后自动按新大小分配
+  pbo_size_ = static_cast<size_t>(width) * height +
+              2 * static_cast<size_t>(half_w) * half_h;
+  upload_hist_.reset();
+  uploads_since_log_ = 0;
+  LOG_INFO << "Allocated YUV420P textures: " << width << "x" << height;
+}
+
+bool GLRenderer::uploadWithPbo(const AVFrame* frame) {
+  const int width = frame->width;
+  const int height = frame->height;
+  const int half_w = (width + 1) / 2;
+  const int half_h = (height + 1) / 2;
+  const size_t y_size = static_cast<size_t>(width) * height;
+  const size_t c_size = static_cast<size_t>(half_w) * half_h;
+
+  GLuint pbo = pbos_[pbo_index_];
+  pbo_index_ = (pbo_index_ + 1) % PBO_COUNT;
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo);
+  // 孤立旧存储：驱动为本帧分配新内存，不必等待仍在进行的上一次传输
+  glBufferData(GL_PIXEL_UNPACK_BUFFER, pbo_size_, nullptr, GL_STREAM_DRAW);
+  auto* dst = static_cast<uint8_t*>(glMapBufferRange(
+      GL_PIXEL_UNPACK_BUFFER, 0, pbo_size_,
+      GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+  if (!dst) {
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    LOG_WARN << "glMapBufferRange failed, disabling PBO upload";
+    pbo_enabled_ = false;
+    return false;
+  }
+
+  packYuv420p(dst, frame);
+  if (glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) != GL_TRUE) {
+    // 缓冲内容在映射期间失效（极少见），本帧改为直接上传
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    return false;
+  }
+
+  // 从 PBO 偏移处上传，调用立即返回，实际传输由驱动异步完成
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  glActiveTexture(GL_TEXTURE0);
+  glBindTexture(GL_TEXTURE_2D, tex_y_);
+  glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RED,
+                  GL_UNSIGNED_BYTE, reinterpret_cast<const void*>(0));
+  glActiveTexture(GL_TEXTURE1);
+  glBindTexture(GL_TEXTURE_2D, tex_u_);
+  glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, half_w, half_h, GL_RED,
+                  GL_UNSIGNED_BYTE, reinterpret_cast<const void*>(y_size));
+  glActiveTexture(GL_TEXTURE2);
+  glBindTexture(GL_TEXTURE_2D, tex_v_);
+  glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, half_w, half_h, GL_RED,
+                  GL_UNSIGNED_BYTE,
+                  reinterpret_cast<const void*>(y_size + c_size));
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+  return true;
+}
+
+void GLRenderer::uploadDirect(const AVFrame* frame) {
+  const int half_w = (frame->width + 1) / 2;
+  const int half_h = (frame->height + 1) / 2;
+
   // Ensure unpack alignment = 1 to avoid stride/padding issues
   glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 
@@ -434,29 +715,37 @@ void GLRenderer::updateTexture(AVFrame* frame) {
   glActiveTexture(GL_TEXTURE0);
   glBindTexture(GL_TEXTURE_2D, tex_y_);
   glPixelStorei(GL_UNPACK_ROW_LENGTH, frame->linesize[0]);
-
-  glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, frame->width, frame->height, 0, GL_RED,
-               GL_UNSIGNED_BYTE, frame->data[0]);
-  glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+  glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, frame->width, frame->height, GL_RED,
+                  GL_UNSIGNED_BYTE, frame->data[0]);
 
   // U 平面 (半分辨率)
-  int half_w = (frame->width + 1) / 2;
-  int half_h = (frame->height + 1) / 2;
   glActiveTexture(GL_TEXTURE1);
   glBindTexture(GL_TEXTURE_2D, tex_u_);
   glPixelStorei(GL_UNPACK_ROW_LENGTH, frame->linesize[1]);
-  glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, half_w, half_h, 0, GL_RED,
-               GL_UNSIGNED_BYTE, frame->data[1]);
-  glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+  glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, half_w, half_h, GL_RED,
+                  GL_UNSIGNED_BYTE, frame->data[1]);
 
   // V 平面 (半分辨率)
   glActiveTexture(GL_TEXTURE2);
   glBindTexture(GL_TEXTURE_2D, tex_v_);
   glPixelStorei(GL_UNPACK_ROW_LENGTH, frame->linesize[2]);
-  glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, half_w, half_h, 0, GL_RED,
-               GL_UNSIGNED_BYTE, frame->data[2]);
-  glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+  glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, half_w, half_h, GL_RED,
+                  GL_UNSIGNED_BYTE, frame->data[2]);
 
-  // Restore default unpack alignment
+  // Restore default unpack state
+  glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
   glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
-}
\ No newline at end of file
+}
+
+GLRenderer::UploadStats GLRenderer::getUploadStats() const {
+  auto snap = upload_hist_.snapshot();
+  UploadStats stats;
+  stats.frames = snap.count;
+  stats.mean_us = snap.mean;
+  stats.p50_us = snap.p50;
+  stats.p95_us = snap.p95;
+  stats.p99_us = snap.p99;
+  stats.max_us = snap.max;
+  stats.pbo = pbo_enabled_.load();
+  return stats;
+}
@@ -5,7 +5,7 @@
 
 #include <atomic>
 #include <condition_variable>
-#include <deque>
+#include <cstdint>
 #include <memory>
 #include <mutex>
 #include <thread>
@@ -14,25 +14,66 @@ extern "C" {
 #include "libavutil/frame.h"
 }
 
+#include "frame_pool.hpp"
+#include "latency_histogram.hpp"
+#include "vsync_clock.hpp"
+
 /**
  * GLRenderer: 封装 OpenGL 渲染器，用于实时视频帧渲染。
  * 支持帧队列管理、线程安全渲染和窗口调整。
  * 使用 GLFW 和 GLEW 处理窗口和图形资源。
+ * 纹理存储只在尺寸 / 格式变化时重新分配；每帧数据经 PBO 环（孤立旧存储）
+ * 以 glTexSubImage2D 异步上传，本帧的拷贝与上一帧的 GPU 传输 / 绘制重叠。
+ * 帧按绝对显示时刻（deadline）呈现：渲染线程收到帧后立即上传纹理，
+ * 再等到 deadline 才绘制并交换缓冲，上传耗时不再推迟显示时刻。
+ * 默认开启垂直同步：deadline 对齐到最近的 vblank（24p@60Hz 为 3:2 节奏），
+ * 赶不上目标 vblank 且已有更新的帧待显示时丢弃该帧，不在刷新周期中间上屏。
  */
 class GLRenderer {
  public:
   enum class RenderMode { Normal, Stretch, KeepAspectRatio };
 
-  explicit GLRenderer(size_t max_queue_size = 5);
+  // 纹理上传耗时统计（渲染线程 CPU 侧，单位微秒）
+  struct UploadStats {
+    uint64_t frames = 0;
+    double mean_us = 0.0;
+    int64_t p50_us = 0;
+    int64_t p95_us = 0;
+    int64_t p99_us = 0;
+    int64_t max_us = 0;
+    bool pbo = false;  // 当前是否使用 PBO 上传
+  };
+
+  GLRenderer();
   ~GLRenderer();
 
   bool start(int width, int height);  // 启动渲染器：创建窗口和渲染线程。
   void stop();
 
-  bool enqueueFrame(std::shared_ptr<AVFrame> frame);
-  void clearFrames();
+  // 帧句柄移交给渲染线程，在 deadline_us（单调时钟，微秒）时显示，上传完成
+  // 后归还到解码端的帧池。只有一个待显示槽位：上一帧尚未被渲染线程取走时
+  // 阻塞；渲染器停止或帧被 clearFrames() 丢弃时返回 false
+  bool presentAt(FramePtr frame, int64_t deadline_us);
+  void clearFrames();  // 丢弃待显示帧，并打断渲染线程对 deadline 的等待
   void requestResize(int width, int height);
   void setRenderMode(RenderMode mode) { render_mode_ = mode; }
+  // 关闭后直接从帧内存上传（用于对比；也可设置环境变量 RTAV_DISABLE_PBO=1）
+  void setPboUploadEnabled(bool enabled) { pbo_enabled_ = enabled; }
+  UploadStats getUploadStats() const;
+  utils::LatencyHistogram::Snapshot getUploadLatency() const {
+    return upload_hist_.snapshot();
+  }
+  // 实际上屏时刻（SwapBuffers 返回）与 deadline 之差的绝对值（微秒）
+  utils::LatencyHistogram::Snapshot getPresentError() const {
+    return present_error_hist_.snapshot();
+  }
+  // 每帧在屏幕上的保持时长（相邻两次上屏的间隔，微秒）
+  utils::LatencyHistogram::Snapshot getFrameHold() const {
+    return hold_hist_.snapshot();
+  }
+  // 估计的刷新周期（微秒），关闭垂直同步时为 0
+  int64_t getRefreshInterval() const { return refresh_interval_us_.load(); }
+  uint64_t getVsyncDrops() const { return vsync_drops_.load(); }
 
   bool isRunning() const { return running_.load(); }
   GLFWwindow* window() const { return window_; }
@@ -45,8 +86,15 @@ class GLRenderer {
   bool initResources();                     // 初始化着色器、纹理等。
   bool initShaders();
   bool initTexture();
+  // 等到 deadline_us；期间 stop() 或 clearFrames() 使帧作废时返回 false
+  bool waitForDeadline(int64_t deadline_us, uint64_t generation);
+  void drawFrame();  // 以当前纹理绘制一帧
 
   void updateTexture(AVFrame* frame);  // 更新纹理：从 AVFrame 更新 YUV 纹理。
+  // 尺寸或格式变化时重新分配纹理存储
+  void ensureTextureStorage(int width, int height, int format);
+  bool uploadWithPbo(const AVFrame* frame);  // 经 PBO 上传，失败返回 false
+  void uploadDirect(const AVFrame* frame);   // 直接从帧内存上传
 
   // 窗口与渲染参数
   GLFWwindow* window_{nullptr};                 // GLFW 窗口
@@ -60,12 +108,13 @@ class GLRenderer {
   GLuint tex_u_{0};                             // U 纹理
   GLuint tex_v_{0};                             // V 纹理
 
-  // 渲染线程与队列
+  // 渲染线程与待显示帧
   std::thread render_thread_;                         // 渲染线程
-  std::mutex queue_mutex_;                            // 队列锁
-  std::condition_variable queue_cv_;                  // 队列条件变量
-  std::deque<std::shared_ptr<AVFrame>> frame_queue_;  // 帧队列
-  size_t max_queue_size_{5};                          // 最大队列大小
+  std::mutex frame_mutex_;                            // 待显示帧锁
+  std::condition_variable frame_cv_;                  // 待显示帧条件变量
+  FramePtr pending_frame_;          // 待渲染线程取走的帧（单槽）
+  int64_t pending_deadline_us_{0};  // 该帧的显示时刻
+  uint64_t frame_generation_{0};    // clearFrames() 递增，作废已取走的帧
   std::atomic<bool> running_{false};                  // 运行状态
 
   // resize 请求
@@ -77,6 +126,27 @@ class GLRenderer {
   // 纹理和着色器
   int tex_width_{0};   // 纹理宽度
   int tex_height_{0};  // 纹理高度
+  int tex_format_{-1};  // 纹理对应的像素格式（AVPixelFormat）
+
+  // PBO 上传环
+  static constexpr int PBO_COUNT = 3;
+  GLuint pbos_[PBO_COUNT]{};     // 像素解包缓冲
+  size_t pbo_size_{0};           // 一帧 YUV 数据的字节数
+  int pbo_index_{0};             // 下一次使用的 PBO
+  std::atomic<bool> pbo_enabled_{true};
+  utils::LatencyHistogram upload_hist_;  // 每帧上传耗时
+  uint64_t uploads_since_log_{0};
+  utils::LatencyHistogram present_error_hist_;  // 显示时刻误差
+  uint64_t presents_since_log_{0};
+
+  // 垂直同步节奏（vsync_ / last_present_us_ 仅渲染线程访问）
+  bool vsync_enabled_{true};        // RTAV_VSYNC=0 关闭
+  int64_t nominal_interval_us_{0};  // 显示模式给出的刷新周期，0 为未知
+  VsyncClock vsync_;
+  int64_t last_present_us_{0};      // 上一帧上屏时刻
+  utils::LatencyHistogram hold_hist_;  // 每帧保持时长
+  std::atomic<int64_t> refresh_interval_us_{0};
+  std::atomic<uint64_t> vsync_drops_{0};  // 赶不上 vblank 而丢弃的帧
 
   // 着色器源码
   static const char* VERTEX_SHADER_SOURCE;
@@ -0,0 +1,39 @@
+#include "vsync_clock.hpp"
+
+#include <cmath>
+
+void VsyncClock::setNominalInterval(int64_t interval_us) {
+  interval_us_ = static_cast<double>(
+      interval_us > 0 ? interval_us : DEFAULT_INTERVAL_US);
+}
+
+void VsyncClock::onSwap(int64_t swap_us) {
+  if (last_vblank_us_ != 0 && swap_us > last_vblank_us_) {
+    // 两次交换之间可能隔了若干个刷新周期，换算为单个周期再修正
+    const double elapsed = static_cast<double>(swap_us - last_vblank_us_);
+    const double periods = std::round(elapsed / interval_us_);
+    if (periods >= 1.0 && periods <= 8.0) {
+      const double measured = elapsed / periods;
+      if (std::fabs(measured - interval_us_) <
+          interval_us_ * MAX_INTERVAL_ERROR) {
+        interval_us_ += (measured - interval_us_) * CORRECTION_GAIN;
+      }
+    }
+  }
+  last_vblank_us_ = swap_us;
+}
+
+int64_t VsyncClock::slotFor(int64_t deadline_us) {
+  const double pos =
+      static_cast<double>(deadline_us - last_vblank_us_) / interval_us_;
+  const double lower = std::floor(pos);
+  const double frac = pos - lower;
+  double slots;
+  if (std::fabs(frac - 0.5) < TIE_BAND) {
+    if (tie_dir_ == 0) tie_dir_ = frac >= 0.5 ? 1 : -1;
+    slots = tie_dir_ > 0 ? lower + 1.0 : lower;
+  } else {
+    slots = std::round(pos);
+  }
+  return last_vblank_us_ + static_cast<int64_t>(slots * interval_us_);
+}
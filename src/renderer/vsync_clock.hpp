@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * VsyncClock: 跟踪显示器的刷新间隔与 vblank 相位。
+ * 刷新间隔先取显示模式给出的标称值，再用开启垂直同步后 SwapBuffers 返回
+ * 时刻的间隔修正（返回时刻即 vblank 的近似值）；最近一次返回时刻作为相位。
+ * slotFor() 把帧的显示时刻对齐到最近的 vblank，24p 在 60Hz 上自然得到
+ * 3:2 的稳定节奏，而不是按 deadline 落在刷新周期中间的不规则保持时长。
+ * 只在渲染线程中使用，不做同步。
+ */
+class VsyncClock {
+ public:
+  void setNominalInterval(int64_t interval_us);
+  void onSwap(int64_t swap_us);  // SwapBuffers 返回时刻（单调时钟，微秒）
+  void resetPhase() {
+    last_vblank_us_ = 0;
+    tie_dir_ = 0;
+  }
+
+  bool hasPhase() const { return last_vblank_us_ != 0; }
+  int64_t interval() const { return static_cast<int64_t>(interval_us_); }
+  // 离 deadline_us 最近的 vblank 时刻；需要 hasPhase()。deadline 几乎落在
+  // 两个 vblank 正中时沿用上一次的取舍方向，避免 3:2 节奏来回翻转成 2:3
+  int64_t slotFor(int64_t deadline_us);
+
+ private:
+  // 测得间隔与估计值相差超过 10% 时不用于修正（丢帧、合成器抖动等）
+  static constexpr double MAX_INTERVAL_ERROR = 0.1;
+  static constexpr double CORRECTION_GAIN = 0.02;
+  static constexpr int64_t DEFAULT_INTERVAL_US = 16667;  // 60Hz
+  static constexpr double TIE_BAND = 0.1;  // 距正中 10% 周期以内视为居中
+
+  double interval_us_ = DEFAULT_INTERVAL_US;
+  int64_t last_vblank_us_ = 0;
+  int tie_dir_ = 0;  // 居中时的取舍：1 取后一个 vblank，-1 取前一个，0 未定
+};
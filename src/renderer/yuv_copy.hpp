@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+extern "C" {
+#include "libavutil/frame.h"
+}
+
+// 将一个平面去掉行填充后紧密拷贝到 dst
+inline void copyPlane(uint8_t* dst, const uint8_t* src, int src_linesize,
+                      int width, int height) {
+  if (src_linesize == width) {
+    std::memcpy(dst, src, static_cast<size_t>(width) * height);
+    return;
+  }
+  for (int y = 0; y < height; ++y) {
+    std::memcpy(dst + static_cast<size_t>(y) * width,
+                src + static_cast<ptrdiff_t>(y) * src_linesize, width);
+  }
+}
+
+// YUV420P 帧的三个平面依次紧密排列到 dst（PBO 上传前的准备）；
+// dst 至少 width * height + 2 * ceil(width/2) * ceil(height/2) 字节
+inline void packYuv420p(uint8_t* dst, const AVFrame* frame) {
+  const int width = frame->width;
+  const int height = frame->height;
+  const int half_w = (width + 1) / 2;
+  const int half_h = (height + 1) / 2;
+  const size_t y_size = static_cast<size_t>(width) * height;
+  const size_t c_size = static_cast<size_t>(half_w) * half_h;
+  copyPlane(dst, frame->data[0], frame->linesize[0], width, height);
+  copyPlane(dst + y_size, frame->data[1], frame->linesize[1], half_w, half_h);
+  copyPlane(dst + y_size + c_size, frame->data[2], frame->linesize[2], half_w,
+            half_h);
+}
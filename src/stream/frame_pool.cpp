@@ -0,0 +1,99 @@
+#include "frame_pool.hpp"
+
+// 池的共享状态：由 FramePool 与在外的帧共同决定生命周期
+struct FramePoolShared {
+  std::mutex mutex;
+  std::vector<PooledFrame*> free_list;
+  bool closed = false;        // FramePool 已析构
+  uint64_t outstanding = 0;   // 在池外的帧数
+  std::atomic<uint64_t> allocated{0};
+  std::atomic<uint64_t> acquired{0};
+};
+
+static void destroyFrame(PooledFrame* frame) {
+  av_frame_free(&frame->frame);
+  delete frame;
+}
+
+void FrameRecycler::operator()(PooledFrame* frame) const {
+  if (!frame) return;
+  FramePoolShared* shared = frame->owner_;
+  av_frame_unref(frame->frame);  // 数据缓冲立即交还解码器的池
+
+  bool destroy_shared = false;
+  {
+    std::lock_guard<std::mutex> lock(shared->mutex);
+    if (shared->closed) {
+      destroyFrame(frame);
+    } else {
+      shared->free_list.push_back(frame);  // 已预留容量，稳态不分配
+    }
+    --shared->outstanding;
+    destroy_shared = shared->closed && shared->outstanding == 0;
+  }
+  if (destroy_shared) {
+    delete shared;
+  }
+}
+
+FramePool::FramePool(size_t reserve) : shared_(new FramePoolShared) {
+  shared_->free_list.reserve(reserve);
+}
+
+FramePool::~FramePool() {
+  bool destroy_shared = false;
+  {
+    std::lock_guard<std::mutex> lock(shared_->mutex);
+    for (PooledFrame* frame : shared_->free_list) {
+      destroyFrame(frame);
+    }
+    shared_->free_list.clear();
+    shared_->closed = true;
+    destroy_shared = shared_->outstanding == 0;
+  }
+  if (destroy_shared) {
+    delete shared_;
+  }
+}
+
+FramePtr FramePool::acquire() {
+  PooledFrame* frame = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(shared_->mutex);
+    if (!shared_->free_list.empty()) {
+      frame = shared_->free_list.back();
+      shared_->free_list.pop_back();
+    }
+    ++shared_->outstanding;
+  }
+
+  if (!frame) {
+    frame = new PooledFrame;
+    frame->frame = av_frame_alloc();
+    frame->owner_ = shared_;
+    shared_->allocated.fetch_add(1, std::memory_order_relaxed);
+    if (!frame->frame) {
+      delete frame;
+      std::lock_guard<std::mutex> lock(shared_->mutex);
+      --shared_->outstanding;
+      return FramePtr();
+    }
+    // 容量随在外帧数增长，保证归还时 push_back 不再分配
+    std::lock_guard<std::mutex> lock(shared_->mutex);
+    shared_->free_list.reserve(shared_->allocated.load());
+  }
+
+  shared_->acquired.fetch_add(1, std::memory_order_relaxed);
+  frame->pts = 0;
+  frame->duration = 0;
+  return FramePtr(frame);
+}
+
+FramePool::Stats FramePool::getStats() const {
+  Stats stats;
+  stats.allocated = shared_->allocated.load(std::memory_order_relaxed);
+  stats.acquired = shared_->acquired.load(std::memory_order_relaxed);
+  std::lock_guard<std::mutex> lock(shared_->mutex);
+  stats.outstanding = shared_->outstanding;
+  return stats;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+extern "C" {
+#include <libavutil/frame.h>
+}
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class FramePool;
+struct FramePoolShared;
+struct PooledFrame;
+
+// 归还帧到所属的池（unique_ptr 删除器，无状态）
+struct FrameRecycler {
+  void operator()(PooledFrame* frame) const;
+};
+
+/**
+ * PooledFrame: 解码后的音频 / 视频帧。
+ * AVFrame 只在帧对象首次创建时分配一次，之后随帧对象在池中复用；
+ * 像素 / 采样数据以引用计数的形式挂在 AVFrame 上（来自解码器的缓冲池），
+ * 归还时 av_frame_unref() 把缓冲交还给解码器的池。
+ */
+struct PooledFrame {
+  AVFrame* frame = nullptr;  // 帧数据（由池持有）
+  int64_t pts = 0;           // 单位微秒(us)
+  int64_t duration = 0;      // 单位微秒(us)
+
+ private:
+  friend class FramePool;
+  friend struct FrameRecycler;
+  FramePoolShared* owner_ = nullptr;
+};
+
+using FramePtr = std::unique_ptr<PooledFrame, FrameRecycler>;
+
+/**
+ * FramePool: 帧对象池，每个 StreamSource 一个。
+ * acquire() 优先复用空闲帧，稳态播放时不再分配帧对象；句柄（FramePtr）
+ * 析构时自动归还，可在任意线程释放（渲染线程、音频线程、seek 等）。
+ * 池可以先于在外的帧销毁：最后一个帧归还时释放共享状态。
+ */
+class FramePool {
+ public:
+  struct Stats {
+    uint64_t allocated = 0;    // 新建的帧对象数（堆分配）
+    uint64_t acquired = 0;     // acquire() 次数
+    uint64_t outstanding = 0;  // 当前在池外的帧数
+  };
+
+  explicit FramePool(size_t reserve = 64);
+  ~FramePool();
+
+  FramePool(const FramePool&) = delete;
+  FramePool& operator=(const FramePool&) = delete;
+
+  FramePtr acquire();  // 分配失败时返回空句柄
+  Stats getStats() const;
+
+ private:
+  FramePoolShared* shared_;
+};
@@ -1,9 +1,11 @@
 #include "stream_source.hpp"
 
 #include "utils/logger.hpp"
+#include "utils/trace.hpp"
 
 extern "C" {
 #include <libavutil/frame.h>
+#include <libavutil/time.h>
 }
 
 using namespace utils;
@@ -17,7 +19,11 @@ int64_t get_frame_pts(AVFrame* frame, AVPacket* packet) {
 }
 
 StreamSource::StreamSource(Type type)
-    : type_(type), fake_pts_(0), MAX_QUEUE_SIZE(type == Type::Video ? 30 : 50) {
+    : type_(type),
+      fake_pts_(0),
+      MAX_QUEUE_SIZE(type == Type::Video ? 30 : 50),
+      frame_pool_(MAX_QUEUE_SIZE * 2),
+      frame_queue_(MAX_QUEUE_SIZE) {
   if (type == Type::Video) {
     width_ = 0;
     height_ = 0;
@@ -33,34 +39,47 @@ StreamSource::StreamSource(Type type)
 
 StreamSource::~StreamSource() { close(); }
 
-bool StreamSource::open(const std::string& filename) {
+void StreamSource::setDecoderThreading(Decoder::ThreadMode mode,
+                                       int thread_count) {
+  thread_mode_ = mode;
+  thread_count_ = thread_count;
+}
+
+bool StreamSource::open(std::shared_ptr<Demuxer> demuxer) {
   LOG_INFO << "Opening " << (type_ == Type::Video ? "video" : "audio")
-           << " stream from file: " << filename;
+           << " stream";
 
-  // 1. 初始化 Demuxer 并打开文件
-  demuxer_ = std::make_shared<Demuxer>(type_);
-  if (!demuxer_->open(filename)) {
-    LOG_ERROR << "Failed to open demuxer for file: " << filename;
+  // 1. 从共享 Demuxer 中获取目标流与数据包队列
+  if (!demuxer || !demuxer->isOpen()) {
+    LOG_ERROR << "Demuxer is not opened";
     return false;
   }
-
-  // 2. 获取流并初始化解码器
-  AVStream* stream = demuxer_->getAVStream();
+  AVStream* stream = demuxer->getAVStream(type_);
   if (!stream) {
-    LOG_ERROR << "No valid stream found in file: " << filename;
-    demuxer_->close();
+    LOG_ERROR << "No valid " << (type_ == Type::Video ? "video" : "audio")
+              << " stream found";
     return false;
   }
+  demuxer_ = std::move(demuxer);
+  stream_ = stream;
+  packet_queue_ = demuxer_->getPacketQueue(type_);
+
+  // 2. 初始化解码器
   decoder_ = std::make_unique<Decoder>(type_);
+  decoder_->setThreading(thread_mode_, thread_count_);
   if (!initializeDecoder(stream)) {
     LOG_ERROR << "Failed to initialize decoder";
-    demuxer_->close();
     decoder_->close();
+    demuxer_.reset();
+    stream_ = nullptr;
+    packet_queue_ = nullptr;
     return false;
   }
 
   state_.store(State::Stopped);
   eof_.store(false);
+  decode_latency_.reset();
+  packet_wait_latency_.reset();
 
   return true;
 }
@@ -137,71 +156,99 @@ void StreamSource::startDecoding() {
   // 从 Stopped 或 Paused 状态启动 decodingLoop 线程
   LOG_INFO << "Starting " << (type_ == Type::Video ? "video" : "audio")
            << " decoding thread";
-  if (state_.load() == State::Stopped) {
-    clearFrameQueue();
-    eof_.store(false);
+  if (state_.load() == State::Paused) {
+    resumeDecoding();  // 解码线程仍在，唤醒即可
+    return;
+  }
+  clearFrameQueue();
+  eof_.store(false);
+  if (decoding_thread_.joinable()) {
+    decoding_thread_.join();  // 回收到达 EOF 后已退出的解码线程
   }
   state_.store(State::Running);
   decoding_thread_ = std::thread(&StreamSource::decodingLoop, this);
 }
 
 void StreamSource::decodingLoop() {
+  TRACE_THREAD_NAME(type_ == Type::Video ? "video decode" : "audio decode");
   int packet_count = 0;  // 用于调试日志，记录处理的包数量
 
   while (state_.load() != State::Stopped) {
     if (state_.load() == State::Paused) {
-      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      // 暂停期间阻塞，直到恢复或停止
+      state_event_.wait([this]() { return state_.load() != State::Paused; });
+      throughput_window_start_us_ = 0;  // 暂停时间不计入吞吐统计窗口
+      throughput_busy_us_ = 0;
       continue;
     }
 
     // Throttle if queue is full
+    if (frame_queue_.size() >= MAX_QUEUE_SIZE) {
+      TRACE_SCOPE("wait frame queue space");
+      frame_queue_.waitUntilSizeBelow(MAX_QUEUE_SIZE, [this]() {
+        return state_.load() != State::Running;
+      });
+      continue;  // Re-check state 避免在解码线程暂停时继续处理
+    }
+
+    // 1. 不持有解码锁地等待数据包，避免阻塞 seek
+    const int64_t wait_begin_us = av_gettime_relative();
     {
-      std::unique_lock<std::mutex> lock(queue_mutex_);
-      if (frame_queue_.size() >= MAX_QUEUE_SIZE) {
-        queue_cond_.wait(lock, [this]() {
-          return frame_queue_.size() < MAX_QUEUE_SIZE ||
-                 state_.load() != State::Running;
-        });
-        continue;  // Re-check state 避免在解码线程暂停时继续处理
-      }
+      TRACE_SCOPE("wait packet");
+      packet_queue_->waitForPacket(
+          [this]() { return state_.load() != State::Running; });
     }
+    packet_wait_latency_.record(av_gettime_relative() - wait_begin_us);
 
-    // 1. Read next packet from demuxer
-    auto packet = demuxer_->readNextPacket();  // 智能指针管理
-    if (!packet) {
-      if (demuxer_->isEOF()) {
+    // 2. Pop next packet from the demuxer's queue and decode it
+    PacketPtr packet;
+    bool reached_eof = false;
+    {
+      std::lock_guard<std::mutex> decode_lock(decode_mutex_);
+      if (state_.load() != State::Running) {
+        continue;  // seek 期间可能已被暂停
+      }
+      packet = packet_queue_->tryPop();
+      if (packet) {
+        const int64_t begin_us = av_gettime_relative();
+        processPacket(packet.get());  // 传递裸指针，但 packet 自动释放
+        const int64_t busy_us = av_gettime_relative() - begin_us;
+        decode_latency_.record(busy_us);
+        updateThroughput(busy_us);
+      } else if (packet_queue_->isFinished()) {
         eof_.store(true);
         LOG_INFO << (type_ == Type::Video ? "Video" : "Audio")
                  << " stream reached EOF";
         processPacket(nullptr);  // Flush decoder
+        reached_eof = true;
+      }
+    }
+    if (reached_eof && eof_cb_) {
+      eof_cb_();
+    }
 
-        // Wait for all frames to be decoded before stopping
-        {
-          std::unique_lock<std::mutex> lock(queue_mutex_);
-          queue_cond_.wait(lock, [this]() {
-            return frame_queue_.empty() || state_.load() != State::Running;
-          });
-
-          if (frame_queue_.empty()) {
-            state_.store(State::Stopped);
-            LOG_INFO << (type_ == Type::Video ? "Video" : "Audio")
-                     << " stream decoding completed";
-            break;  // 读到数据包尽头也没有剩余帧了，退出解码循环
-          } else {
-            LOG_INFO << (type_ == Type::Video ? "Video" : "Audio")
-                     << " stream has remaining frames in queue";
-            // 仍可能有剩余帧，但状态切换了，继续处理
-          }
+    if (!packet) {
+      if (reached_eof) {
+        // Wait for all frames to be consumed before stopping
+        frame_queue_.waitUntilSizeBelow(
+            1, [this]() { return state_.load() != State::Running; });
+
+        if (frame_queue_.empty()) {
+          state_.store(State::Stopped);
+          frame_queue_.notifyAll();  // 唤醒等待帧的消费者，告知已结束
+          LOG_INFO << (type_ == Type::Video ? "Video" : "Audio")
+                   << " stream decoding completed";
+          break;  // 读到数据包尽头也没有剩余帧了，退出解码循环
+        } else {
+          LOG_INFO << (type_ == Type::Video ? "Video" : "Audio")
+                   << " stream has remaining frames in queue";
+          // 仍可能有剩余帧，但状态切换了，继续处理
         }
       }
-      std::this_thread::sleep_for(std::chrono::milliseconds(5));
       continue;
     }
 
-    processPacket(packet.get());  // 传递裸指针，但 packet 自动释放
-
     if (++packet_count % 30 == 0) {
-      std::lock_guard<std::mutex> lock(queue_mutex_);
       LOG_DEBUG << "Processed " << packet_count << " packets for "
                 << (type_ == Type::Video ? "video" : "audio") << " stream "
                 << frame_queue_.size() << "/" << MAX_QUEUE_SIZE
@@ -214,6 +261,9 @@ void StreamSource::pauseDecoding() {
   State expected = State::Running;
   // 原子比较并交换
   if (state_.compare_exchange_strong(expected, State::Paused)) {
+    // 唤醒等待帧队列 / 数据包队列的解码线程，使其尽快让出解码器
+    frame_queue_.notifyAll();
+    if (packet_queue_) packet_queue_->notifyAll();
     LOG_INFO << (type_ == Type::Video ? "Video" : "Audio") << " reader paused";
   }
 }
@@ -221,13 +271,16 @@ void StreamSource::pauseDecoding() {
 void StreamSource::resumeDecoding() {
   State expected = State::Paused;
   if (state_.compare_exchange_strong(expected, State::Running)) {
+    state_event_.notifyAll();
     LOG_INFO << (type_ == Type::Video ? "Video" : "Audio") << " reader resumed";
   }
 }
 
 void StreamSource::stopDecoding() {
   state_.store(State::Stopped);
-  queue_cond_.notify_all();
+  state_event_.notifyAll();
+  frame_queue_.notifyAll();
+  if (packet_queue_) packet_queue_->notifyAll();
   LOG_INFO << (type_ == Type::Video ? "Video" : "Audio") << " reader stopped";
 }
 
@@ -238,13 +291,18 @@ void StreamSource::close() {
   }
   clearFrameQueue();
   if (decoder_ && decoder_->isOpen()) {
+    auto stats = getAllocStats();
+    LOG_INFO << (type_ == Type::Video ? "Video" : "Audio")
+             << " frames decoded: " << stats.frames_decoded
+             << ", frame objects allocated: " << stats.frame_objects
+             << ", pixel buffers allocated: " << stats.pixel_buffers;
     decoder_->close();
     decoder_.reset();  // 智能指针释放
   }
-  if (demuxer_) {
-    demuxer_->close();
-    demuxer_.reset();  // 智能指针释放
-  }
+  // Demuxer 由 Player 统一关闭，这里只释放引用
+  demuxer_.reset();
+  stream_ = nullptr;
+  packet_queue_ = nullptr;
 
   state_.store(State::Stopped);
   eof_.store(false);
@@ -252,23 +310,48 @@ void StreamSource::close() {
            << " StreamSource closed";
 }
 
-std::shared_ptr<StreamSource::Frame> StreamSource::getNextFrame() {
-  std::unique_lock<std::mutex> lock(queue_mutex_);
-  if (frame_queue_.empty()) {
+FramePtr StreamSource::getNextFrame() {
+  TRACE_SCOPE("FrameQueue::pop");
+  FramePtr frame;
+  if (!frame_queue_.tryPop(frame)) {
     return nullptr;  // No frame available
   }
-  auto frame = frame_queue_.front();
-  frame_queue_.pop();
-  queue_cond_.notify_all();  // Notify decoding thread in case it was waiting
-  return frame;
+  return frame;  // tryPop 会唤醒等待空间的解码线程
+}
+
+bool StreamSource::waitForFrame(const std::function<bool()>& cancel) {
+  // 解码线程到达 EOF 并退出后不再等待；尚未启动或被外部停止时继续阻塞，
+  // 由调用方通过 cancel + wakeWaiters() 退出
+  return frame_queue_.waitForData([this, &cancel]() {
+    return (state_.load() == State::Stopped && eof_.load()) ||
+           (cancel && cancel());
+  });
 }
 
+void StreamSource::wakeWaiters() { frame_queue_.notifyAll(); }
+
 void StreamSource::processPacket(AVPacket* packet) {
   if (!decoder_ || !decoder_->isOpen()) {
     LOG_ERROR << "Decoder is not initialized";
     return;
   }
 
+  // 0. 应用渲染线程请求的降级等级；只解码关键帧时非关键帧直接丢弃，
+  //    连送入解码器（码流解析、线程间交接）的开销也省掉。
+  //    从只解码关键帧降下来时，随后的非关键帧引用的帧从未解码，立即切换会
+  //    一直花屏到下一个 IDR；因此保持丢包，直到遇到关键帧才切换等级
+  const bool is_key = packet && (packet->flags & AV_PKT_FLAG_KEY);
+  const int level = degrade_level_.load();
+  if (level != applied_degrade_level_ &&
+      (level >= 3 || applied_degrade_level_ < 3 || is_key)) {
+    decoder_->setDegradeLevel(level);
+    applied_degrade_level_ = level;
+  }
+  if (applied_degrade_level_ >= 3 && packet && !is_key) {
+    frames_skipped_.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
   // 1. Send packet to decoder (packet can be nullptr to flush)
   int ret = decoder_->decodePacket(packet);
   if (ret < 0) {
@@ -279,15 +362,22 @@ void StreamSource::processPacket(AVPacket* packet) {
   }
 
   // 2. Receive all available frames from decoder
+  //    直接解码到池中的帧，不再克隆（像素缓冲来自解码器的缓冲池）
+  int received = 0;
   while (true) {
-    auto raw_frame = decoder_->receiveFrame();
-    if (!raw_frame) {
-      break;  // No more frames
+    FramePtr frame = frame_pool_.acquire();
+    if (!frame) {
+      LOG_ERROR << "Could not acquire frame from pool";
+      break;
+    }
+    AVFrame* raw_frame = frame->frame;
+    if (!decoder_->receiveFrame(raw_frame)) {
+      break;  // No more frames（frame 归还到池）
     }
 
-    int64_t pts_src = get_frame_pts(raw_frame.get(), packet);  // 原始时间戳
+    int64_t pts_src = get_frame_pts(raw_frame, packet);  // 原始时间戳
     int64_t pts = AV_NOPTS_VALUE;
-    if (pts_src != AV_NOPTS_VALUE && demuxer_) {
+    if (pts_src != AV_NOPTS_VALUE && stream_) {
       pts = av_rescale_q(pts_src, getTimeBase(), AV_TIME_BASE_Q);
     }
 
@@ -318,43 +408,36 @@ void StreamSource::processPacket(AVPacket* packet) {
       LOG_WARN << "Frame has no valid PTS, assigning fake PTS: " << pts;
     }
 
-    // clone frame and push to queue
-    AVFrame* frame_clone = av_frame_clone(raw_frame.get());
-    if (!frame_clone) {
-      LOG_ERROR << "Could not clone frame";
-      continue;
-    }
+    frame->pts = pts;
+    frame->duration = duration;
+    frames_decoded_.fetch_add(1, std::memory_order_relaxed);
+    ++received;
+    pushFrameToQueue(std::move(frame));
+  }
 
-    auto shared_frame = std::shared_ptr<AVFrame>(
-        frame_clone, [](AVFrame* f) { av_frame_free(&f); });  // 自定义 deleter
-    // 将 AVFrame 包装到 Frame 结构体中 (包含 pts 和 duration)
-    auto wrapped_frame = std::make_shared<Frame>(shared_frame, pts, duration);
-    pushFrameToQueue(wrapped_frame);
+  // 跳过非参考帧时解码器不输出被丢弃的帧：一个数据包没有产出帧即记为跳过
+  if (level >= 2 && packet && received == 0) {
+    frames_skipped_.fetch_add(1, std::memory_order_relaxed);
   }
 }
 
-void StreamSource::pushFrameToQueue(std::shared_ptr<Frame> frame) {
+void StreamSource::pushFrameToQueue(FramePtr frame) {
   if (!frame) return;
 
-  std::lock_guard<std::mutex> lock(queue_mutex_);
-  if (frame_queue_.size() >= MAX_QUEUE_SIZE) {
-    LOG_WARN << "Frame queue is full, dropping frame with PTS: " << frame->pts;
-    frame.reset();  // Explicitly release to avoid memory leak
-    return;
+  TRACE_SCOPE("FrameQueue::push");
+  const int64_t pts = frame->pts;
+  if (!frame_queue_.tryPush(std::move(frame), pts)) {
+    LOG_WARN << "Frame queue is full, dropping frame with PTS: " << pts;
+    return;  // frame 离开作用域自动释放
   }
-  frame_queue_.push(frame);
-  queue_cond_.notify_one();
 }
 
 void StreamSource::clearFrameQueue() {
-  std::lock_guard<std::mutex> lock(queue_mutex_);
-  while (!frame_queue_.empty()) {
-    frame_queue_.pop();
-  }
-  queue_cond_.notify_all();  // Notify decoding thread in case it was waiting
+  frame_queue_.clear();  // 会唤醒等待空间的解码线程
 }
 
-bool StreamSource::seek(int64_t timestamp) {
+bool StreamSource::seek(int64_t timestamp,
+                        const std::function<bool()>& cancel) {
   LOG_INFO << "seek to " << timestamp;
   if (timestamp < 0 || timestamp > getDuration()) {
     LOG_ERROR << "Seek timestamp out of range: " << timestamp
@@ -362,39 +445,73 @@ bool StreamSource::seek(int64_t timestamp) {
     return false;
   }
 
-  if (!demuxer_) {
+  if (!packet_queue_) {
     LOG_ERROR << "No demuxer available";
     return false;
   }
 
-  int seek_flags = AVSEEK_FLAG_BACKWARD;
-  if (!demuxer_->seek(timestamp, seek_flags)) {
-    LOG_ERROR << "Error seeking to position: " << timestamp;
-    return false;
-  }
+  // 解码线程此时已暂停，持锁保证其不会与 seek 同时使用解码器
+  std::lock_guard<std::mutex> decode_lock(decode_mutex_);
 
   // Reset decoder and queues
   decoder_->flush();
   clearFrameQueue();
   eof_.store(false);
   fake_pts_ = 0;  // Reset fake PTS to avoid timestamp errors
+  // 降级状态随 seek 复位（由调用方设置），目标帧必须完整解码
+  applied_degrade_level_ = degrade_level_.load();
+  decoder_->setDegradeLevel(applied_degrade_level_);
 
   // Decode forward until we reach a frame at/after timestamp
+  // 目标之前的帧只解码不入队：复用同一个帧对象，不计算时长、不入队；
+  // 视频在数据包 PTS 早于目标时丢弃非参考帧（它们不会被显示，也不被引用）
+  const int64_t start_us = av_gettime_relative();
+  const int64_t target_src =
+      av_rescale_q(timestamp, AV_TIME_BASE_Q, getTimeBase());
+  bool discarding = false;
+  FramePtr frame;
   int packet_count = 0;
+  int frames_before_target = 0;
   int frames_queued_after_target = 0;
+  bool reached_target = false;
   while (true) {
-    auto packet = demuxer_->readNextPacket();
+    if (cancel && cancel()) {
+      LOG_INFO << "Seek to " << timestamp << " cancelled after "
+               << packet_count << " packets";
+      if (discarding) decoder_->setDiscardNonRef(false);
+      return false;
+    }
+
+    auto packet = packet_queue_->tryPop();
     if (!packet) {
-      LOG_WARN << "seek: no packet post-seek";
-      break;
+      if (packet_queue_->isFinished()) {
+        LOG_WARN << "seek: no packet post-seek";
+        break;
+      }
+      if (!demuxer_->isReading()) {
+        LOG_WARN << "seek: demuxer is not reading, stop decoding forward";
+        break;
+      }
+      // 等待读取线程填充队列（读取线程停止或取消时也会唤醒）
+      packet_queue_->waitForPacket([this, &cancel]() {
+        return !demuxer_->isReading() || (cancel && cancel());
+      });
+      continue;
     }
 
-    if (packet->stream_index != demuxer_->getStreamIndex()) {
-      continue;  // packet 自动释放
+    if (type_ == Type::Video) {
+      const bool before_target = !reached_target &&
+                                 packet->pts != AV_NOPTS_VALUE &&
+                                 packet->pts < target_src;
+      if (before_target != discarding) {
+        decoder_->setDiscardNonRef(before_target);
+        discarding = before_target;
+      }
     }
 
     if (decoder_->decodePacket(packet.get()) < 0) {
       LOG_ERROR << "Error sending packet to decoder during seek";
+      if (discarding) decoder_->setDiscardNonRef(false);
       return false;
     }
 
@@ -404,19 +521,38 @@ bool StreamSource::seek(int64_t timestamp) {
     }
 
     while (true) {
-      auto avframe = decoder_->receiveFrame();
-      if (!avframe) {
+      if (!frame) {
+        frame = frame_pool_.acquire();
+        if (!frame) break;
+      }
+      if (!decoder_->receiveFrame(frame->frame)) {
         break;
       }
+      AVFrame* avframe = frame->frame;
 
-      int64_t pts_src = get_frame_pts(avframe.get(), nullptr);
-      int64_t pts = (pts_src != AV_NOPTS_VALUE)
-                        ? av_rescale_q(pts_src, getTimeBase(), AV_TIME_BASE_Q)
-                        : AV_NOPTS_VALUE;
-      if (pts == AV_NOPTS_VALUE) {
+      int64_t pts_src = get_frame_pts(avframe, nullptr);
+      if (pts_src == AV_NOPTS_VALUE) {
+        continue;  // 下次 receiveFrame 会先释放该帧的引用
+      }
+      int64_t pts = av_rescale_q(pts_src, getTimeBase(), AV_TIME_BASE_Q);
+      if (pts < timestamp) {
+        ++frames_before_target;
         continue;
       }
 
+      if (!reached_target) {
+        reached_target = true;
+        if (discarding) {
+          decoder_->setDiscardNonRef(false);
+          discarding = false;
+        }
+        last_seek_decode_us_.store(av_gettime_relative() - start_us);
+        LOG_INFO << "Seek reached target after " << packet_count
+                 << " packets, " << frames_before_target
+                 << " frames skipped, decode-to-target "
+                 << last_seek_decode_us_.load() / 1000.0 << " ms";
+      }
+
       int64_t duration = 0;
       if (type_ == Type::Video) {
         if (avframe->duration > 0)
@@ -432,44 +568,82 @@ bool StreamSource::seek(int64_t timestamp) {
               (static_cast<int64_t>(avframe->nb_samples) * AV_TIME_BASE) / sr;
       }
 
-      AVFrame* frame_clone = av_frame_clone(avframe.get());
-      if (!frame_clone) {
-        LOG_ERROR << "Could not clone frame during seek";
-        continue;
-      }
-
-      auto shared_frame = std::shared_ptr<AVFrame>(
-          frame_clone, [](AVFrame* f) { av_frame_free(&f); });
-      auto frame_wrapper = std::make_shared<Frame>(shared_frame, pts, duration);
-
-      LOG_DEBUG << "Seek decoded frame pts: " << pts
-                << ", target: " << timestamp;
-
-      if (pts >= timestamp) {
-        LOG_DEBUG << "Seek: queuing frame with PTS: " << pts;
-
-        pushFrameToQueue(frame_wrapper);
-        frames_queued_after_target++;
-        if (frames_queued_after_target >= 5) {
-          LOG_DEBUG << "Seek completed, queued " << frames_queued_after_target
-                    << " frames";
-          return true;
-        }
+      LOG_DEBUG << "Seek: queuing frame with PTS: " << pts;
+      frame->pts = pts;
+      frame->duration = duration;
+      frames_decoded_.fetch_add(1, std::memory_order_relaxed);
+      pushFrameToQueue(std::move(frame));
+      frames_queued_after_target++;
+      if (frames_queued_after_target >= 5) {
+        LOG_DEBUG << "Seek completed, queued " << frames_queued_after_target
+                  << " frames";
+        return true;
       }
     }
   }
 
+  if (discarding) {
+    decoder_->setDiscardNonRef(false);
+  }
+  if (!reached_target) {
+    last_seek_decode_us_.store(av_gettime_relative() - start_us);
+  }
   return true;
 }
 
 int64_t StreamSource::getCurrentTimestamp() const {
-  std::lock_guard<std::mutex> lock(queue_mutex_);
-  if (!frame_queue_.empty()) {
-    return frame_queue_.front()->pts;
+  return frame_queue_.frontStamp(0);  // 无锁读取队首帧 PTS
+}
+
+StreamSource::AllocStats StreamSource::getAllocStats() const {
+  AllocStats stats;
+  stats.frames_decoded = frames_decoded_.load(std::memory_order_relaxed);
+  stats.frame_objects = frame_pool_.getStats().allocated;
+  stats.pixel_buffers = decoder_ ? decoder_->getBufferAllocations() : 0;
+  return stats;
+}
+
+StreamSource::StageLatency StreamSource::getStageLatency() const {
+  StageLatency latency;
+  latency.decode = decode_latency_.snapshot();
+  latency.packet_wait = packet_wait_latency_.snapshot();
+  return latency;
+}
+
+void StreamSource::updateThroughput(int64_t busy_us) {
+  static constexpr int64_t REPORT_INTERVAL_US = 5 * AV_TIME_BASE;
+  const int64_t now = av_gettime_relative();
+  if (throughput_window_start_us_ == 0) {
+    throughput_window_start_us_ = now;
+    throughput_frames_start_ = frames_decoded_.load(std::memory_order_relaxed);
   }
-  return 0;
+  throughput_busy_us_ += busy_us;
+
+  const int64_t elapsed = now - throughput_window_start_us_;
+  if (elapsed < REPORT_INTERVAL_US) return;
+
+  const uint64_t frames_now = frames_decoded_.load(std::memory_order_relaxed);
+  const double frames =
+      static_cast<double>(frames_now - throughput_frames_start_);
+  const double fps = frames * AV_TIME_BASE / elapsed;  // 实际输出帧率
+  // 解码能力：解码线程一直忙碌时每秒可输出的帧数
+  const double capacity =
+      throughput_busy_us_ > 0 ? frames * AV_TIME_BASE / throughput_busy_us_
+                              : 0.0;
+  if (type_ == Type::Video) {
+    LOG_INFO << "Video decode throughput: " << fps << " fps, capacity "
+             << capacity << " fps (stream " << frame_rate_ << " fps, "
+             << (frame_rate_ > 0 ? capacity / frame_rate_ : 0.0)
+             << "x realtime), busy "
+             << 100.0 * throughput_busy_us_ / elapsed << "%";
+  } else {
+    LOG_INFO << "Audio decode throughput: " << fps << " frames/s, busy "
+             << 100.0 * throughput_busy_us_ / elapsed << "%";
+  }
+
+  throughput_window_start_us_ = now;
+  throughput_busy_us_ = 0;
+  throughput_frames_start_ = frames_now;
 }
 
-AVRational StreamSource::getTimeBase() const {
-  return demuxer_->getAVStream()->time_base;
-}
\ No newline at end of file
+AVRational StreamSource::getTimeBase() const { return stream_->time_base; }
\ No newline at end of file
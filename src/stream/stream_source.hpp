@@ -6,25 +6,35 @@ extern "C" {
 }
 
 #include <atomic>
-#include <condition_variable>
+#include <chrono>
+#include <functional>
 #include <memory>
 #include <mutex>
-#include <queue>
 #include <thread>
 
 #include "decoder.hpp"
 #include "demuxer.hpp"
+#include "frame_pool.hpp"
+#include "latency_histogram.hpp"
+#include "spsc_queue.hpp"
+#include "wait_event.hpp"
 
 class StreamSource {
  public:
-  // 音频 / 视频帧
-  struct Frame {
-    std::shared_ptr<AVFrame> frame;
-    int64_t pts;
-    int64_t duration;
-
-    Frame(std::shared_ptr<AVFrame> f, int64_t p, int64_t d)
-        : frame(f), pts(p), duration(d) {}
+  // 音频 / 视频帧：来自帧池的单一句柄，析构时归还（见 frame_pool.hpp）
+  using Frame = PooledFrame;
+
+  // 帧分配统计：稳态播放时 frame_objects 与 pixel_buffers 不再增长
+  struct AllocStats {
+    uint64_t frames_decoded = 0;  // 解码输出的帧数
+    uint64_t frame_objects = 0;   // 帧池新建的帧对象数
+    uint64_t pixel_buffers = 0;   // 解码器缓冲池分配的像素缓冲数（仅视频）
+  };
+
+  // 解码线程各阶段耗时分布，单位微秒(us)
+  struct StageLatency {
+    utils::LatencyHistogram::Snapshot decode;       // 每个数据包的解码耗时
+    utils::LatencyHistogram::Snapshot packet_wait;  // 等待数据包的时间
   };
 
   // 流状态
@@ -33,7 +43,11 @@ class StreamSource {
   StreamSource(Type type);
   ~StreamSource();
 
-  bool open(const std::string& filename);
+  // 解码线程策略，在 open() 之前设置，传给 Decoder（见 Decoder::ThreadMode）
+  void setDecoderThreading(Decoder::ThreadMode mode, int thread_count = 0);
+
+  // 从共享的 Demuxer 中取对应类型的流，并初始化解码器
+  bool open(std::shared_ptr<Demuxer> demuxer);
   void close();  // 负责所有资源释放，可外部调用或析构使用
 
   void startDecoding();   // 启动解码线程 decodingLoop
@@ -41,9 +55,33 @@ class StreamSource {
   void resumeDecoding();  // 恢复解码线程
   void stopDecoding();    // 停止解码线程
 
-  bool seek(int64_t timestamp);           // 流级别跳转，单位微秒(us)
-  std::shared_ptr<Frame> getNextFrame();  // 从队列中获取下一帧
-  int64_t getCurrentTimestamp() const;    // 获取当前播放时间戳，单位微秒(us)
+  // 流级别跳转，单位微秒(us)。调用前 Demuxer 已完成定位，
+  // 这里只刷新解码器并从数据包队列解码到目标时间戳。
+  // cancel() 为真时尽快放弃（被更新的 seek 取代），返回 false
+  bool seek(int64_t timestamp,
+            const std::function<bool()>& cancel = nullptr);
+  // 最近一次 seek 从关键帧解码到目标帧的耗时，单位微秒(us)
+  int64_t getLastSeekDecodeUs() const { return last_seek_decode_us_.load(); }
+  FramePtr getNextFrame();  // 从队列中获取下一帧（消费者线程）
+  // 阻塞直到队列中有帧、解码线程到达 EOF 退出或 cancel() 为真；
+  // 返回是否有帧可取。
+  // cancel 依赖的外部状态改变后需调用 wakeWaiters()
+  bool waitForFrame(const std::function<bool()>& cancel);
+  void wakeWaiters();  // 唤醒 waitForFrame() 的等待者重新检查条件
+
+  // 解码线程到达 EOF 时调用（在解码线程中执行）
+  void setEOFCallback(std::function<void()> cb) { eof_cb_ = std::move(cb); }
+  int64_t getCurrentTimestamp() const;  // 获取当前播放时间戳，单位微秒(us)
+  AllocStats getAllocStats() const;
+  StageLatency getStageLatency() const;
+  size_t getQueuedFrames() const { return frame_queue_.size(); }
+
+  // 解码降级等级（见 Decoder::setDegradeLevel），可在任意线程设置，
+  // 由解码线程在下一个数据包之前应用
+  void setDegradeLevel(int level) { degrade_level_.store(level); }
+  int getDegradeLevel() const { return degrade_level_.load(); }
+  // 降级期间跳过的帧数（关键帧模式下为精确值，跳过非参考帧时为估计值）
+  uint64_t getFramesSkipped() const { return frames_skipped_.load(); }
 
   bool isEOF() const { return eof_; }
 
@@ -67,11 +105,12 @@ class StreamSource {
   bool initializeDecoder(AVStream* stream);  // 初始化解码器
   void processPacket(AVPacket* packet);      // 对原始数据包进行解码处理
   void decodingLoop();                       // 解码线程主循环
-  void pushFrameToQueue(
-      std::shared_ptr<Frame> frame);  // 将解码后的数据帧推入队列
+  void pushFrameToQueue(FramePtr frame);  // 将解码后的数据帧推入队列
   void clearFrameQueue();             // 清空帧队列
 
   int64_t calculateFrameDuration(AVFrame* frame);  // 计算帧持续时间
+  // 累计解码耗时，并周期性输出解码吞吐（仅解码线程调用）
+  void updateThroughput(int64_t busy_us);
 
   Type type_;
   int64_t fake_pts_;  // 只在无效PTS时用，不影响其他逻辑
@@ -90,16 +129,39 @@ class StreamSource {
 
   // Common components
   std::unique_ptr<Decoder> decoder_;  // Decoder 依赖独立的上下文、状态、缓冲区
-  std::shared_ptr<Demuxer> demuxer_;  // Demuxer 仅负责解析媒体文件，可以共享
+  Decoder::ThreadMode thread_mode_ = Decoder::ThreadMode::Auto;
+  int thread_count_ = 0;
+  std::shared_ptr<Demuxer> demuxer_;  // Demuxer 由 Player 创建，音视频共享
+  AVStream* stream_ = nullptr;               // 当前流（由 Demuxer 持有）
+  PacketQueue* packet_queue_ = nullptr;      // 当前流的数据包队列
+  std::mutex decode_mutex_;  // 串行化解码线程与 seek 对解码器的访问
 
   // Thread management
   std::thread decoding_thread_;
   std::atomic<State> state_{State::Stopped};
+  utils::WaitEvent state_event_;  // 暂停的解码线程等待恢复 / 停止
   std::atomic<bool> eof_{false};
+  std::function<void()> eof_cb_;
 
-  // Frame queue
-  std::queue<std::shared_ptr<Frame>> frame_queue_;  // 解码后的帧队列
-  mutable std::mutex queue_mutex_;
-  std::condition_variable queue_cond_;
+  // Frame queue：解码线程为唯一生产者，渲染 / 音频线程为唯一消费者
   const size_t MAX_QUEUE_SIZE;
+  FramePool frame_pool_;  // 先于帧队列构造，队列中的帧析构时归还
+  utils::SpscQueue<FramePtr> frame_queue_;  // 解码后的帧队列
+  std::atomic<uint64_t> frames_decoded_{0};
+
+  // 解码降级：degrade_level_ 为请求值，applied_degrade_level_ 由 decode_mutex_
+  // 保护（解码线程与 seek 都在持锁时使用解码器）
+  std::atomic<int> degrade_level_{0};
+  int applied_degrade_level_ = 0;
+  std::atomic<uint64_t> frames_skipped_{0};
+  std::atomic<int64_t> last_seek_decode_us_{0};
+
+  // 阶段耗时分布（open 时清零）
+  utils::LatencyHistogram decode_latency_;
+  utils::LatencyHistogram packet_wait_latency_;
+
+  // 解码吞吐统计窗口（仅解码线程访问）
+  int64_t throughput_window_start_us_ = 0;
+  int64_t throughput_busy_us_ = 0;
+  uint64_t throughput_frames_start_ = 0;
 };
\ No newline at end of file
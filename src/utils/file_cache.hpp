@@ -0,0 +1,120 @@
+#pragma once
+
+#include <sys/stat.h>
+
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+namespace utils {
+
+/**
+ * 媒体文件派生数据（关键帧索引、流信息等）的磁盘缓存辅助函数。
+ * 缓存文件放在 $XDG_CACHE_HOME（或 ~/.cache）/RealTimeAVPlayer/ 下，
+ * 以媒体文件绝对路径的哈希命名；文件身份（大小 + 修改时间）写入缓存头，
+ * 读取时比对，媒体文件变化后缓存自动失效。
+ */
+struct FileIdentity {
+  uint64_t size = 0;
+  int64_t mtime_ns = 0;
+
+  bool operator==(const FileIdentity& o) const {
+    return size == o.size && mtime_ns == o.mtime_ns;
+  }
+  bool operator!=(const FileIdentity& o) const { return !(*this == o); }
+};
+
+// 仅对本地普通文件返回 true
+inline bool getFileIdentity(const std::string& filename, FileIdentity* out) {
+  struct stat st;
+  if (::stat(filename.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) {
+    return false;
+  }
+  out->size = static_cast<uint64_t>(st.st_size);
+#ifdef __APPLE__
+  out->mtime_ns = static_cast<int64_t>(st.st_mtimespec.tv_sec) * 1000000000 +
+                  st.st_mtimespec.tv_nsec;
+#else
+  out->mtime_ns = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 +
+                  st.st_mtim.tv_nsec;
+#endif
+  return true;
+}
+
+// FNV-1a 64 位哈希，用于缓存目录下的文件名
+inline uint64_t hashPath(const std::string& s) {
+  uint64_t h = 1469598103934665603ull;
+  for (unsigned char c : s) {
+    h ^= c;
+    h *= 1099511628211ull;
+  }
+  return h;
+}
+
+inline std::string cacheDirectory() {
+  const char* xdg = std::getenv("XDG_CACHE_HOME");
+  if (xdg && xdg[0] != '\0') {
+    return std::string(xdg) + "/RealTimeAVPlayer";
+  }
+  const char* home = std::getenv("HOME");
+  if (home && home[0] != '\0') {
+    return std::string(home) + "/.cache/RealTimeAVPlayer";
+  }
+  return std::string();
+}
+
+// <缓存目录>/<路径哈希><suffix>；没有可用的缓存目录时返回空串
+inline std::string cachePathFor(const std::string& filename,
+                                const char* suffix) {
+  const std::string cache_dir = cacheDirectory();
+  if (cache_dir.empty()) {
+    return std::string();
+  }
+  char resolved[PATH_MAX];
+  const std::string abs_path =
+      ::realpath(filename.c_str(), resolved) ? resolved : filename;
+  char name[32];
+  std::snprintf(name, sizeof(name), "/%016llx",
+                static_cast<unsigned long long>(hashPath(abs_path)));
+  return cache_dir + name + suffix;
+}
+
+// 逐级创建目录（mkdir -p）；全新账户下 ~/.cache 本身也可能不存在
+inline bool makeDirectories(const std::string& dir) {
+  for (size_t pos = dir.find('/', 1); ; pos = dir.find('/', pos + 1)) {
+    const std::string part = dir.substr(0, pos);
+    if (!part.empty() && ::mkdir(part.c_str(), 0755) != 0 &&
+        errno != EEXIST) {
+      return false;
+    }
+    if (pos == std::string::npos) break;
+  }
+  struct stat st;
+  return ::stat(dir.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+// 写入缓存文件：按需创建所在目录，先写 <path>.tmp 再 rename，
+// 读者不会看到写了一半的文件。失败时删除临时文件并返回 false
+inline bool writeFileAtomically(const std::string& path, const void* data,
+                                size_t size) {
+  const size_t slash = path.rfind('/');
+  if (slash != std::string::npos && slash > 0 &&
+      !makeDirectories(path.substr(0, slash))) {
+    return false;
+  }
+  const std::string tmp = path + ".tmp";
+  FILE* fp = std::fopen(tmp.c_str(), "wb");
+  if (!fp) return false;
+  bool ok = std::fwrite(data, 1, size, fp) == size;
+  ok = (std::fclose(fp) == 0) && ok;
+  if (ok && std::rename(tmp.c_str(), path.c_str()) == 0) {
+    return true;
+  }
+  std::remove(tmp.c_str());
+  return false;
+}
+
+}  // namespace utils
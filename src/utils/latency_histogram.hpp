@@ -0,0 +1,118 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+
+namespace utils {
+
+/**
+ * LatencyHistogram: 固定内存的对数-线性直方图，用于统计耗时（通常以微秒计）。
+ * 每个 2 的幂区间再细分 8 个桶，分位数相对误差不超过 12.5%。
+ * record() 只做几次 relaxed 原子操作，可以在渲染 / 解码等热路径上调用；
+ * snapshot() 可在任意线程读取（结果是近似一致的快照）。
+ */
+class LatencyHistogram {
+ public:
+  struct Snapshot {
+    uint64_t count = 0;
+    int64_t min = 0;
+    int64_t max = 0;
+    double mean = 0.0;
+    int64_t p50 = 0;
+    int64_t p95 = 0;
+    int64_t p99 = 0;
+  };
+
+  LatencyHistogram() { reset(); }
+
+  void record(int64_t value) {
+    if (value < 0) value = 0;
+    buckets_[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(value, std::memory_order_relaxed);
+    int64_t cur = max_.load(std::memory_order_relaxed);
+    while (value > cur &&
+           !max_.compare_exchange_weak(cur, value, std::memory_order_relaxed)) {
+    }
+    cur = min_.load(std::memory_order_relaxed);
+    while (value < cur &&
+           !min_.compare_exchange_weak(cur, value, std::memory_order_relaxed)) {
+    }
+  }
+
+  Snapshot snapshot() const {
+    Snapshot s;
+    uint64_t counts[BUCKETS];
+    uint64_t total = 0;
+    for (int i = 0; i < BUCKETS; ++i) {
+      counts[i] = buckets_[i].load(std::memory_order_relaxed);
+      total += counts[i];
+    }
+    if (total == 0) return s;
+
+    s.count = total;
+    s.min = min_.load(std::memory_order_relaxed);
+    s.max = max_.load(std::memory_order_relaxed);
+    s.mean = static_cast<double>(sum_.load(std::memory_order_relaxed)) /
+             static_cast<double>(count_.load(std::memory_order_relaxed));
+    s.p50 = percentile(counts, total, 0.50, s.max);
+    s.p95 = percentile(counts, total, 0.95, s.max);
+    s.p99 = percentile(counts, total, 0.99, s.max);
+    return s;
+  }
+
+  uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+
+  void reset() {
+    for (auto& b : buckets_) b.store(0, std::memory_order_relaxed);
+    count_.store(0, std::memory_order_relaxed);
+    sum_.store(0, std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+    min_.store(std::numeric_limits<int64_t>::max(), std::memory_order_relaxed);
+  }
+
+ private:
+  static constexpr int SUB_BITS = 3;  // 每个 2 的幂区间 8 个桶
+  static constexpr int SUB_COUNT = 1 << SUB_BITS;
+  static constexpr int BUCKETS = SUB_COUNT + (63 - SUB_BITS) * SUB_COUNT;
+
+  static int bucketIndex(int64_t value) {
+    const uint64_t v = static_cast<uint64_t>(value);
+    if (v < SUB_COUNT) return static_cast<int>(v);
+    const int msb = 63 - __builtin_clzll(v);
+    const int sub = static_cast<int>((v >> (msb - SUB_BITS)) & (SUB_COUNT - 1));
+    return SUB_COUNT + (msb - SUB_BITS) * SUB_COUNT + sub;
+  }
+
+  // 桶的上界（含），用作该桶内数值的估计
+  static int64_t bucketUpperBound(int index) {
+    if (index < SUB_COUNT) return index;
+    const int msb = (index - SUB_COUNT) / SUB_COUNT + SUB_BITS;
+    const int sub = (index - SUB_COUNT) % SUB_COUNT;
+    const uint64_t base = (uint64_t{1} << msb) |
+                          (static_cast<uint64_t>(sub) << (msb - SUB_BITS));
+    return static_cast<int64_t>(base + (uint64_t{1} << (msb - SUB_BITS)) - 1);
+  }
+
+  static int64_t percentile(const uint64_t* counts, uint64_t total, double q,
+                            int64_t max) {
+    const uint64_t rank =
+        std::max<uint64_t>(1, static_cast<uint64_t>(q * total + 0.5));
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKETS; ++i) {
+      seen += counts[i];
+      if (seen >= rank) return std::min(bucketUpperBound(i), max);
+    }
+    return max;
+  }
+
+  std::atomic<uint64_t> buckets_[BUCKETS];
+  std::atomic<uint64_t> count_;
+  std::atomic<int64_t> sum_;
+  std::atomic<int64_t> max_;
+  std::atomic<int64_t> min_;
+};
+
+}  // namespace utils
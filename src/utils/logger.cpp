@@ -1,4 +1,301 @@
 #include "logger.hpp"
 
-// 只保留必要的静态成员变量初始化（如有需要）
-// 其它成员函数已在头文件inline实现，无需重复定义
+#ifdef _WIN32
+#include <io.h>
+#define isatty _isatty
+#define fileno _fileno
+#else
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <ctime>
+#include <mutex>
+
+#include "mpsc_queue.hpp"
+#include "wait_event.hpp"
+
+namespace utils {
+
+namespace {
+
+struct LogRecord {
+  LogLevel level;
+  const char* file;
+  const char* function;
+  int line;
+  uint32_t suppressed;
+  int64_t time_us;
+  uint32_t thread_id;
+  uint16_t length;
+  bool truncated;
+  char text[Logger::MESSAGE_MAX];
+};
+
+const char* levelStr(LogLevel level) {
+  switch (level) {
+    case LogLevel::DEBUG:
+      return "DEBUG";
+    case LogLevel::INFO:
+      return "INFO ";
+    case LogLevel::WARN:
+      return "WARN ";
+    case LogLevel::ERROR:
+      return "ERROR";
+    case LogLevel::FATAL:
+      return "FATAL";
+    default:
+      return "UNKNOWN";
+  }
+}
+
+const char* levelColor(LogLevel level) {
+  switch (level) {
+    case LogLevel::INFO:
+      return Color::GREEN;
+    case LogLevel::WARN:
+      return Color::YELLOW;
+    case LogLevel::ERROR:
+    case LogLevel::FATAL:
+      return Color::RED;
+    default:
+      return Color::RESET;
+  }
+}
+
+// 线程编号：按首次写日志的顺序分配，比 std::thread::id 短且格式化不走 ostream
+std::atomic<uint32_t> next_thread_id{1};
+uint32_t currentThreadId() {
+  static thread_local const uint32_t id = next_thread_id.fetch_add(1);
+  return id;
+}
+
+/**
+ * LogBackend: 日志队列与后台写线程。
+ * 进程内唯一且不析构（退出阶段其他静态对象析构时仍可能写日志），
+ * 退出时由 ShutdownGuard 停止写线程并写出剩余日志，之后转为同步输出。
+ */
+class LogBackend {
+ public:
+  static constexpr size_t QUEUE_CAPACITY = 2048;
+  static constexpr int WRITER_INTERVAL_MS = 10;
+
+  static LogBackend& instance() {
+    static LogBackend* backend = created_ = new LogBackend();
+    return *backend;
+  }
+  static LogBackend* created() { return created_; }
+
+  void submit(const Logger::LogStream& s, uint32_t thread_id);
+  void flush();
+  void shutdown();
+  uint64_t dropped() const { return dropped_total_.load(); }
+
+ private:
+  LogBackend();
+  void writerLoop();
+  size_t drain();  // 取出队列中所有记录并输出，返回条数
+  void format(const LogRecord& r, std::string& out);
+  void write(const std::string& out, const std::string& errors);
+
+  static inline std::atomic<LogBackend*> created_{nullptr};
+
+  MpscQueue<LogRecord> queue_{QUEUE_CAPACITY};
+  std::atomic<bool> sync_{false};
+  std::atomic<bool> stop_{false};
+  std::atomic<uint64_t> submitted_{0};
+  std::atomic<uint64_t> written_{0};
+  std::atomic<uint64_t> dropped_{0};        // 自上次报告后丢弃的条数
+  std::atomic<uint64_t> dropped_total_{0};
+  bool mirror_errors_ = false;  // stdout 被重定向时错误额外写到 stderr
+  WaitEvent wake_event_;        // 唤醒写线程（FATAL / flush / 退出）
+  WaitEvent written_event_;     // 通知 flush() 的等待方
+  std::mutex write_mutex_;      // 同步模式与 drain() 互斥
+  std::thread writer_;
+
+  // 写线程私有：时间戳格式化缓存（同一秒内复用）
+  int64_t cached_second_ = -1;
+  char cached_time_[32] = {0};
+  std::string batch_;
+  std::string errors_;
+};
+
+LogBackend::LogBackend() {
+  const char* sync = std::getenv("RTAV_LOG_SYNC");
+  sync_ = sync && std::atoi(sync) != 0;
+  mirror_errors_ = !isatty(fileno(stdout));
+  batch_.reserve(64 * 1024);
+  if (!sync_) {
+    writer_ = std::thread(&LogBackend::writerLoop, this);
+  }
+}
+
+void LogBackend::submit(const Logger::LogStream& s, uint32_t thread_id) {
+  auto fill = [&](LogRecord& r) {
+    r.level = s.level();
+    r.file = s.file();
+    r.function = s.function();
+    r.line = s.line();
+    r.suppressed = s.suppressed();
+    r.time_us = s.timeUs();
+    r.thread_id = thread_id;
+    r.length = static_cast<uint16_t>(s.size());
+    r.truncated = s.truncated();
+    std::memcpy(r.text, s.data(), s.size());
+  };
+
+  if (sync_.load(std::memory_order_relaxed)) {
+    LogRecord record;
+    fill(record);
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    std::string out;
+    format(record, out);
+    write(out, record.level >= LogLevel::ERROR ? out : std::string());
+    return;
+  }
+
+  if (!queue_.tryPush(fill)) {
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+    dropped_total_.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  submitted_.fetch_add(1, std::memory_order_release);
+  if (s.level() >= LogLevel::FATAL) {
+    flush();
+  }
+}
+
+void LogBackend::flush() {
+  if (sync_.load()) {
+    std::fflush(stdout);
+    return;
+  }
+  const uint64_t target = submitted_.load(std::memory_order_acquire);
+  wake_event_.notifyAll();
+  written_event_.wait([&]() {
+    return written_.load(std::memory_order_acquire) >= target || sync_.load();
+  });
+}
+
+void LogBackend::shutdown() {
+  if (sync_.exchange(true)) return;
+  stop_.store(true);
+  wake_event_.notifyAll();
+  if (writer_.joinable()) writer_.join();
+  std::lock_guard<std::mutex> lock(write_mutex_);
+  drain();  // 停止写线程与切换到同步模式之间提交的日志
+  written_event_.notifyAll();
+}
+
+void LogBackend::writerLoop() {
+  while (!stop_.load()) {
+    size_t n;
+    {
+      std::lock_guard<std::mutex> lock(write_mutex_);
+      n = drain();
+    }
+    if (n > 0) {
+      written_event_.notifyAll();
+      continue;
+    }
+    // 普通日志最多延迟一个周期输出；FATAL / flush() / 退出时立即唤醒
+    wake_event_.waitUntil(
+        std::chrono::steady_clock::now() +
+            std::chrono::milliseconds(WRITER_INTERVAL_MS),
+        [this]() {
+          return stop_.load() ||
+                 written_.load() < submitted_.load(std::memory_order_acquire);
+        });
+  }
+}
+
+size_t LogBackend::drain() {
+  batch_.clear();
+  errors_.clear();
+  size_t count = 0;
+  const uint64_t dropped = dropped_.exchange(0, std::memory_order_relaxed);
+  if (dropped > 0) {
+    batch_ += Color::YELLOW;
+    batch_ += "[logger] " + std::to_string(dropped) +
+              " log messages dropped (queue full)";
+    batch_ += Color::RESET;
+    batch_ += '\n';
+  }
+  while (queue_.tryPop([&](LogRecord& r) {
+    const size_t begin = batch_.size();
+    format(r, batch_);
+    if (r.level >= LogLevel::ERROR) {
+      errors_.append(batch_, begin, std::string::npos);
+    }
+  })) {
+    ++count;
+  }
+  if (!batch_.empty()) {
+    write(batch_, errors_);
+  }
+  written_.fetch_add(count, std::memory_order_release);
+  return count;
+}
+
+void LogBackend::format(const LogRecord& r, std::string& out) {
+  const int64_t second = r.time_us / 1000000;
+  if (second != cached_second_) {
+    cached_second_ = second;
+    const std::time_t t = static_cast<std::time_t>(second);
+    std::tm tm_buf;
+#ifdef _WIN32
+    localtime_s(&tm_buf, &t);
+#else
+    localtime_r(&t, &tm_buf);
+#endif
+    std::strftime(cached_time_, sizeof(cached_time_), "%Y-%m-%d %H:%M:%S",
+                  &tm_buf);
+  }
+
+  char prefix[256];
+  const int n = std::snprintf(
+      prefix, sizeof(prefix),
+      "%s[%s.%06lld] %s%s[%s] %s[%u] %s[%s:%d] %s[%s] %s", Color::CYAN, cached_time_, static_cast<long long>(r.time_us % 1000000),
+      levelColor(r.level), Color::BOLD, levelStr(r.level), Color::MAGENTA,
+      r.thread_id, Color::BLUE, r.file, r.line, Color::CYAN, r.function,
+      levelColor(r.level));
+  if (n > 0) {
+    out.append(prefix, std::min(static_cast<size_t>(n), sizeof(prefix) - 1));
+  }
+  out.append(r.text, r.length);
+  if (r.truncated) out += "...";
+  if (r.suppressed > 0) {
+    out += " (" + std::to_string(r.suppressed) +
+           " similar messages suppressed)";
+  }
+  out += Color::RESET;
+  out += '\n';
+}
+
+void LogBackend::write(const std::string& out, const std::string& errors) {
+  std::fwrite(out.data(), 1, out.size(), stdout);
+  std::fflush(stdout);
+  // 终端上 stdout 与 stderr 是同一处，只写一次；重定向时错误也留在 stderr
+  if (!errors.empty() && mirror_errors_) {
+    std::fwrite(errors.data(), 1, errors.size(), stderr);
+  }
+}
+
+// 静态析构阶段停止写线程并写出剩余日志
+struct ShutdownGuard {
+  ~ShutdownGuard() {
+    if (LogBackend* backend = LogBackend::created()) backend->shutdown();
+  }
+} shutdown_guard;
+
+}  // namespace
+
+void Logger::submit(const LogStream& stream) {
+  LogBackend::instance().submit(stream, currentThreadId());
+}
+
+void Logger::flush() { LogBackend::instance().flush(); }
+
+uint64_t Logger::droppedCount() { return LogBackend::instance().dropped(); }
+
+}  // namespace utils
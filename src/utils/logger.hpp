@@ -1,11 +1,28 @@
 #pragma once
 
-#include <ctime>
-#include <iomanip>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <thread>
+#include <type_traits>
+
+// 编译期最低日志级别（0=DEBUG ... 4=FATAL）：低于该级别的 LOG_* 整体被编译器消除。
+// 未指定时 Release（NDEBUG）构建去掉 DEBUG，Debug 构建全部保留。
+#ifndef RTAV_LOG_MIN_LEVEL
+#ifdef NDEBUG
+#define RTAV_LOG_MIN_LEVEL 1
+#else
+#define RTAV_LOG_MIN_LEVEL 0
+#endif
+#endif
 
 namespace utils {
 
@@ -23,65 +40,121 @@ struct Color {
 
 enum class LogLevel { DEBUG = 0, INFO = 1, WARN = 2, ERROR = 3, FATAL = 4 };
 
+/**
+ * LogRateLimiter: 每个 LOG_* 调用点一个（宏内的函数局部静态变量），
+ * 每秒最多放行 Logger::getRateLimit() 条，其余计数后丢弃；
+ * 下一条放行的日志附带被抑制的条数。避免每帧触发的警告刷屏并拖慢实时线程。
+ */
+class LogRateLimiter {
+ public:
+  static constexpr int64_t WINDOW_MS = 1000;
+
+  bool allow();
+
+  // allow() 放行时，上一窗口内被抑制的条数（供随后构造的 LogStream 读取）
+  static uint32_t takeSuppressed() {
+    const uint32_t n = last_suppressed_;
+    last_suppressed_ = 0;
+    return n;
+  }
+
+ private:
+  std::atomic<int64_t> window_start_ms_{0};
+  std::atomic<uint32_t> count_{0};
+  std::atomic<uint32_t> suppressed_{0};
+  inline static thread_local uint32_t last_suppressed_ = 0;
+};
+
+/**
+ * Logger: 异步日志。LOG_* 在调用线程上把消息格式化到 LogStream 内的定长缓冲区
+ * （不分配内存，超长截断），析构时整条记录写入无锁 MPSC 环形队列；
+ * 后台线程负责时间戳格式化与输出，调用线程不做系统调用。
+ * - 队列满时丢弃并计数，不阻塞调用线程（后台线程会输出丢弃条数）。
+ * - FATAL 以及 Logger::flush() 会等待已提交的日志全部写出。
+ * - RTAV_LOG_SYNC=1 改为在调用线程同步输出（调试崩溃时不丢最后几条日志）。
+ * - RTAV_LOG_RATE_LIMIT=<n> 设置每个调用点每秒最多输出的条数，0 表示不限。
+ */
 class Logger {
  public:
+  static constexpr size_t MESSAGE_MAX = 400;  // 单条消息正文上限（字节）
+
   class LogStream {
    public:
     LogStream(LogLevel level, const char* file, const char* function, int line)
         : level_(level),
           file_(getFileName(file)),
           function_(function),
-          line_(line) {
-      if (level_ >= Logger::getGlobalLevel()) {
-        // 添加时间戳
-        auto now = std::chrono::system_clock::now();
-        auto now_time_t = std::chrono::system_clock::to_time_t(now);
-        auto now_tm = *std::localtime(&now_time_t);
-        auto now_ms = std::chrono::duration_cast<std::chrono::microseconds>(
-                          now.time_since_epoch()) %
-                      1000000;
-
-        char buffer[80];
-        std::strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &now_tm);
-
-        stream_ << Color::CYAN << "[" << buffer << "." << std::setfill('0')
-                << std::setw(6) << now_ms.count() << "] "
-                << getLevelColor(level_) << Color::BOLD << "["
-                << getLevelStr(level_) << "] " << Color::MAGENTA << "["
-                << std::this_thread::get_id() << "] " << Color::BLUE << "["
-                << file_ << ":" << line_ << "] " << Color::CYAN << "["
-                << function_ << "] " << getLevelColor(level_);
-      }
-    }
+          line_(line),
+          suppressed_(LogRateLimiter::takeSuppressed()),
+          time_us_(std::chrono::duration_cast<std::chrono::microseconds>(
+                       std::chrono::system_clock::now().time_since_epoch())
+                       .count()) {}
 
-    ~LogStream() {
-      if (level_ >= Logger::getGlobalLevel()) {
-        stream_ << Color::RESET << std::endl;
-        std::cout << stream_.str();
-        std::cout.flush();
+    ~LogStream() { Logger::submit(*this); }
 
-        // 如果是错误或致命错误，也输出到 stderr
-        if (level_ >= LogLevel::ERROR) {
-          std::cerr << stream_.str();
-          std::cerr.flush();
-        }
-      }
-    }
+    LogStream(const LogStream&) = delete;
+    LogStream& operator=(const LogStream&) = delete;
 
     template <typename T>
     LogStream& operator<<(const T& val) {
-      if (level_ >= Logger::getGlobalLevel()) {
-        stream_ << val;
+      if constexpr (std::is_same_v<T, bool>) {
+        append(val ? "1" : "0", 1);
+      } else if constexpr (std::is_same_v<T, char>) {
+        append(&val, 1);
+      } else if constexpr (std::is_integral_v<T>) {
+        auto res = std::to_chars(buffer_ + length_, buffer_ + MESSAGE_MAX, val);
+        if (res.ec == std::errc()) {
+          length_ = static_cast<size_t>(res.ptr - buffer_);
+        } else {
+          truncated_ = true;
+        }
+      } else if constexpr (std::is_floating_point_v<T>) {
+        char buf[32];
+        int n = std::snprintf(buf, sizeof(buf), "%g",
+                              static_cast<double>(val));
+        if (n > 0) append(buf, static_cast<size_t>(n));
+      } else if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+        const std::string_view s(val);
+        append(s.data(), s.size());
+      } else {
+        // 其余类型（std::thread::id、自定义 operator<< 等）走 ostream，较慢
+        static thread_local std::ostringstream os;
+        os.str(std::string());
+        os << val;
+        const std::string s = os.str();
+        append(s.data(), s.size());
       }
       return *this;
     }
 
+    LogStream& operator<<(const void* ptr) {
+      char buf[24];
+      int n = std::snprintf(buf, sizeof(buf), "%p", ptr);
+      if (n > 0) append(buf, static_cast<size_t>(n));
+      return *this;
+    }
+
+    // 供日志后端读取
+    LogLevel level() const { return level_; }
+    const char* file() const { return file_; }
+    const char* function() const { return function_; }
+    int line() const { return line_; }
+    uint32_t suppressed() const { return suppressed_; }
+    int64_t timeUs() const { return time_us_; }
+    const char* data() const { return buffer_; }
+    size_t size() const { return length_; }
+    bool truncated() const { return truncated_; }
+
    private:
-    std::ostringstream stream_;
-    LogLevel level_;
-    const char* file_;
-    const char* function_;
-    int line_;
+    void append(const char* data, size_t n) {
+      const size_t room = MESSAGE_MAX - length_;
+      if (n > room) {
+        n = room;
+        truncated_ = true;
+      }
+      std::memcpy(buffer_ + length_, data, n);
+      length_ += n;
+    }
 
     static const char* getFileName(const char* filePath) {
       const char* fileName = filePath;
@@ -93,77 +166,93 @@ class Logger {
       return fileName;
     }
 
-    static const char* getLevelStr(LogLevel level) {
-      switch (level) {
-        case LogLevel::DEBUG:
-          return "DEBUG";
-        case LogLevel::INFO:
-          return "INFO ";
-        case LogLevel::WARN:
-          return "WARN ";
-        case LogLevel::ERROR:
-          return "ERROR";
-        case LogLevel::FATAL:
-          return "FATAL";
-        default:
-          return "UNKNOWN";
-      }
-    }
+    LogLevel level_;
+    const char* file_;
+    const char* function_;
+    int line_;
+    uint32_t suppressed_;
+    int64_t time_us_;
+    size_t length_ = 0;
+    bool truncated_ = false;
+    char buffer_[MESSAGE_MAX];
+  };
 
-    static const char* getLevelColor(LogLevel level) {
-      switch (level) {
-        case LogLevel::DEBUG:
-          return Color::RESET;
-        case LogLevel::INFO:
-          return Color::GREEN;
-        case LogLevel::WARN:
-          return Color::YELLOW;
-        case LogLevel::ERROR:
-          return Color::RED;
-        case LogLevel::FATAL:
-          return Color::RED;
-        default:
-          return Color::RESET;
-      }
-    }
+  // 让 "cond ? (void)0 : Voidify() & stream << ..." 两个分支类型一致
+  struct Voidify {
+    void operator&(LogStream&) {}
   };
 
   static void setGlobalLevel(LogLevel level) { globalLevel_ = level; }
 
   static LogLevel getGlobalLevel() { return globalLevel_; }
 
-  static LogStream Debug(const char* file, const char* function, int line) {
-    return LogStream(LogLevel::DEBUG, file, function, line);
-  }
+  static void setRateLimit(uint32_t per_second) { rateLimit_ = per_second; }
 
-  static LogStream Info(const char* file, const char* function, int line) {
-    return LogStream(LogLevel::INFO, file, function, line);
-  }
+  static uint32_t getRateLimit() { return rateLimit_; }
 
-  static LogStream Warn(const char* file, const char* function, int line) {
-    return LogStream(LogLevel::WARN, file, function, line);
-  }
+  // 阻塞直到此前提交的日志全部写出
+  static void flush();
 
-  static LogStream Error(const char* file, const char* function, int line) {
-    return LogStream(LogLevel::ERROR, file, function, line);
-  }
+  // 因队列满被丢弃的日志条数
+  static uint64_t droppedCount();
 
-  static LogStream Fatal(const char* file, const char* function, int line) {
-    return LogStream(LogLevel::FATAL, file, function, line);
+ private:
+  static void submit(const LogStream& stream);
+
+  static uint32_t rateLimitFromEnv() {
+    const char* env = std::getenv("RTAV_LOG_RATE_LIMIT");
+    return env ? static_cast<uint32_t>(std::strtoul(env, nullptr, 10)) : 20;
   }
 
- private:
   static LogLevel globalLevel_;
+  static std::atomic<uint32_t> rateLimit_;
 };
 
-// 在 .cpp 文件中初始化
 inline LogLevel Logger::globalLevel_ = LogLevel::INFO;
+inline std::atomic<uint32_t> Logger::rateLimit_{Logger::rateLimitFromEnv()};
+
+inline bool LogRateLimiter::allow() {
+  const uint32_t limit = Logger::getRateLimit();
+  if (limit == 0) return true;
+  const int64_t now_ms =
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+          std::chrono::steady_clock::now().time_since_epoch())
+          .count();
+  int64_t start = window_start_ms_.load(std::memory_order_relaxed);
+  if (now_ms - start >= WINDOW_MS &&
+      window_start_ms_.compare_exchange_strong(start, now_ms,
+                                               std::memory_order_relaxed)) {
+    count_.store(0, std::memory_order_relaxed);
+  }
+  if (count_.fetch_add(1, std::memory_order_relaxed) < limit) {
+    last_suppressed_ = suppressed_.exchange(0, std::memory_order_relaxed);
+    return true;
+  }
+  suppressed_.fetch_add(1, std::memory_order_relaxed);
+  return false;
+}
 
 }  // namespace utils
 
+// 每个调用点独立的限流器
+#define RTAV_LOG_RATE_LIMITER()                                 \
+  ([]() -> utils::LogRateLimiter& {                             \
+    static utils::LogRateLimiter limiter;                       \
+    return limiter;                                             \
+  }())
+
+// 级别未启用（编译期或运行期）或被限流时不构造 LogStream，也不对 << 右侧求值
+#define RTAV_LOG(level)                                                   \
+  (static_cast<int>(level) < RTAV_LOG_MIN_LEVEL ||                        \
+   (level) < utils::Logger::getGlobalLevel() ||                           \
+   !RTAV_LOG_RATE_LIMITER().allow())                                      \
+      ? (void)0                                                           \
+      : utils::Logger::Voidify() &                                        \
+            utils::Logger::LogStream(level, __FILE__, __FUNCTION__, __LINE__)
+
 // 定义便捷宏
-#define LOG_DEBUG utils::Logger::Debug(__FILE__, __FUNCTION__, __LINE__)
-#define LOG_INFO utils::Logger::Info(__FILE__, __FUNCTION__, __LINE__)
-#define LOG_WARN utils::Logger::Warn(__FILE__, __FUNCTION__, __LINE__)
-#define LOG_ERROR utils::Logger::Error(__FILE__, __FUNCTION__, __LINE__)
-#define LOG_FATAL utils::Logger::Fatal(__FILE__, __FUNCTION__, __LINE__)
+#define LOG_DEBUG RTAV_LOG(utils::LogLevel::DEBUG)
+#define LOG_INFO RTAV_LOG(utils::LogLevel::INFO)
+#define LOG_WARN RTAV_LOG(utils::LogLevel::WARN)
+#define LOG_ERROR RTAV_LOG(utils::LogLevel::ERROR)
+#define LOG_FATAL RTAV_LOG(utils::LogLevel::FATAL)
@@ -0,0 +1,196 @@
+#include "metrics.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace utils {
+
+MetricSample MetricSample::counter(std::string name, std::string help,
+                                   double value, std::string labels) {
+  MetricSample s;
+  s.type = Type::Counter;
+  s.name = std::move(name);
+  s.help = std::move(help);
+  s.labels = std::move(labels);
+  s.value = value;
+  return s;
+}
+
+MetricSample MetricSample::gauge(std::string name, std::string help,
+                                 double value, std::string labels) {
+  MetricSample s = counter(std::move(name), std::move(help), value,
+                           std::move(labels));
+  s.type = Type::Gauge;
+  return s;
+}
+
+MetricSample MetricSample::latency(std::string name, std::string help,
+                                   const LatencyHistogram::Snapshot& snapshot,
+                                   std::string labels) {
+  MetricSample s;
+  s.type = Type::Summary;
+  s.name = std::move(name);
+  s.help = std::move(help);
+  s.labels = std::move(labels);
+  s.summary = snapshot;
+  return s;
+}
+
+MetricsRegistry::Entry& MetricsRegistry::findOrAdd(MetricSample::Type type,
+                                                   const std::string& name,
+                                                   const std::string& help,
+                                                   const std::string& labels) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto& e : entries_) {
+    if (e->type == type && e->name == name && e->labels == labels) {
+      return *e;
+    }
+  }
+  auto entry = std::make_unique<Entry>();
+  entry->type = type;
+  entry->name = name;
+  entry->help = help;
+  entry->labels = labels;
+  switch (type) {
+    case MetricSample::Type::Counter:
+      entry->counter = std::make_unique<Counter>();
+      break;
+    case MetricSample::Type::Gauge:
+      entry->gauge = std::make_unique<Gauge>();
+      break;
+    case MetricSample::Type::Summary:
+      entry->histogram = std::make_unique<LatencyHistogram>();
+      break;
+  }
+  entries_.push_back(std::move(entry));
+  return *entries_.back();
+}
+
+Counter& MetricsRegistry::counter(const std::string& name,
+                                  const std::string& help,
+                                  const std::string& labels) {
+  return *findOrAdd(MetricSample::Type::Counter, name, help, labels).counter;
+}
+
+Gauge& MetricsRegistry::gauge(const std::string& name, const std::string& help,
+                              const std::string& labels) {
+  return *findOrAdd(MetricSample::Type::Gauge, name, help, labels).gauge;
+}
+
+LatencyHistogram& MetricsRegistry::histogram(const std::string& name,
+                                             const std::string& help,
+                                             const std::string& labels) {
+  return *findOrAdd(MetricSample::Type::Summary, name, help, labels).histogram;
+}
+
+void MetricsRegistry::addCollector(Collector collector) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  collectors_.push_back(std::move(collector));
+}
+
+std::vector<MetricSample> MetricsRegistry::collect() const {
+  std::vector<MetricSample> samples;
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const auto& e : entries_) {
+    switch (e->type) {
+      case MetricSample::Type::Counter:
+        samples.push_back(MetricSample::counter(
+            e->name, e->help, static_cast<double>(e->counter->value()),
+            e->labels));
+        break;
+      case MetricSample::Type::Gauge:
+        samples.push_back(MetricSample::gauge(e->name, e->help,
+                                              e->gauge->value(), e->labels));
+        break;
+      case MetricSample::Type::Summary:
+        samples.push_back(MetricSample::latency(
+            e->name, e->help, e->histogram->snapshot(), e->labels));
+        break;
+    }
+  }
+  for (const auto& collector : collectors_) {
+    collector(samples);
+  }
+  // 同名指标必须相邻输出（HELP / TYPE 每个指标名只出现一次）
+  std::stable_sort(samples.begin(), samples.end(),
+                   [](const MetricSample& a, const MetricSample& b) {
+                     return a.name < b.name;
+                   });
+  return samples;
+}
+
+static void appendNumber(std::string& out, double v) {
+  char buf[32];
+  if (std::isnan(v)) {
+    out += "NaN";
+    return;
+  }
+  std::snprintf(buf, sizeof(buf), "%.9g", v);
+  out += buf;
+}
+
+// name{labels,extra} value
+static void appendLine(std::string& out, const std::string& name,
+                       const std::string& labels, const char* extra,
+                       double value) {
+  out += name;
+  if (!labels.empty() || extra) {
+    out += '{';
+    out += labels;
+    if (extra) {
+      if (!labels.empty()) out += ',';
+      out += extra;
+    }
+    out += '}';
+  }
+  out += ' ';
+  appendNumber(out, value);
+  out += '\n';
+}
+
+std::string MetricsRegistry::formatText(
+    const std::vector<MetricSample>& samples) {
+  std::string out;
+  out.reserve(samples.size() * 96);
+  const std::string* last_name = nullptr;
+  for (const auto& s : samples) {
+    if (!last_name || *last_name != s.name) {
+      out += "# HELP " + s.name + ' ' + s.help + '\n';
+      out += "# TYPE " + s.name + ' ';
+      switch (s.type) {
+        case MetricSample::Type::Counter:
+          out += "counter\n";
+          break;
+        case MetricSample::Type::Gauge:
+          out += "gauge\n";
+          break;
+        case MetricSample::Type::Summary:
+          out += "summary\n";
+          break;
+      }
+      last_name = &s.name;
+    }
+
+    if (s.type != MetricSample::Type::Summary) {
+      appendLine(out, s.name, s.labels, nullptr, s.value);
+      continue;
+    }
+    // 微秒 -> 秒；没有样本时分位数为 NaN（Prometheus 约定）
+    const auto& h = s.summary;
+    const bool empty = h.count == 0;
+    appendLine(out, s.name, s.labels, "quantile=\"0.5\"",
+               empty ? NAN : h.p50 / 1e6);
+    appendLine(out, s.name, s.labels, "quantile=\"0.95\"",
+               empty ? NAN : h.p95 / 1e6);
+    appendLine(out, s.name, s.labels, "quantile=\"0.99\"",
+               empty ? NAN : h.p99 / 1e6);
+    appendLine(out, s.name + "_sum", s.labels, nullptr,
+               h.mean * static_cast<double>(h.count) / 1e6);
+    appendLine(out, s.name + "_count", s.labels, nullptr,
+               static_cast<double>(h.count));
+  }
+  return out;
+}
+
+}  // namespace utils
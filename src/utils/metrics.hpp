@@ -0,0 +1,99 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "latency_histogram.hpp"
+
+namespace utils {
+
+// 单调递增计数器
+class Counter {
+ public:
+  void inc(uint64_t n = 1) { value_.fetch_add(n, std::memory_order_relaxed); }
+  uint64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+ private:
+  std::atomic<uint64_t> value_{0};
+};
+
+// 可增可减的瞬时值
+class Gauge {
+ public:
+  void set(double v) { value_.store(v, std::memory_order_relaxed); }
+  double value() const { return value_.load(std::memory_order_relaxed); }
+
+ private:
+  std::atomic<double> value_{0.0};
+};
+
+// 一次采集得到的指标值。Summary 的分位数来自 LatencyHistogram（单位微秒），
+// 导出时换算为秒
+struct MetricSample {
+  enum class Type { Counter, Gauge, Summary };
+
+  Type type = Type::Gauge;
+  std::string name;
+  std::string help;
+  std::string labels;  // 形如 stream="video"，可为空
+  double value = 0.0;  // Counter / Gauge
+  LatencyHistogram::Snapshot summary;  // Summary
+
+  static MetricSample counter(std::string name, std::string help,
+                              double value, std::string labels = "");
+  static MetricSample gauge(std::string name, std::string help, double value,
+                            std::string labels = "");
+  static MetricSample latency(std::string name, std::string help,
+                              const LatencyHistogram::Snapshot& snapshot,
+                              std::string labels = "");
+};
+
+/**
+ * MetricsRegistry: 进程内的指标注册表。
+ * - counter() / gauge() / histogram() 注册由调用方直接更新的指标，返回的引用在
+ *   注册表生命周期内有效；更新只是 relaxed 原子操作，可放在热路径上。
+ * - addCollector() 注册采集回调，collect() 时调用，用于读取其他组件已有的统计
+ *   （队列深度、解码耗时等），不必在热路径上重复记录。
+ * - renderText() 输出 Prometheus 文本格式（version 0.0.4），直方图导出为 summary。
+ */
+class MetricsRegistry {
+ public:
+  using Collector = std::function<void(std::vector<MetricSample>& out)>;
+
+  Counter& counter(const std::string& name, const std::string& help,
+                   const std::string& labels = "");
+  Gauge& gauge(const std::string& name, const std::string& help,
+               const std::string& labels = "");
+  // 记录微秒，导出为秒
+  LatencyHistogram& histogram(const std::string& name, const std::string& help,
+                              const std::string& labels = "");
+  void addCollector(Collector collector);
+
+  std::vector<MetricSample> collect() const;  // 按指标名排序
+  std::string renderText() const { return formatText(collect()); }
+  static std::string formatText(const std::vector<MetricSample>& samples);
+
+ private:
+  struct Entry {
+    MetricSample::Type type;
+    std::string name;
+    std::string help;
+    std::string labels;
+    std::unique_ptr<Counter> counter;
+    std::unique_ptr<Gauge> gauge;
+    std::unique_ptr<LatencyHistogram> histogram;
+  };
+  Entry& findOrAdd(MetricSample::Type type, const std::string& name,
+                   const std::string& help, const std::string& labels);
+
+  mutable std::mutex mutex_;
+  std::vector<std::unique_ptr<Entry>> entries_;
+  std::vector<Collector> collectors_;
+};
+
+}  // namespace utils
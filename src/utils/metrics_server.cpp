@@ -0,0 +1,141 @@
+#include "metrics_server.hpp"
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#endif
+
+#include <cerrno>
+#include <cstring>
+
+#include "logger.hpp"
+
+namespace utils {
+
+// 等待新连接的轮询周期，也是 stop() 的最长等待时间
+static const int POLL_INTERVAL_MS = 200;
+// 单个连接读取请求 / 写出响应的超时，避免慢客户端卡住服务线程
+static const int IO_TIMEOUT_MS = 1000;
+static const size_t MAX_REQUEST_BYTES = 8192;
+
+#if !defined(_WIN32) && !defined(MSG_NOSIGNAL)
+#define MSG_NOSIGNAL 0  // macOS 没有该标志，改用 SO_NOSIGPIPE
+#endif
+
+MetricsServer::~MetricsServer() { stop(); }
+
+#ifndef _WIN32
+
+bool MetricsServer::start(int port, Handler handler) {
+  if (running_.load()) return true;
+  int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0) {
+    LOG_ERROR << "Metrics server: socket() failed: " << std::strerror(errno);
+    return false;
+  }
+  int reuse = 1;
+  ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port = htons(static_cast<uint16_t>(port));
+  if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+      ::listen(fd, 8) < 0) {
+    LOG_ERROR << "Metrics server: could not listen on 127.0.0.1:" << port
+              << ": " << std::strerror(errno);
+    ::close(fd);
+    return false;
+  }
+
+  handler_ = std::move(handler);
+  listen_fd_ = fd;
+  running_.store(true);
+  thread_ = std::thread(&MetricsServer::serveLoop, this);
+  LOG_INFO << "Metrics available at http://127.0.0.1:" << port << "/metrics";
+  return true;
+}
+
+void MetricsServer::stop() {
+  if (!running_.exchange(false)) return;
+  if (thread_.joinable()) thread_.join();
+  ::close(listen_fd_);
+  listen_fd_ = -1;
+}
+
+void MetricsServer::serveLoop() {
+  while (running_.load()) {
+    pollfd pfd{listen_fd_, POLLIN, 0};
+    const int ret = ::poll(&pfd, 1, POLL_INTERVAL_MS);
+    if (ret <= 0) continue;  // 超时或 EINTR，重新检查 running_
+    const int fd = ::accept(listen_fd_, nullptr, nullptr);
+    if (fd < 0) continue;
+    handleConnection(fd);
+    ::close(fd);
+  }
+}
+
+void MetricsServer::handleConnection(int fd) {
+  timeval tv{IO_TIMEOUT_MS / 1000, (IO_TIMEOUT_MS % 1000) * 1000};
+  ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+  ::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+#ifdef SO_NOSIGPIPE
+  int no_sigpipe = 1;
+  ::setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &no_sigpipe, sizeof(no_sigpipe));
+#endif
+
+  // 只需要请求行；读到头部结束或缓冲区满即可
+  std::string request;
+  char buf[1024];
+  while (request.find("\r\n\r\n") == std::string::npos &&
+         request.size() < MAX_REQUEST_BYTES) {
+    const ssize_t n = ::recv(fd, buf, sizeof(buf), 0);
+    if (n <= 0) break;
+    request.append(buf, static_cast<size_t>(n));
+  }
+
+  std::string status = "200 OK";
+  std::string body;
+  const std::string line = request.substr(0, request.find("\r\n"));
+  if (line.rfind("GET /metrics ", 0) == 0 || line.rfind("GET / ", 0) == 0) {
+    body = handler_();
+  } else if (line.rfind("GET ", 0) == 0) {
+    status = "404 Not Found";
+    body = "not found\n";
+  } else {
+    status = "405 Method Not Allowed";
+    body = "only GET /metrics is supported\n";
+  }
+
+  std::string response = "HTTP/1.1 " + status +
+                         "\r\nContent-Type: text/plain; version=0.0.4\r\n"
+                         "Content-Length: " +
+                         std::to_string(body.size()) +
+                         "\r\nConnection: close\r\n\r\n" + body;
+  size_t sent = 0;
+  while (sent < response.size()) {
+    const ssize_t n = ::send(fd, response.data() + sent,
+                             response.size() - sent, MSG_NOSIGNAL);
+    if (n <= 0) break;
+    sent += static_cast<size_t>(n);
+  }
+}
+
+#else
+
+bool MetricsServer::start(int port, Handler handler) {
+  LOG_WARN << "Metrics server is not supported on this platform";
+  return false;
+}
+
+void MetricsServer::stop() {}
+void MetricsServer::serveLoop() {}
+void MetricsServer::handleConnection(int fd) {}
+
+#endif
+
+}  // namespace utils
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <string>
+#include <thread>
+
+namespace utils {
+
+/**
+ * MetricsServer: 只监听 127.0.0.1 的最小 HTTP 服务，GET /metrics 返回
+ * handler() 生成的 Prometheus 文本。单线程逐个处理连接，只用于本机抓取
+ * （Prometheus / node_exporter textfile / curl），不做鉴权，不对外暴露。
+ * 目前只支持 POSIX 平台，其他平台 start() 返回 false。
+ */
+class MetricsServer {
+ public:
+  using Handler = std::function<std::string()>;
+
+  MetricsServer() = default;
+  ~MetricsServer();
+
+  MetricsServer(const MetricsServer&) = delete;
+  MetricsServer& operator=(const MetricsServer&) = delete;
+
+  bool start(int port, Handler handler);
+  void stop();
+  bool isRunning() const { return running_.load(); }
+
+ private:
+  void serveLoop();
+  void handleConnection(int fd);
+
+  Handler handler_;
+  int listen_fd_ = -1;
+  std::atomic<bool> running_{false};
+  std::thread thread_;
+};
+
+}  // namespace utils
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace utils {
+
+/**
+ * MpscQueue: 固定容量的多生产者 / 单消费者无锁环形队列（有界序号队列）。
+ * - 每个槽位带一个序号：生产者 CAS 推进写游标占得槽位，就地写入后发布序号；
+ *   消费者按序号判断槽位是否已写完，不需要锁。
+ * - 生产者之间只竞争写游标，不会阻塞：队列满时 tryPush() 直接返回 false，
+ *   适合在实时线程中使用（调用方自行决定丢弃或重试）。
+ * - 元素通过回调就地填充 / 读取，大元素不需要额外拷贝一次。
+ */
+template <typename T>
+class MpscQueue {
+ public:
+  static constexpr size_t CACHE_LINE = 64;
+
+  explicit MpscQueue(size_t capacity)
+      : mask_(roundUpPow2(capacity > 1 ? capacity : 2) - 1),
+        slots_(new Slot[mask_ + 1]) {
+    for (size_t i = 0; i <= mask_; ++i) {
+      slots_[i].seq.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  MpscQueue(const MpscQueue&) = delete;
+  MpscQueue& operator=(const MpscQueue&) = delete;
+
+  // 任意线程：占得一个槽位后调用 fill(T&) 就地写入；队列满时返回 false
+  template <typename Fill>
+  bool tryPush(Fill&& fill) {
+    uint64_t pos = tail_.value.load(std::memory_order_relaxed);
+    Slot* slot;
+    for (;;) {
+      slot = &slots_[pos & mask_];
+      const uint64_t seq = slot->seq.load(std::memory_order_acquire);
+      const int64_t diff = static_cast<int64_t>(seq - pos);
+      if (diff == 0) {
+        if (tail_.value.compare_exchange_weak(pos, pos + 1,
+                                              std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;  // 槽位仍未被消费：队列已满
+      } else {
+        pos = tail_.value.load(std::memory_order_relaxed);
+      }
+    }
+    fill(slot->value);
+    slot->seq.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  // 消费者：队首已写完时调用 consume(T&) 并释放槽位；
+  // 队列为空或队首生产者尚未写完时返回 false
+  template <typename Consume>
+  bool tryPop(Consume&& consume) {
+    Slot& slot = slots_[head_ & mask_];
+    const uint64_t seq = slot.seq.load(std::memory_order_acquire);
+    if (static_cast<int64_t>(seq - (head_ + 1)) < 0) {
+      return false;
+    }
+    consume(slot.value);
+    slot.seq.store(head_ + mask_ + 1, std::memory_order_release);
+    ++head_;
+    return true;
+  }
+
+  size_t capacity() const { return mask_ + 1; }
+
+ private:
+  static size_t roundUpPow2(size_t n) {
+    size_t p = 1;
+    while (p < n) p <<= 1;
+    return p;
+  }
+
+  struct Slot {
+    std::atomic<uint64_t> seq{0};
+    T value{};
+  };
+
+  struct alignas(CACHE_LINE) Cursor {
+    std::atomic<uint64_t> value{0};
+  };
+
+  const size_t mask_;
+  std::unique_ptr<Slot[]> slots_;
+
+  Cursor tail_;                             // 生产者竞争
+  alignas(CACHE_LINE) uint64_t head_ = 0;  // 消费者私有
+};
+
+}  // namespace utils
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+namespace utils {
+
+/**
+ * SpscByteRing: 单生产者 / 单消费者的无等待字节环形缓冲区（用于 PCM 数据）。
+ * 读写游标为单调递增的原子计数，write()/read() 都在有限步内完成，不加锁、
+ * 不分配内存，可以在 SDL 实时音频回调中使用。
+ * consume() 以最多两段连续内存的形式把数据直接交给调用方（零拷贝读取）。
+ * allocate()/release() 不是线程安全的，只能在两端都停止时调用。
+ */
+class SpscByteRing {
+ public:
+  static constexpr size_t CACHE_LINE = 64;
+
+  SpscByteRing() = default;
+  SpscByteRing(const SpscByteRing&) = delete;
+  SpscByteRing& operator=(const SpscByteRing&) = delete;
+
+  void allocate(size_t capacity) {
+    buffer_.reset(capacity > 0 ? new uint8_t[capacity]() : nullptr);
+    capacity_ = capacity;
+    read_.value.store(0, std::memory_order_relaxed);
+    write_.value.store(0, std::memory_order_relaxed);
+  }
+
+  void release() { allocate(0); }
+
+  // 生产者：写入最多 bytes 字节，返回实际写入的字节数（满时为 0）
+  size_t write(const uint8_t* data, size_t bytes) {
+    if (!data || bytes == 0 || capacity_ == 0) return 0;
+    const uint64_t w = write_.value.load(std::memory_order_relaxed);
+    const uint64_t r = read_.value.load(std::memory_order_acquire);
+    const size_t free_space = capacity_ - static_cast<size_t>(w - r);
+    const size_t n = std::min(bytes, free_space);
+    if (n == 0) return 0;
+
+    const size_t offset = static_cast<size_t>(w % capacity_);
+    const size_t first = std::min(n, capacity_ - offset);
+    std::memcpy(buffer_.get() + offset, data, first);
+    if (n > first) {
+      std::memcpy(buffer_.get(), data + first, n - first);
+    }
+    write_.value.store(w + n, std::memory_order_release);
+    return n;
+  }
+
+  // 消费者：最多消费 max_bytes 字节，以 fn(const uint8_t* data, size_t n)
+  // 依次回调不超过两段连续内存，返回消费的字节数
+  template <typename Fn>
+  size_t consume(size_t max_bytes, Fn&& fn) {
+    if (capacity_ == 0) return 0;
+    const uint64_t r = read_.value.load(std::memory_order_relaxed);
+    const uint64_t w = write_.value.load(std::memory_order_acquire);
+    const size_t n = std::min(max_bytes, static_cast<size_t>(w - r));
+    if (n == 0) return 0;
+
+    const size_t offset = static_cast<size_t>(r % capacity_);
+    const size_t first = std::min(n, capacity_ - offset);
+    fn(static_cast<const uint8_t*>(buffer_.get() + offset), first);
+    if (n > first) {
+      fn(static_cast<const uint8_t*>(buffer_.get()), n - first);
+    }
+    read_.value.store(r + n, std::memory_order_release);
+    return n;
+  }
+
+  // 消费者：读出最多 bytes 字节到 out
+  size_t read(uint8_t* out, size_t bytes) {
+    if (!out) return 0;
+    return consume(bytes, [&out](const uint8_t* src, size_t n) {
+      std::memcpy(out, src, n);
+      out += n;
+    });
+  }
+
+  // 消费者：丢弃所有可读数据（seek / 重置时使用）
+  void discard() {
+    read_.value.store(write_.value.load(std::memory_order_acquire),
+                      std::memory_order_release);
+  }
+
+  size_t available() const {  // 可读字节数
+    return static_cast<size_t>(write_.value.load(std::memory_order_acquire) -
+                               read_.value.load(std::memory_order_acquire));
+  }
+  size_t freeSpace() const { return capacity_ - available(); }
+  size_t capacity() const { return capacity_; }
+  bool empty() const { return available() == 0; }
+
+ private:
+  struct alignas(CACHE_LINE) Cursor {
+    std::atomic<uint64_t> value{0};
+  };
+
+  std::unique_ptr<uint8_t[]> buffer_;
+  size_t capacity_ = 0;
+  Cursor read_;   // 消费者写
+  Cursor write_;  // 生产者写
+};
+
+}  // namespace utils
@@ -0,0 +1,191 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <utility>
+
+#include "wait_event.hpp"
+
+namespace utils {
+
+/**
+ * SpscQueue: 固定容量的单生产者 / 单消费者无锁环形队列。
+ * - 读写游标各占一个 cache line，并各自缓存对方游标，push/pop 通常不产生共享写。
+ * - 每个槽位附带一个原子 stamp（如帧 PTS），任意线程可通过 frontStamp()
+ *   无锁读取队首 stamp，不与生产者 / 消费者竞争。
+ * - 阻塞等待通过 WaitEvent 实现：无人等待时 push/pop 的通知开销只是一次原子读。
+ * - clear() 可以从第三方线程调用，通过消费者令牌与 tryPop() 互斥；
+ *   持有令牌期间 tryPop() 直接返回 false，不会阻塞消费者。
+ */
+template <typename T>
+class SpscQueue {
+ public:
+  static constexpr size_t CACHE_LINE = 64;
+
+  explicit SpscQueue(size_t capacity)
+      : capacity_(capacity > 0 ? capacity : 1),
+        mask_(roundUpPow2(capacity_) - 1),
+        slots_(new Slot[mask_ + 1]) {}
+
+  SpscQueue(const SpscQueue&) = delete;
+  SpscQueue& operator=(const SpscQueue&) = delete;
+
+  // 生产者：队列满时返回 false，item 不会被移动
+  bool tryPush(T&& item, int64_t stamp = 0) {
+    const uint64_t tail = tail_.value.load(std::memory_order_relaxed);
+    if (tail - cached_head_ >= capacity_) {
+      cached_head_ = head_.value.load(std::memory_order_acquire);
+      if (tail - cached_head_ >= capacity_) {
+        return false;
+      }
+    }
+    Slot& slot = slots_[tail & mask_];
+    slot.value = std::move(item);
+    slot.stamp.store(stamp, std::memory_order_relaxed);
+    tail_.value.store(tail + 1, std::memory_order_release);
+    data_event_.notifyAll();
+    return true;
+  }
+
+  // 消费者：队列为空（或 clear() 正在进行）时返回 false
+  bool tryPop(T& out) {
+    if (head_.value.load(std::memory_order_relaxed) ==
+        tail_.value.load(std::memory_order_acquire)) {
+      return false;  // 快速路径：空队列不获取消费者令牌
+    }
+    if (consumer_busy_.exchange(true, std::memory_order_acquire)) {
+      return false;
+    }
+    const uint64_t head = head_.value.load(std::memory_order_relaxed);
+    if (head == cached_tail_) {
+      cached_tail_ = tail_.value.load(std::memory_order_acquire);
+      if (head == cached_tail_) {
+        consumer_busy_.store(false, std::memory_order_release);
+        return false;
+      }
+    }
+    Slot& slot = slots_[head & mask_];
+    out = std::move(slot.value);
+    head_.value.store(head + 1, std::memory_order_release);
+    consumer_busy_.store(false, std::memory_order_release);
+    space_event_.notifyAll();
+    return true;
+  }
+
+  // 任意线程：读取队首 stamp，队列为空时返回 empty_value
+  int64_t frontStamp(int64_t empty_value) const {
+    const uint64_t head = head_.value.load(std::memory_order_acquire);
+    const uint64_t tail = tail_.value.load(std::memory_order_acquire);
+    if (head == tail) {
+      return empty_value;
+    }
+    return slots_[head & mask_].stamp.load(std::memory_order_relaxed);
+  }
+
+  // 任意线程：丢弃队列中所有元素
+  void clear() {
+    while (consumer_busy_.exchange(true, std::memory_order_acquire)) {
+      std::this_thread::yield();
+    }
+    uint64_t head = head_.value.load(std::memory_order_relaxed);
+    const uint64_t tail = tail_.value.load(std::memory_order_acquire);
+    for (; head != tail; ++head) {
+      slots_[head & mask_].value = T();
+    }
+    cached_tail_ = tail;
+    head_.value.store(head, std::memory_order_release);
+    consumer_busy_.store(false, std::memory_order_release);
+    space_event_.notifyAll();
+  }
+
+  size_t size() const {
+    const uint64_t head = head_.value.load(std::memory_order_acquire);
+    const uint64_t tail = tail_.value.load(std::memory_order_acquire);
+    return tail >= head ? static_cast<size_t>(tail - head) : 0;
+  }
+  bool empty() const { return size() == 0; }
+  size_t capacity() const { return capacity_; }
+
+  // 消费者：阻塞直到有数据或 stop() 为真，返回是否有数据
+  template <typename Pred>
+  bool waitForData(Pred stop) {
+    if (spinUntil([&]() { return !empty() || stop(); })) return !empty();
+    data_event_.wait([&]() { return !empty() || stop(); });
+    return !empty();
+  }
+
+  // 消费者：带超时的 waitForData
+  template <typename Clock, typename Duration, typename Pred>
+  bool waitForDataUntil(
+      const std::chrono::time_point<Clock, Duration>& deadline, Pred stop) {
+    data_event_.waitUntil(deadline, [&]() { return !empty() || stop(); });
+    return !empty();
+  }
+
+  // 生产者：阻塞直到队列长度小于 limit 或 stop() 为真，返回条件是否满足
+  template <typename Pred>
+  bool waitUntilSizeBelow(size_t limit, Pred stop) {
+    if (spinUntil([&]() { return size() < limit || stop(); })) {
+      return size() < limit;
+    }
+    space_event_.wait([&]() { return size() < limit || stop(); });
+    return size() < limit;
+  }
+
+  // 外部状态变化（暂停、停止等）后唤醒所有等待者重新检查条件
+  void notifyAll() {
+    data_event_.notifyAll();
+    space_event_.notifyAll();
+  }
+
+ private:
+  // 阻塞前短暂自旋：对端通常在几百纳秒内就会推进，避免一次 futex 睡眠/唤醒。
+  // 单核机器上自旋只会抢占对端的时间片，直接阻塞。
+  template <typename Pred>
+  static bool spinUntil(Pred pred) {
+    static const bool multi_core = std::thread::hardware_concurrency() > 1;
+    if (!multi_core) return pred();
+    for (int i = 0; i < SPIN_COUNT; ++i) {
+      if (pred()) return true;
+      std::this_thread::yield();
+    }
+    return false;
+  }
+
+  static constexpr int SPIN_COUNT = 64;
+
+  // 槽位数取 2 的幂，用掩码代替取模；逻辑容量仍为 capacity_
+  static size_t roundUpPow2(size_t n) {
+    size_t p = 1;
+    while (p < n) p <<= 1;
+    return p;
+  }
+
+  struct Slot {
+    T value{};
+    std::atomic<int64_t> stamp{0};
+  };
+
+  // 独占 cache line 的游标，避免生产者与消费者伪共享
+  struct alignas(CACHE_LINE) Cursor {
+    std::atomic<uint64_t> value{0};
+  };
+
+  const size_t capacity_;
+  const size_t mask_;
+  std::unique_ptr<Slot[]> slots_;
+
+  Cursor head_;  // 消费者写
+  alignas(CACHE_LINE) uint64_t cached_tail_ = 0;  // 消费者私有
+  alignas(CACHE_LINE) std::atomic<bool> consumer_busy_{false};
+  Cursor tail_;  // 生产者写
+  alignas(CACHE_LINE) uint64_t cached_head_ = 0;  // 生产者私有
+
+  WaitEvent data_event_;   // 消费者等待数据
+  WaitEvent space_event_;  // 生产者等待空间
+};
+
+}  // namespace utils
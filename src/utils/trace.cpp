@@ -0,0 +1,215 @@
+#include "trace.hpp"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+#include "logger.hpp"
+
+namespace utils {
+
+// 导出时跳过环形缓冲区中最旧的这部分事件：写入线程可能正在覆盖它们
+static const uint64_t DUMP_GUARD_EVENTS = 256;
+
+std::atomic<bool> Tracer::enabled_{false};
+
+struct Tracer::ThreadHandle {
+  Tracer* owner = nullptr;
+  ThreadBuffer* buffer = nullptr;
+  ~ThreadHandle() {
+    if (owner) owner->retireBuffer(buffer);
+  }
+};
+
+thread_local Tracer::ThreadHandle Tracer::tls_handle_;
+
+Tracer& Tracer::instance() {
+  static Tracer tracer;
+  return tracer;
+}
+
+int64_t Tracer::nowUs() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+bool Tracer::initFromEnv() {
+  const char* path = std::getenv("RTAV_TRACE");
+  if (!path || path[0] == '\0') {
+    return false;
+  }
+  size_t events = DEFAULT_EVENTS_PER_THREAD;
+  const char* env = std::getenv("RTAV_TRACE_EVENTS");
+  if (env && std::atoi(env) > 0) {
+    events = static_cast<size_t>(std::atoi(env));
+  }
+  enable(path, events);
+  return true;
+}
+
+void Tracer::enable(const std::string& output_path, size_t events_per_thread) {
+  output_path_ = output_path;
+  events_per_thread_ = std::max<size_t>(events_per_thread, 1024);
+  enabled_.store(true);
+  LOG_INFO << "Tracing enabled, output: " << output_path_ << " ("
+           << events_per_thread_ << " events per thread)";
+}
+
+Tracer::ThreadBuffer* Tracer::threadBuffer() {
+  if (tls_handle_.owner == this) {
+    return tls_handle_.buffer;
+  }
+  ThreadBuffer* raw = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(buffers_mutex_);
+    // 退役缓冲区超过上限时回收最早退役的一个；写入它的线程已经退出，
+    // dump() 也持有同一把锁，可以直接清空
+    size_t retired = 0;
+    ThreadBuffer* oldest = nullptr;
+    for (const auto& buffer : buffers_) {
+      if (buffer->retired_seq == 0) continue;
+      ++retired;
+      if (!oldest || buffer->retired_seq < oldest->retired_seq) {
+        oldest = buffer.get();
+      }
+    }
+    if (oldest && retired >= MAX_RETIRED_BUFFERS) {
+      raw = oldest;
+      raw->thread_name = nullptr;
+      raw->written.store(0, std::memory_order_relaxed);
+      raw->retired_seq = 0;
+    } else {
+      auto buffer = std::make_unique<ThreadBuffer>();
+      buffer->capacity = events_per_thread_;
+      buffer->events.reset(new Event[buffer->capacity]);
+      raw = buffer.get();
+      buffers_.push_back(std::move(buffer));
+    }
+    // 回收的缓冲区也换新的 tid，时间线上不与已退出的线程混在一起
+    raw->tid = next_tid_++;
+  }
+  tls_handle_.owner = this;
+  tls_handle_.buffer = raw;
+  return raw;
+}
+
+void Tracer::retireBuffer(ThreadBuffer* buffer) {
+  std::lock_guard<std::mutex> lock(buffers_mutex_);
+  buffer->retired_seq = ++retire_count_;
+}
+
+void Tracer::record(const char* name, char phase, int64_t ts_us,
+                    int64_t dur_us, int64_t value) {
+  ThreadBuffer* buffer = threadBuffer();
+  const uint64_t index = buffer->written.load(std::memory_order_relaxed);
+  Event& e = buffer->events[index % buffer->capacity];
+  e.name = name;
+  e.ts_us = ts_us;
+  e.dur_us = dur_us;
+  e.value = value;
+  e.phase = phase;
+  buffer->written.store(index + 1, std::memory_order_release);
+}
+
+void Tracer::setThreadName(const char* name) {
+  threadBuffer()->thread_name = name;
+}
+
+bool Tracer::dump() {
+  if (output_path_.empty()) return false;
+  return dump(output_path_);
+}
+
+void Tracer::dumpIfRequested() {
+  if (dump_requested_.exchange(false)) {
+    dump();
+  }
+}
+
+// 事件名来自代码中的字面量，这里只转义 JSON 必需的字符
+static void writeJsonString(FILE* fp, const char* s) {
+  std::fputc('"', fp);
+  for (; s && *s; ++s) {
+    if (*s == '"' || *s == '\\') std::fputc('\\', fp);
+    std::fputc(*s, fp);
+  }
+  std::fputc('"', fp);
+}
+
+bool Tracer::dump(const std::string& path) {
+  std::lock_guard<std::mutex> dump_lock(dump_mutex_);
+  const std::string tmp = path + ".tmp";
+  FILE* fp = std::fopen(tmp.c_str(), "w");
+  if (!fp) {
+    LOG_ERROR << "Could not write trace file " << path;
+    return false;
+  }
+
+  const int pid = static_cast<int>(::getpid());
+  std::fprintf(fp, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+  bool first = true;
+  uint64_t total = 0;
+  std::lock_guard<std::mutex> lock(buffers_mutex_);
+  for (const auto& buffer : buffers_) {
+    if (buffer->thread_name) {
+      std::fprintf(fp,
+                   "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,"
+                   "\"tid\":%u,\"args\":{\"name\":",
+                   first ? "" : ",\n", pid, buffer->tid);
+      writeJsonString(fp, buffer->thread_name);
+      std::fprintf(fp, "}}");
+      first = false;
+    }
+
+    const uint64_t written = buffer->written.load(std::memory_order_acquire);
+    uint64_t begin = 0;
+    if (written > buffer->capacity) {
+      begin = written - buffer->capacity + DUMP_GUARD_EVENTS;
+    }
+    for (uint64_t i = begin; i < written; ++i) {
+      const Event& e = buffer->events[i % buffer->capacity];
+      std::fprintf(fp, "%s{\"name\":", first ? "" : ",\n");
+      writeJsonString(fp, e.name);
+      switch (e.phase) {
+        case 'X':
+          std::fprintf(fp,
+                       ",\"ph\":\"X\",\"ts\":%lld,\"dur\":%lld,\"pid\":%d,"
+                       "\"tid\":%u}",
+                       static_cast<long long>(e.ts_us),
+                       static_cast<long long>(e.dur_us), pid, buffer->tid);
+          break;
+        case 'C':
+          std::fprintf(fp,
+                       ",\"ph\":\"C\",\"ts\":%lld,\"pid\":%d,\"tid\":%u,"
+                       "\"args\":{\"value\":%lld}}",
+                       static_cast<long long>(e.ts_us), pid, buffer->tid,
+                       static_cast<long long>(e.value));
+          break;
+        default:
+          std::fprintf(fp,
+                       ",\"ph\":\"i\",\"s\":\"t\",\"ts\":%lld,\"pid\":%d,"
+                       "\"tid\":%u}",
+                       static_cast<long long>(e.ts_us), pid, buffer->tid);
+          break;
+      }
+      first = false;
+      ++total;
+    }
+  }
+  std::fprintf(fp, "\n]}\n");
+  const bool ok = std::fclose(fp) == 0;
+  if (!ok || std::rename(tmp.c_str(), path.c_str()) != 0) {
+    std::remove(tmp.c_str());
+    LOG_ERROR << "Could not write trace file " << path;
+    return false;
+  }
+  LOG_INFO << "Trace written to " << path << " (" << total << " events, "
+           << buffers_.size() << " threads)";
+  return true;
+}
+
+}  // namespace utils
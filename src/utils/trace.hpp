@@ -0,0 +1,146 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace utils {
+
+/**
+ * Tracer: 管线各阶段的时间线追踪，导出 Chrome trace-event JSON
+ * （chrome://tracing 或 https://ui.perfetto.dev 直接打开）。
+ * 每个线程首次记录时分配一个定长环形缓冲区，之后记录事件只写本线程的
+ * 缓冲区（无锁、无分配），写满后覆盖最旧的事件，只保留最近一段时间线。
+ * 线程退出后缓冲区标记为已退役：最多保留 MAX_RETIRED_BUFFERS 个，超出后
+ * 由新线程回收最早退役的缓冲区，频繁创建的短命线程（如每次 seek 的音频
+ * seek 线程）不会让内存无限增长。
+ * 未启用时 TRACE_* 宏只做一次 relaxed 原子读；定义 RTAV_DISABLE_TRACE
+ * 编译时宏展开为空。
+ *
+ * 启用：环境变量 RTAV_TRACE=<输出文件>（可选 RTAV_TRACE_EVENTS=每线程事件数），
+ * 由 initFromEnv() 读取；退出时 dump()，运行中可由信号请求导出
+ * （信号处理函数中调用 requestDump()，主循环调用 dumpIfRequested()）。
+ * 事件名必须是字符串字面量（只保存指针）。
+ */
+class Tracer {
+ public:
+  static constexpr size_t DEFAULT_EVENTS_PER_THREAD = 64 * 1024;
+  static constexpr size_t MAX_RETIRED_BUFFERS = 8;
+
+  static Tracer& instance();
+  static bool enabled() { return enabled_.load(std::memory_order_relaxed); }
+  static int64_t nowUs();  // 单调时钟，单位微秒(us)
+
+  bool initFromEnv();
+  void enable(const std::string& output_path,
+              size_t events_per_thread = DEFAULT_EVENTS_PER_THREAD);
+
+  // 记录事件（调用方已检查 enabled()）；phase: 'X' 区间、'i' 瞬时、'C' 计数
+  void record(const char* name, char phase, int64_t ts_us, int64_t dur_us,
+              int64_t value);
+  void setThreadName(const char* name);  // 当前线程在时间线上的名字
+
+  bool dump();  // 写入 enable() 指定的文件
+  bool dump(const std::string& path);
+  void requestDump() { dump_requested_.store(true); }  // 异步信号安全
+  void dumpIfRequested();
+
+ private:
+  struct Event {
+    const char* name;
+    int64_t ts_us;
+    int64_t dur_us;
+    int64_t value;
+    char phase;
+  };
+  struct ThreadBuffer {
+    uint32_t tid = 0;
+    const char* thread_name = nullptr;
+    std::unique_ptr<Event[]> events;
+    size_t capacity = 0;
+    std::atomic<uint64_t> written{0};  // 已写入的事件总数（含被覆盖的）
+    uint64_t retired_seq = 0;          // 线程退出的顺序，0 表示仍在使用
+  };
+  struct ThreadHandle;  // 线程退出时退役本线程的缓冲区
+  static thread_local ThreadHandle tls_handle_;
+
+  Tracer() = default;
+  ThreadBuffer* threadBuffer();  // 当前线程的缓冲区，首次调用时注册
+  void retireBuffer(ThreadBuffer* buffer);
+
+  static std::atomic<bool> enabled_;
+  std::atomic<bool> dump_requested_{false};
+  std::string output_path_;
+  size_t events_per_thread_ = DEFAULT_EVENTS_PER_THREAD;
+
+  // 线程退出后缓冲区仍保留（直到被回收），时间线上能看到已结束的线程
+  std::mutex buffers_mutex_;
+  std::vector<std::unique_ptr<ThreadBuffer>> buffers_;
+  uint32_t next_tid_ = 1;
+  uint64_t retire_count_ = 0;
+  std::mutex dump_mutex_;
+};
+
+// 作用域内的区间事件（构造到析构）
+class TraceScope {
+ public:
+  explicit TraceScope(const char* name)
+      : name_(name), start_us_(Tracer::enabled() ? Tracer::nowUs() : -1) {}
+  ~TraceScope() {
+    if (start_us_ >= 0) {
+      Tracer::instance().record(name_, 'X', start_us_,
+                                Tracer::nowUs() - start_us_, 0);
+    }
+  }
+
+  TraceScope(const TraceScope&) = delete;
+  TraceScope& operator=(const TraceScope&) = delete;
+
+ private:
+  const char* name_;
+  int64_t start_us_;
+};
+
+}  // namespace utils
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+#ifndef RTAV_DISABLE_TRACE
+#define TRACE_SCOPE(name) \
+  utils::TraceScope TRACE_CONCAT(trace_scope_, __LINE__)(name)
+#define TRACE_INSTANT(name)                                             \
+  do {                                                                  \
+    if (utils::Tracer::enabled())                                       \
+      utils::Tracer::instance().record(name, 'i', utils::Tracer::nowUs(), \
+                                       0, 0);                           \
+  } while (0)
+#define TRACE_COUNTER(name, value)                                      \
+  do {                                                                  \
+    if (utils::Tracer::enabled())                                       \
+      utils::Tracer::instance().record(name, 'C', utils::Tracer::nowUs(), \
+                                       0, static_cast<int64_t>(value)); \
+  } while (0)
+#define TRACE_THREAD_NAME(name)                                  \
+  do {                                                           \
+    if (utils::Tracer::enabled())                                \
+      utils::Tracer::instance().setThreadName(name);             \
+  } while (0)
+#else
+#define TRACE_SCOPE(name) \
+  do {                    \
+  } while (0)
+#define TRACE_INSTANT(name) \
+  do {                      \
+  } while (0)
+#define TRACE_COUNTER(name, value) \
+  do {                             \
+  } while (0)
+#define TRACE_THREAD_NAME(name) \
+  do {                          \
+  } while (0)
+#endif
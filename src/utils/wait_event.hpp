@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+namespace utils {
+
+/**
+ * WaitEvent: 轻量的等待/唤醒原语（event count）。
+ * 等待方在条件不满足时阻塞在条件变量上；通知方只有在存在等待者时才加锁唤醒，
+ * 没有等待者时 notifyAll() 只是一次原子读，可放在每帧都执行的热路径上。
+ * 条件本身由调用方以原子变量表达，修改条件后调用 notifyAll()。
+ */
+class WaitEvent {
+ public:
+  void notifyAll() {
+    // 与等待方的 fence 配对：保证要么等待方看到新条件，要么这里看到等待者
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiters_.load(std::memory_order_relaxed) > 0) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      cond_.notify_all();
+    }
+  }
+
+  // 阻塞直到 pred() 为真
+  template <typename Pred>
+  void wait(Pred pred) {
+    if (pred()) return;
+    std::unique_lock<std::mutex> lock(mutex_);
+    waiters_.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    cond_.wait(lock, pred);
+    waiters_.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  // 阻塞直到 pred() 为真或到达 deadline，返回 pred() 的结果
+  template <typename Clock, typename Duration, typename Pred>
+  bool waitUntil(const std::chrono::time_point<Clock, Duration>& deadline,
+                 Pred pred) {
+    if (pred()) return true;
+    std::unique_lock<std::mutex> lock(mutex_);
+    waiters_.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    bool ok = cond_.wait_until(lock, deadline, pred);
+    waiters_.fetch_sub(1, std::memory_order_relaxed);
+    return ok;
+  }
+
+  template <typename Rep, typename Period, typename Pred>
+  bool waitFor(const std::chrono::duration<Rep, Period>& timeout, Pred pred) {
+    return waitUntil(std::chrono::steady_clock::now() + timeout, pred);
+  }
+
+ private:
+  std::atomic<int> waiters_{0};
+  std::mutex mutex_;
+  std::condition_variable cond_;
+};
+
+}  // namespace utils